@@ -1,6 +1,7 @@
 #pragma once
 #include <stdexcept>
 #include <iostream>
+#include "../expression_core/AllocationTracker.h"
 
 // Singly Circular Linked List (Cyclic List)
 // Maintains `tail` pointer; when non-empty, `tail->next` points to head.
@@ -82,6 +83,7 @@ public:
 
     void pushFront(const T& value) {
         Node* n = new Node(value);
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         if (!tail) {
             tail = n;
             tail->next = tail;
@@ -93,6 +95,7 @@ public:
     }
     void pushFront(T&& value) {
         Node* n = new Node(std::move(value));
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         if (!tail) {
             tail = n;
             tail->next = tail;
@@ -105,6 +108,7 @@ public:
 
     void pushBack(const T& value) {
         Node* n = new Node(value);
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         if (!tail) {
             tail = n;
             tail->next = tail;
@@ -117,6 +121,7 @@ public:
     }
     void pushBack(T&& value) {
         Node* n = new Node(std::move(value));
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         if (!tail) {
             tail = n;
             tail->next = tail;
@@ -133,10 +138,12 @@ public:
         Node* h = tail->next;
         T val = std::move(h->data);
         if (h == tail) { // single node
+            TRACK_DEALLOCATION("CyclicList node", h, sizeof(Node));
             delete h;
             tail = nullptr;
         } else {
             tail->next = h->next;
+            TRACK_DEALLOCATION("CyclicList node", h, sizeof(Node));
             delete h;
         }
         --count;
@@ -148,6 +155,7 @@ public:
         Node* h = tail->next;
         if (h == tail) {
             T val = std::move(tail->data);
+            TRACK_DEALLOCATION("CyclicList node", tail, sizeof(Node));
             delete tail;
             tail = nullptr;
             --count;
@@ -158,6 +166,7 @@ public:
         while (prev->next != tail) prev = prev->next;
         T val = std::move(tail->data);
         prev->next = tail->next; // new tail next points to head
+        TRACK_DEALLOCATION("CyclicList node", tail, sizeof(Node));
         delete tail;
         tail = prev;
         --count;
@@ -172,6 +181,7 @@ public:
         Node* cur = tail->next; // head
         for (size_t i = 0; i < index - 1; ++i) cur = cur->next;
         Node* n = new Node(value);
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         n->next = cur->next;
         cur->next = n;
         ++count;
@@ -183,6 +193,7 @@ public:
         Node* cur = tail->next;
         for (size_t i = 0; i < index - 1; ++i) cur = cur->next;
         Node* n = new Node(std::move(value));
+        TRACK_ALLOCATION("CyclicList node", n, sizeof(Node));
         n->next = cur->next;
         cur->next = n;
         ++count;
@@ -201,6 +212,7 @@ public:
         if (victim == tail) {
             tail = cur; // removed last; fix tail
         }
+        TRACK_DEALLOCATION("CyclicList node", victim, sizeof(Node));
         delete victim;
         --count;
         return val;
@@ -223,6 +235,7 @@ public:
         tail->next = nullptr; // break cycle to ease deletion
         while (h) {
             Node* nxt = h->next;
+            TRACK_DEALLOCATION("CyclicList node", h, sizeof(Node));
             delete h;
             h = nxt;
         }
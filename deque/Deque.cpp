@@ -75,8 +75,8 @@ namespace DequeUtils {
     void reverseDeque(ArrayDeque<T>& deque) {
         if (deque.size() <= 1) return;
         
-        int left = 0;
-        int right = deque.size() - 1;
+        size_t left = 0;
+        size_t right = deque.size() - 1;
         
         while (left < right) {
             std::swap(deque[left], deque[right]);
@@ -210,7 +210,7 @@ void testArrayDeque() {
     
     // Random access
     std::cout << "\n--- Random Access ---" << std::endl;
-    for (int i = 0; i < deque.size(); ++i) {
+    for (size_t i = 0; i < deque.size(); ++i) {
         std::cout << "deque[" << i << "] = " << deque[i] << std::endl;
     }
     
@@ -288,6 +288,21 @@ void testLinkedDeque() {
     } catch (const std::exception& e) {
         std::cout << "Exception caught: " << e.what() << std::endl;
     }
+    
+    // Chunked variant: same operations, 4 elements per node here
+    std::cout << "\n--- Chunked Deque (4 per chunk) ---" << std::endl;
+    ChunkedDeque<int, 4> chunked_deque;
+    for (int i = 1; i <= 5; ++i) {
+        chunked_deque.pushBack(i);
+        chunked_deque.pushFront(-i);
+    }
+    chunked_deque.display();
+    chunked_deque.displayReverse();
+    std::cout << "chunked_deque[7] = " << chunked_deque[7] << std::endl;
+    std::cout << "Pop front: " << chunked_deque.popFront() << std::endl;
+    std::cout << "Pop back: " << chunked_deque.popBack() << std::endl;
+    ChunkedDeque<int, 4> copied_chunked = chunked_deque;
+    copied_chunked.display();
 }
 
 void testDequeAlgorithms() {
@@ -320,8 +335,10 @@ void testDequeAlgorithms() {
     for (const std::string& str : test_strings) {
         bool is_palindrome_array = DequeUtils::isPalindrome<ArrayDeque<char>>(str);
         bool is_palindrome_linked = DequeUtils::isPalindrome<LinkedDeque<char>>(str);
+        bool is_palindrome_chunked = DequeUtils::isPalindrome<ChunkedDeque<char>>(str);
         std::cout << "\"" << str << "\" - ArrayDeque: " << (is_palindrome_array ? "Yes" : "No")
-                  << ", LinkedDeque: " << (is_palindrome_linked ? "Yes" : "No") << std::endl;
+                  << ", LinkedDeque: " << (is_palindrome_linked ? "Yes" : "No")
+                  << ", ChunkedDeque: " << (is_palindrome_chunked ? "Yes" : "No") << std::endl;
     }
     
     // Test reverse
@@ -369,4 +386,7 @@ void performanceBenchmarks() {
     
     std::cout << "\nLinked Deque:" << std::endl;
     DequeUtils::performanceBenchmark<LinkedDeque<int>>(operations);
+    
+    std::cout << "\nChunked Deque:" << std::endl;
+    DequeUtils::performanceBenchmark<ChunkedDeque<int>>(operations);
 }
\ No newline at end of file
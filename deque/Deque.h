@@ -2,67 +2,175 @@
 #include <stdexcept>
 #include <iostream>
 #include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/NodePool.h"
 
-// Array-based Circular Deque implementation
+// Array-based Circular Deque implementation.
+// The capacity is always a power of two, so stepping an index around the ring
+// in either direction is a mask instead of a division. Slots are raw storage:
+// only the current_size slots starting at front_index hold constructed
+// elements, so growing does not default-construct the new buffer, and
+// trivially copyable elements are moved to it with memcpy.
 template<typename T>
 class ArrayDeque {
 private:
     T* data;
-    int capacity;
-    int front_index;
-    int rear_index;
-    int current_size;
-    
-    void resize() {
-        int new_capacity = capacity * 2;
-        T* new_data = new T[new_capacity];
-        
-        // Copy elements in correct order
-        for (int i = 0; i < current_size; ++i) {
-            new_data[i] = std::move(data[(front_index + i) % capacity]);
+    size_t capacity;        // Zero (after a move) or a power of two
+    size_t front_index;
+    size_t current_size;
+    
+    static constexpr size_t MIN_CAPACITY = 16;
+    
+    static size_t roundUpToPowerOfTwo(size_t count) {
+        size_t result = 1;
+        while (result < count) {
+            result <<= 1;
         }
-        
-        delete[] data;
-        data = new_data;
-        capacity = new_capacity;
-        front_index = 0;
-        rear_index = current_size;
+        return result;
+    }
+    
+    static T* allocateSlots(size_t count) {
+        T* slots = std::allocator<T>().allocate(count);
+        TRACK_ALLOCATION("ArrayDeque buffer", slots, count * sizeof(T));
+        return slots;
     }
     
-    int getPrevIndex(int index) const {
-        return (index - 1 + capacity) % capacity;
+    static void freeSlots(T* slots, size_t count) {
+        if (slots != nullptr) {
+            TRACK_DEALLOCATION("ArrayDeque buffer", slots, count * sizeof(T));
+            std::allocator<T>().deallocate(slots, count);
+        }
     }
     
-    int getNextIndex(int index) const {
-        return (index + 1) % capacity;
+    size_t getPrevIndex(size_t index) const {
+        return (index - 1) & (capacity - 1);
+    }
+    
+    size_t getNextIndex(size_t index) const {
+        return (index + 1) & (capacity - 1);
+    }
+    
+    // Slot of the element at position i from the front
+    size_t slotOf(size_t i) const {
+        return (front_index + i) & (capacity - 1);
+    }
+    
+    void destroyElements() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < current_size; ++i) {
+                data[slotOf(i)].~T();
+            }
+        }
+    }
+    
+    // Construct the elements, front first, at destination[0, current_size).
+    // With Move they are moved out (copied if T's move may throw), so only a
+    // deque about to destroy them uses it. If a copy throws, the copies made so
+    // far are destroyed and this deque is intact.
+    template<bool Move>
+    void transferElementsTo(T* destination) const {
+        if (current_size == 0) {
+            return;
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            // At most two runs: up to the end of the buffer, then from its start
+            size_t first_run = std::min(current_size, capacity - front_index);
+            std::memcpy(static_cast<void*>(destination), data + front_index, first_run * sizeof(T));
+            std::memcpy(static_cast<void*>(destination + first_run), data, (current_size - first_run) * sizeof(T));
+        } else {
+            size_t built = 0;
+            try {
+                for (; built < current_size; ++built) {
+                    T& element = data[slotOf(built)];
+                    if constexpr (Move) {
+                        new (destination + built) T(std::move_if_noexcept(element));
+                    } else {
+                        new (destination + built) T(static_cast<const T&>(element));
+                    }
+                }
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) {
+                    destination[i].~T();
+                }
+                throw;
+            }
+        }
+    }
+    
+    // A buffer of other's capacity holding copies of its elements from slot 0
+    static T* copyOf(const ArrayDeque& other) {
+        if (other.capacity == 0) {
+            return nullptr;
+        }
+        T* copy = allocateSlots(other.capacity);
+        try {
+            other.template transferElementsTo<false>(copy);
+        } catch (...) {
+            freeSlots(copy, other.capacity);
+            throw;
+        }
+        return copy;
+    }
+    
+    // Double the capacity, constructing the new front or back element in the
+    // new buffer before the old one is released, so args may refer to an
+    // element of this deque. The elements move to slots [0, current_size) and
+    // a new front element goes in the last slot.
+    template<typename... Args>
+    void growAndPush(bool at_front, Args&&... args) {
+        size_t new_capacity = capacity == 0 ? MIN_CAPACITY : capacity * 2;
+        size_t new_slot = at_front ? new_capacity - 1 : current_size;
+        T* new_data = allocateSlots(new_capacity);
+        try {
+            new (new_data + new_slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            freeSlots(new_data, new_capacity);
+            throw;
+        }
+        try {
+            transferElementsTo<true>(new_data);
+        } catch (...) {
+            new_data[new_slot].~T();
+            freeSlots(new_data, new_capacity);
+            throw;
+        }
+        
+        destroyElements();
+        freeSlots(data, capacity);
+        data = new_data;
+        capacity = new_capacity;
+        front_index = at_front ? new_slot : 0;
+        ++current_size;
     }
 
 public:
-    // Constructor
-    explicit ArrayDeque(int initial_capacity = 10) 
-        : capacity(initial_capacity), front_index(0), rear_index(0), current_size(0) {
-        data = new T[capacity];
+    // Constructor; the capacity is rounded up to a power of two
+    explicit ArrayDeque(size_t initial_capacity = MIN_CAPACITY) 
+        : data(nullptr), capacity(roundUpToPowerOfTwo(initial_capacity)), front_index(0), current_size(0) {
+        data = allocateSlots(capacity);
         std::cout << "ArrayDeque constructor called with capacity " << capacity << std::endl;
     }
     
     // Copy constructor
     ArrayDeque(const ArrayDeque& other) 
-        : capacity(other.capacity), front_index(0), rear_index(other.current_size), current_size(other.current_size) {
-        data = new T[capacity];
-        for (int i = 0; i < current_size; ++i) {
-            data[i] = other.data[(other.front_index + i) % other.capacity];
-        }
+        : data(copyOf(other)), capacity(other.capacity), front_index(0), current_size(other.current_size) {
         std::cout << "ArrayDeque copy constructor called" << std::endl;
     }
     
     // Move constructor
     ArrayDeque(ArrayDeque&& other) noexcept
         : data(other.data), capacity(other.capacity), 
-          front_index(other.front_index), rear_index(other.rear_index), current_size(other.current_size) {
+          front_index(other.front_index), current_size(other.current_size) {
         other.data = nullptr;
         other.capacity = 0;
         other.front_index = 0;
-        other.rear_index = 0;
         other.current_size = 0;
         std::cout << "ArrayDeque move constructor called" << std::endl;
     }
@@ -70,17 +178,15 @@ public:
     // Copy assignment
     ArrayDeque& operator=(const ArrayDeque& other) {
         if (this != &other) {
-            delete[] data;
+            T* copy = copyOf(other);
+            
+            destroyElements();
+            freeSlots(data, capacity);
             
+            data = copy;
             capacity = other.capacity;
-            current_size = other.current_size;
             front_index = 0;
-            rear_index = current_size;
-            data = new T[capacity];
-            
-            for (int i = 0; i < current_size; ++i) {
-                data[i] = other.data[(other.front_index + i) % other.capacity];
-            }
+            current_size = other.current_size;
         }
         std::cout << "ArrayDeque copy assignment called" << std::endl;
         return *this;
@@ -89,18 +195,17 @@ public:
     // Move assignment
     ArrayDeque& operator=(ArrayDeque&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            destroyElements();
+            freeSlots(data, capacity);
             
             data = other.data;
             capacity = other.capacity;
             front_index = other.front_index;
-            rear_index = other.rear_index;
             current_size = other.current_size;
             
             other.data = nullptr;
             other.capacity = 0;
             other.front_index = 0;
-            other.rear_index = 0;
             other.current_size = 0;
         }
         std::cout << "ArrayDeque move assignment called" << std::endl;
@@ -109,37 +214,31 @@ public:
     
     // Destructor
     ~ArrayDeque() {
-        delete[] data;
+        destroyElements();
+        freeSlots(data, capacity);
         std::cout << "ArrayDeque destructor called" << std::endl;
     }
     
     // Front operations
-    void pushFront(const T& value) {
+    template<typename... Args>
+    void emplaceFront(Args&&... args) {
         if (current_size == capacity) {
-            resize();
+            growAndPush(true, std::forward<Args>(args)...);
+            return;
         }
         
-        front_index = getPrevIndex(front_index);
-        data[front_index] = value;
+        size_t slot = getPrevIndex(front_index);
+        new (data + slot) T(std::forward<Args>(args)...);
+        front_index = slot;
         ++current_size;
-        
-        if (current_size == 1) {
-            rear_index = getNextIndex(front_index);
-        }
+    }
+    
+    void pushFront(const T& value) {
+        emplaceFront(value);
     }
     
     void pushFront(T&& value) {
-        if (current_size == capacity) {
-            resize();
-        }
-        
-        front_index = getPrevIndex(front_index);
-        data[front_index] = std::move(value);
-        ++current_size;
-        
-        if (current_size == 1) {
-            rear_index = getNextIndex(front_index);
-        }
+        emplaceFront(std::move(value));
     }
     
     T popFront() {
@@ -148,6 +247,7 @@ public:
         }
         
         T value = std::move(data[front_index]);
+        data[front_index].~T();
         front_index = getNextIndex(front_index);
         --current_size;
         
@@ -155,24 +255,23 @@ public:
     }
     
     // Back operations
-    void pushBack(const T& value) {
+    template<typename... Args>
+    void emplaceBack(Args&&... args) {
         if (current_size == capacity) {
-            resize();
+            growAndPush(false, std::forward<Args>(args)...);
+            return;
         }
         
-        data[rear_index] = value;
-        rear_index = getNextIndex(rear_index);
+        new (data + slotOf(current_size)) T(std::forward<Args>(args)...);
         ++current_size;
     }
     
+    void pushBack(const T& value) {
+        emplaceBack(value);
+    }
+    
     void pushBack(T&& value) {
-        if (current_size == capacity) {
-            resize();
-        }
-        
-        data[rear_index] = std::move(value);
-        rear_index = getNextIndex(rear_index);
-        ++current_size;
+        emplaceBack(std::move(value));
     }
     
     T popBack() {
@@ -180,8 +279,9 @@ public:
             throw std::runtime_error("Cannot pop from empty deque");
         }
         
-        rear_index = getPrevIndex(rear_index);
-        T value = std::move(data[rear_index]);
+        T& element = data[slotOf(current_size - 1)];
+        T value = std::move(element);
+        element.~T();
         --current_size;
         
         return value;
@@ -206,38 +306,36 @@ public:
         if (isEmpty()) {
             throw std::runtime_error("Cannot access back of empty deque");
         }
-        int back_index = getPrevIndex(rear_index);
-        return data[back_index];
+        return data[slotOf(current_size - 1)];
     }
     
     T& back() {
         if (isEmpty()) {
             throw std::runtime_error("Cannot access back of empty deque");
         }
-        int back_index = getPrevIndex(rear_index);
-        return data[back_index];
+        return data[slotOf(current_size - 1)];
     }
     
     // Random access operator
-    const T& operator[](int index) const {
-        if (index < 0 || index >= current_size) {
+    const T& operator[](size_t index) const {
+        if (index >= current_size) {
             throw std::out_of_range("Index out of range");
         }
-        return data[(front_index + index) % capacity];
+        return data[slotOf(index)];
     }
     
-    T& operator[](int index) {
-        if (index < 0 || index >= current_size) {
+    T& operator[](size_t index) {
+        if (index >= current_size) {
             throw std::out_of_range("Index out of range");
         }
-        return data[(front_index + index) % capacity];
+        return data[slotOf(index)];
     }
     
-    const T& at(int index) const {
+    const T& at(size_t index) const {
         return (*this)[index];
     }
     
-    T& at(int index) {
+    T& at(size_t index) {
         return (*this)[index];
     }
     
@@ -246,18 +344,18 @@ public:
         return current_size == 0;
     }
     
-    int size() const {
+    size_t size() const {
         return current_size;
     }
     
-    int getCapacity() const {
+    size_t getCapacity() const {
         return capacity;
     }
     
     void clear() {
+        destroyElements();
         current_size = 0;
         front_index = 0;
-        rear_index = 0;
     }
     
     void display() const {
@@ -265,8 +363,8 @@ public:
         if (isEmpty()) {
             std::cout << "EMPTY";
         } else {
-            for (int i = 0; i < current_size; ++i) {
-                std::cout << data[(front_index + i) % capacity] << " ";
+            for (size_t i = 0; i < current_size; ++i) {
+                std::cout << data[slotOf(i)] << " ";
             }
         }
         std::cout << std::endl;
@@ -276,7 +374,7 @@ public:
         std::cout << "Deque Details:" << std::endl;
         std::cout << "  Size: " << current_size << "/" << capacity << std::endl;
         std::cout << "  Front index: " << front_index << std::endl;
-        std::cout << "  Rear index: " << rear_index << std::endl;
+        std::cout << "  Rear index: " << (capacity == 0 ? 0 : slotOf(current_size)) << std::endl;
         display();
     }
     
@@ -285,8 +383,8 @@ public:
         if (isEmpty()) {
             std::cout << "EMPTY";
         } else {
-            for (int i = current_size - 1; i >= 0; --i) {
-                std::cout << data[(front_index + i) % capacity] << " ";
+            for (size_t i = current_size; i > 0; --i) {
+                std::cout << data[slotOf(i - 1)] << " ";
             }
         }
         std::cout << std::endl;
@@ -336,13 +434,15 @@ public:
     ~DequeNode() = default;
 };
 
-// Doubly Linked List-based Deque implementation
-template<typename T>
+// Doubly Linked List-based Deque implementation; nodes come from a NodePool
+// unless HeapNodes is passed, so pushes at the working size do not allocate
+template<typename T, template<typename> class NodeAllocator = NodePool>
 class LinkedDeque {
 private:
     DequeNode<T>* front_node;
     DequeNode<T>* rear_node;
     size_t current_size;
+    NodeAllocator<DequeNode<T>> nodes;
     
     void copyFrom(const LinkedDeque& other) {
         if (other.front_node == nullptr) {
@@ -352,12 +452,12 @@ private:
             return;
         }
         
-        front_node = new DequeNode<T>(other.front_node->data);
+        front_node = nodes.create(other.front_node->data);
         DequeNode<T>* current = front_node;
         DequeNode<T>* otherCurrent = other.front_node->next;
         
         while (otherCurrent != nullptr) {
-            current->next = new DequeNode<T>(otherCurrent->data);
+            current->next = nodes.create(otherCurrent->data);
             current->next->prev = current;
             current = current->next;
             otherCurrent = otherCurrent->next;
@@ -366,16 +466,6 @@ private:
         rear_node = current;
         current_size = other.current_size;
     }
-    
-    void clear() {
-        while (front_node != nullptr) {
-            DequeNode<T>* temp = front_node;
-            front_node = front_node->next;
-            delete temp;
-        }
-        rear_node = nullptr;
-        current_size = 0;
-    }
 
 public:
     // Default constructor
@@ -391,7 +481,8 @@ public:
     
     // Move constructor
     LinkedDeque(LinkedDeque&& other) noexcept 
-        : front_node(other.front_node), rear_node(other.rear_node), current_size(other.current_size) {
+        : front_node(other.front_node), rear_node(other.rear_node), current_size(other.current_size),
+          nodes(std::move(other.nodes)) {
         other.front_node = nullptr;
         other.rear_node = nullptr;
         other.current_size = 0;
@@ -415,6 +506,7 @@ public:
             front_node = other.front_node;
             rear_node = other.rear_node;
             current_size = other.current_size;
+            nodes = std::move(other.nodes);
             other.front_node = nullptr;
             other.rear_node = nullptr;
             other.current_size = 0;
@@ -431,7 +523,7 @@ public:
     
     // Front operations
     void pushFront(const T& value) {
-        DequeNode<T>* newNode = new DequeNode<T>(value);
+        DequeNode<T>* newNode = nodes.create(value);
         
         if (front_node == nullptr) {
             front_node = rear_node = newNode;
@@ -445,7 +537,7 @@ public:
     }
     
     void pushFront(T&& value) {
-        DequeNode<T>* newNode = new DequeNode<T>(std::move(value));
+        DequeNode<T>* newNode = nodes.create(std::move(value));
         
         if (front_node == nullptr) {
             front_node = rear_node = newNode;
@@ -473,7 +565,7 @@ public:
             rear_node = nullptr;
         }
         
-        delete temp;
+        nodes.destroy(temp);
         --current_size;
         
         return value;
@@ -481,7 +573,7 @@ public:
     
     // Back operations
     void pushBack(const T& value) {
-        DequeNode<T>* newNode = new DequeNode<T>(value);
+        DequeNode<T>* newNode = nodes.create(value);
         
         if (rear_node == nullptr) {
             front_node = rear_node = newNode;
@@ -495,7 +587,7 @@ public:
     }
     
     void pushBack(T&& value) {
-        DequeNode<T>* newNode = new DequeNode<T>(std::move(value));
+        DequeNode<T>* newNode = nodes.create(std::move(value));
         
         if (rear_node == nullptr) {
             front_node = rear_node = newNode;
@@ -523,7 +615,7 @@ public:
             front_node = nullptr;
         }
         
-        delete temp;
+        nodes.destroy(temp);
         --current_size;
         
         return value;
@@ -626,7 +718,7 @@ public:
         while (front_node != nullptr) {
             DequeNode<T>* temp = front_node;
             front_node = front_node->next;
-            delete temp;
+            nodes.destroy(temp);
         }
         rear_node = nullptr;
         current_size = 0;
@@ -659,4 +751,406 @@ public:
         }
         std::cout << std::endl;
     }
+};
+
+// Chunk of a ChunkedDeque: raw storage for ChunkSize elements, linked both
+// ways; the deque constructs and destroys elements one at a time
+template<typename T, size_t ChunkSize>
+struct DequeChunk {
+    DequeChunk* prev;
+    DequeChunk* next;
+    alignas(T) unsigned char storage[ChunkSize * sizeof(T)];
+
+    DequeChunk() : prev(nullptr), next(nullptr) {}
+
+    T* slot(size_t index) {
+        return std::launder(reinterpret_cast<T*>(storage) + index);
+    }
+
+    const T* slot(size_t index) const {
+        return std::launder(reinterpret_cast<const T*>(storage) + index);
+    }
+};
+
+// Unrolled doubly linked list-based Deque: same interface as LinkedDeque, but
+// each node holds ChunkSize elements, so there are two pointers and one
+// allocation per chunk instead of per element, traversal stays within
+// contiguous memory and growth never copies elements. The front chunk fills
+// downwards and the rear chunk upwards; an emptied deque restarts from the
+// middle of its last chunk so both ends have room. One emptied chunk is kept
+// as a spare, so a deque hovering around a chunk boundary does not allocate.
+template<typename T, size_t ChunkSize = 64>
+class ChunkedDeque {
+    static_assert(ChunkSize > 1, "ChunkedDeque needs at least two elements per chunk");
+
+private:
+    typedef DequeChunk<T, ChunkSize> Chunk;
+
+    Chunk* front_chunk;
+    Chunk* rear_chunk;
+    Chunk* spare_chunk;
+    size_t front_index;     // First element in front_chunk
+    size_t rear_index;      // One past the last element in rear_chunk
+    size_t current_size;
+
+    Chunk* acquireChunk() {
+        if (spare_chunk != nullptr) {
+            Chunk* chunk = spare_chunk;
+            spare_chunk = nullptr;
+            chunk->prev = nullptr;
+            chunk->next = nullptr;
+            return chunk;
+        }
+        Chunk* chunk = new Chunk();
+        TRACK_ALLOCATION("ChunkedDeque chunk", chunk, sizeof(Chunk));
+        return chunk;
+    }
+
+    void releaseChunk(Chunk* chunk) {
+        if (spare_chunk == nullptr) {
+            spare_chunk = chunk;
+            return;
+        }
+        TRACK_DEALLOCATION("ChunkedDeque chunk", chunk, sizeof(Chunk));
+        delete chunk;
+    }
+
+    void freeChunks() {
+        clear();
+        if (front_chunk != nullptr) {
+            TRACK_DEALLOCATION("ChunkedDeque chunk", front_chunk, sizeof(Chunk));
+            delete front_chunk;
+        }
+        if (spare_chunk != nullptr) {
+            TRACK_DEALLOCATION("ChunkedDeque chunk", spare_chunk, sizeof(Chunk));
+            delete spare_chunk;
+        }
+        front_chunk = nullptr;
+        rear_chunk = nullptr;
+        spare_chunk = nullptr;
+    }
+
+    // Called when the last element is gone; front_chunk == rear_chunk
+    void recenter() {
+        front_index = ChunkSize / 2;
+        rear_index = ChunkSize / 2;
+    }
+
+    // Destroy the front or back element and step past it
+    void discardFront() {
+        front_chunk->slot(front_index)->~T();
+        ++front_index;
+        --current_size;
+        if (current_size == 0) {
+            recenter();
+        } else if (front_index == ChunkSize) {
+            Chunk* emptied = front_chunk;
+            front_chunk = front_chunk->next;
+            front_chunk->prev = nullptr;
+            front_index = 0;
+            releaseChunk(emptied);
+        }
+    }
+
+    void discardBack() {
+        --rear_index;
+        rear_chunk->slot(rear_index)->~T();
+        --current_size;
+        if (current_size == 0) {
+            recenter();
+        } else if (rear_index == 0) {
+            Chunk* emptied = rear_chunk;
+            rear_chunk = rear_chunk->prev;
+            rear_chunk->next = nullptr;
+            rear_index = ChunkSize;
+            releaseChunk(emptied);
+        }
+    }
+
+    void copyFrom(const ChunkedDeque& other) {
+        other.forEach([this](const T& value) { pushBack(value); });
+    }
+
+    void stealFrom(ChunkedDeque& other) {
+        front_chunk = other.front_chunk;
+        rear_chunk = other.rear_chunk;
+        spare_chunk = other.spare_chunk;
+        front_index = other.front_index;
+        rear_index = other.rear_index;
+        current_size = other.current_size;
+        other.front_chunk = nullptr;
+        other.rear_chunk = nullptr;
+        other.spare_chunk = nullptr;
+        other.recenter();
+        other.current_size = 0;
+    }
+
+    // Visit the elements from front to back
+    template<typename Visitor>
+    void forEach(Visitor visit) const {
+        const Chunk* chunk = front_chunk;
+        size_t index = front_index;
+        for (size_t remaining = current_size; remaining > 0; --remaining) {
+            if (index == ChunkSize) {
+                chunk = chunk->next;
+                index = 0;
+            }
+            visit(*chunk->slot(index));
+            ++index;
+        }
+    }
+
+    // Walks chunks from whichever end is nearer (O(n / ChunkSize) complexity)
+    const T* elementAt(int index) const {
+        if (index < 0 || index >= static_cast<int>(current_size)) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        size_t position = static_cast<size_t>(index);
+        const Chunk* chunk;
+        if (position < current_size / 2) {
+            // Start from front
+            size_t offset = front_index + position;
+            chunk = front_chunk;
+            for (size_t i = 0; i < offset / ChunkSize; ++i) {
+                chunk = chunk->next;
+            }
+            return chunk->slot(offset % ChunkSize);
+        }
+
+        // Start from back
+        size_t offset = (ChunkSize - rear_index) + (current_size - 1 - position);
+        chunk = rear_chunk;
+        for (size_t i = 0; i < offset / ChunkSize; ++i) {
+            chunk = chunk->prev;
+        }
+        return chunk->slot(ChunkSize - 1 - offset % ChunkSize);
+    }
+
+public:
+    ChunkedDeque()
+        : front_chunk(nullptr), rear_chunk(nullptr), spare_chunk(nullptr),
+          front_index(ChunkSize / 2), rear_index(ChunkSize / 2), current_size(0) {}
+
+    // Delegating, so the destructor cleans up if a copy throws
+    ChunkedDeque(const ChunkedDeque& other) : ChunkedDeque() {
+        copyFrom(other);
+    }
+
+    ChunkedDeque(ChunkedDeque&& other) noexcept : ChunkedDeque() {
+        stealFrom(other);
+    }
+
+    ChunkedDeque& operator=(const ChunkedDeque& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ChunkedDeque& operator=(ChunkedDeque&& other) noexcept {
+        if (this != &other) {
+            freeChunks();
+            stealFrom(other);
+        }
+        return *this;
+    }
+
+    ~ChunkedDeque() {
+        freeChunks();
+    }
+
+    // Front operations
+    template<typename... Args>
+    void emplaceFront(Args&&... args) {
+        if (front_chunk != nullptr && front_index > 0) {
+            new (front_chunk->slot(front_index - 1)) T(std::forward<Args>(args)...);
+            --front_index;
+        } else if (front_chunk == nullptr) {
+            emplaceIntoFirstChunk(std::forward<Args>(args)...);
+        } else {
+            // Construct before linking the chunk in, so a throwing constructor
+            // leaves the deque as it was
+            Chunk* chunk = acquireChunk();
+            try {
+                new (chunk->slot(ChunkSize - 1)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                releaseChunk(chunk);
+                throw;
+            }
+            chunk->next = front_chunk;
+            front_chunk->prev = chunk;
+            front_chunk = chunk;
+            front_index = ChunkSize - 1;
+        }
+        ++current_size;
+    }
+
+    void pushFront(const T& value) {
+        emplaceFront(value);
+    }
+
+    void pushFront(T&& value) {
+        emplaceFront(std::move(value));
+    }
+
+    T popFront() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot pop from empty deque");
+        }
+
+        T value = std::move(*front_chunk->slot(front_index));
+        discardFront();
+        return value;
+    }
+
+    // Back operations
+    template<typename... Args>
+    void emplaceBack(Args&&... args) {
+        if (rear_chunk != nullptr && rear_index < ChunkSize) {
+            new (rear_chunk->slot(rear_index)) T(std::forward<Args>(args)...);
+            ++rear_index;
+        } else if (rear_chunk == nullptr) {
+            emplaceIntoFirstChunk(std::forward<Args>(args)...);
+        } else {
+            Chunk* chunk = acquireChunk();
+            try {
+                new (chunk->slot(0)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                releaseChunk(chunk);
+                throw;
+            }
+            chunk->prev = rear_chunk;
+            rear_chunk->next = chunk;
+            rear_chunk = chunk;
+            rear_index = 1;
+        }
+        ++current_size;
+    }
+
+    void pushBack(const T& value) {
+        emplaceBack(value);
+    }
+
+    void pushBack(T&& value) {
+        emplaceBack(std::move(value));
+    }
+
+    T popBack() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot pop from empty deque");
+        }
+
+        T value = std::move(*rear_chunk->slot(rear_index - 1));
+        discardBack();
+        return value;
+    }
+
+    // Access operations
+    const T& front() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access front of empty deque");
+        }
+        return *front_chunk->slot(front_index);
+    }
+
+    T& front() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access front of empty deque");
+        }
+        return *front_chunk->slot(front_index);
+    }
+
+    const T& back() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access back of empty deque");
+        }
+        return *rear_chunk->slot(rear_index - 1);
+    }
+
+    T& back() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access back of empty deque");
+        }
+        return *rear_chunk->slot(rear_index - 1);
+    }
+
+    const T& operator[](int index) const {
+        return *elementAt(index);
+    }
+
+    T& operator[](int index) {
+        return *const_cast<T*>(elementAt(index));
+    }
+
+    const T& at(int index) const {
+        return (*this)[index];
+    }
+
+    T& at(int index) {
+        return (*this)[index];
+    }
+
+    // Utility operations
+    bool isEmpty() const {
+        return current_size == 0;
+    }
+
+    size_t size() const {
+        return current_size;
+    }
+
+    // Destroys the elements but keeps a chunk for the next push
+    void clear() {
+        while (current_size > 0) {
+            discardBack();
+        }
+    }
+
+    void display() const {
+        std::cout << "Deque (front to back): ";
+        if (isEmpty()) {
+            std::cout << "EMPTY";
+        } else {
+            forEach([](const T& value) { std::cout << value << " "; });
+        }
+        std::cout << std::endl;
+    }
+
+    void displayReverse() const {
+        std::cout << "Deque (back to front): ";
+        if (isEmpty()) {
+            std::cout << "EMPTY";
+        } else {
+            const Chunk* chunk = rear_chunk;
+            size_t index = rear_index;
+            for (size_t remaining = current_size; remaining > 0; --remaining) {
+                if (index == 0) {
+                    chunk = chunk->prev;
+                    index = ChunkSize;
+                }
+                --index;
+                std::cout << *chunk->slot(index) << " ";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+private:
+    // The first push allocates the one chunk and fills it from the middle
+    template<typename... Args>
+    void emplaceIntoFirstChunk(Args&&... args) {
+        Chunk* chunk = acquireChunk();
+        try {
+            new (chunk->slot(ChunkSize / 2)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            releaseChunk(chunk);
+            throw;
+        }
+        front_chunk = chunk;
+        rear_chunk = chunk;
+        front_index = ChunkSize / 2;
+        rear_index = ChunkSize / 2 + 1;
+    }
 };
\ No newline at end of file
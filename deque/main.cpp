@@ -15,8 +15,9 @@ int main() {
     std::cout << "Features:" << std::endl;
     std::cout << "- Array-based circular deque with dynamic resizing" << std::endl;
     std::cout << "- Doubly linked list-based deque" << std::endl;
+    std::cout << "- Chunked (unrolled) linked list-based deque" << std::endl;
     std::cout << "- Insertion/deletion at both ends in O(1) time" << std::endl;
-    std::cout << "- Random access support (O(1) for array, O(n) for linked)" << std::endl;
+    std::cout << "- Random access support (O(1) for array, O(n) for linked, O(n/64) for chunked)" << std::endl;
     std::cout << "- Copy/Move semantics (Rule of 5)" << std::endl;
     std::cout << "- Deque algorithms: sliding window maximum, palindrome check" << std::endl;
     std::cout << "- Rotation and reversal operations" << std::endl;
@@ -125,7 +126,7 @@ void demonstrateDeque() {
     
     std::cout << "\n--- Step 5: Demonstrating bidirectional iteration ---" << std::endl;
     std::cout << "Forward: ";
-    for (int i = 0; i < deque.size(); ++i) {
+    for (size_t i = 0; i < deque.size(); ++i) {
         std::cout << deque[i] << " ";
     }
     std::cout << std::endl;
@@ -0,0 +1,296 @@
+#include "ExpressionBatch.h"
+#include "../expression_core/MappedFile.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <vector>
+#include <fstream>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+
+// A run of consecutive lines of the mapped input
+struct Chunk {
+    size_t sequence;
+    size_t firstLine;
+    std::string_view text;
+};
+
+struct ChunkResult {
+    std::string text;
+    BatchSummary summary;
+};
+
+class ChunkQueue {
+public:
+    void push(const Chunk& chunk) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            chunks.push_back(chunk);
+        }
+        available.notify_one();
+    }
+
+    // Blocks until a chunk is available; returns false once the queue is closed and drained
+    bool pop(Chunk& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this] { return !chunks.empty() || closed; });
+        if (chunks.empty()) {
+            return false;
+        }
+        chunk = chunks.front();
+        chunks.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        available.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<Chunk> chunks;
+    bool closed = false;
+};
+
+// Reorders finished chunks and bounds how far the reader may run ahead of the writer
+class OrderedResults {
+public:
+    explicit OrderedResults(size_t maxInFlight) : maxInFlight(maxInFlight) {}
+
+    void acquireSlot() {
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFree.wait(lock, [this] { return inFlight < maxInFlight; });
+        ++inFlight;
+    }
+
+    void publish(size_t sequence, ChunkResult&& result) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.emplace(sequence, std::move(result));
+        }
+        resultReady.notify_one();
+    }
+
+    void finish(size_t chunkCount) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            totalChunks = chunkCount;
+            producerDone = true;
+        }
+        resultReady.notify_one();
+    }
+
+    // Writer loop: emits chunks in sequence order until every chunk is written
+    BatchSummary drainTo(std::ostream& output) {
+        BatchSummary total;
+        size_t next = 0;
+
+        while (true) {
+            ChunkResult result;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                resultReady.wait(lock, [&] {
+                    return ready.count(next) != 0 || (producerDone && next == totalChunks);
+                });
+                if (producerDone && next == totalChunks) {
+                    break;
+                }
+                auto it = ready.find(next);
+                result = std::move(it->second);
+                ready.erase(it);
+            }
+
+            output.write(result.text.data(), static_cast<std::streamsize>(result.text.size()));
+            total.expressions += result.summary.expressions;
+            total.evaluated += result.summary.evaluated;
+            total.invalid += result.summary.invalid;
+            total.failed += result.summary.failed;
+            ++next;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --inFlight;
+            }
+            slotFree.notify_one();
+        }
+
+        output.flush();
+        return total;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable resultReady;
+    std::condition_variable slotFree;
+    std::map<size_t, ChunkResult> ready;
+    size_t maxInFlight;
+    size_t inFlight = 0;
+    size_t totalChunks = 0;
+    bool producerDone = false;
+};
+
+void appendNumber(std::string& out, size_t value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+void appendNumber(std::string& out, double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+// Tokenize, validate and evaluate every expression of one chunk
+template<typename Reader, typename TokenT, typename Evaluate>
+ChunkResult processChunk(Reader& reader, const Chunk& chunk, std::vector<TokenT>& tokens, Evaluate evaluate) {
+    ChunkResult result;
+    result.text.reserve(chunk.text.size());
+
+    LineScanner scanner(chunk.text);
+    std::string_view line;
+    std::string errorMessage;
+    size_t lineNumber = chunk.firstLine;
+
+    for (; scanner.next(line); ++lineNumber) {
+        std::string_view expression = ExpressionLexer::trim(line);
+        if (expression.empty() || expression[0] == '#') { // Skip empty lines and comments
+            continue;
+        }
+
+        ++result.summary.expressions;
+        reader.readFromString(expression, tokens);
+        appendNumber(result.text, lineNumber);
+        result.text += ": ";
+
+        if (!reader.validateWithDetails(tokens, errorMessage)) {
+            ++result.summary.invalid;
+            result.text += "error: ";
+            result.text += errorMessage;
+        } else {
+            try {
+                appendNumber(result.text, evaluate(reader, tokens));
+                ++result.summary.evaluated;
+            } catch (const std::exception& e) {
+                ++result.summary.failed;
+                result.text += "error: ";
+                result.text += e.what();
+            }
+        }
+        result.text += '\n';
+    }
+
+    return result;
+}
+
+template<typename Reader, typename TokenT, typename Evaluate>
+void runWorker(Reader reader, ChunkQueue& queue, OrderedResults& results, Evaluate evaluate) {
+    std::vector<TokenT> tokens;
+    Chunk chunk;
+    while (queue.pop(chunk)) {
+        results.publish(chunk.sequence, processChunk<Reader, TokenT>(reader, chunk, tokens, evaluate));
+    }
+}
+
+} // namespace
+
+ExpressionBatchProcessor::ExpressionBatchProcessor(const BatchOptions& options) : options(options) {
+    if (this->options.workerCount == 0) {
+        this->options.workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->options.linesPerChunk == 0) {
+        this->options.linesPerChunk = 1;
+    }
+    if (this->options.maxChunksInFlight == 0) {
+        this->options.maxChunksInFlight = static_cast<size_t>(this->options.workerCount) * 4;
+    }
+}
+
+void ExpressionBatchProcessor::setVariable(const std::string& name, double value) {
+    postfixPrototype.setVariable(name, value);
+    prefixPrototype.setVariable(name, value);
+}
+
+void ExpressionBatchProcessor::setVariables(const std::unordered_map<std::string, double>& vars) {
+    postfixPrototype.setVariables(vars);
+    prefixPrototype.setVariables(vars);
+}
+
+BatchSummary ExpressionBatchProcessor::processFile(const std::string& inputFile, std::ostream& output) {
+    MappedFile file(inputFile);
+    std::string_view input = file.view();
+
+    ChunkQueue queue;
+    OrderedResults results(options.maxChunksInFlight);
+
+    std::vector<std::thread> workers;
+    workers.reserve(options.workerCount);
+    for (unsigned i = 0; i < options.workerCount; ++i) {
+        if (options.notation == ExpressionNotation::POSTFIX) {
+            workers.emplace_back(runWorker<PostfixReader, Token, double (*)(PostfixReader&, const std::vector<Token>&)>,
+                                 postfixPrototype, std::ref(queue), std::ref(results),
+                                 [](PostfixReader& reader, const std::vector<Token>& tokens) {
+                                     return reader.evaluatePostfix(tokens);
+                                 });
+        } else {
+            workers.emplace_back(runWorker<PrefixReader, PrefixToken, double (*)(PrefixReader&, const std::vector<PrefixToken>&)>,
+                                 prefixPrototype, std::ref(queue), std::ref(results),
+                                 [](PrefixReader& reader, const std::vector<PrefixToken>& tokens) {
+                                     return reader.evaluatePrefix(tokens);
+                                 });
+        }
+    }
+
+    BatchSummary summary;
+    std::thread writer([&] { summary = results.drainTo(output); });
+
+    // Reader stage: cut the mapping into runs of linesPerChunk lines
+    size_t chunkCount = 0;
+    size_t lineNumber = 1;
+    size_t pos = 0;
+    while (pos < input.size()) {
+        size_t end = pos;
+        size_t lines = 0;
+        while (end < input.size() && lines < options.linesPerChunk) {
+            const void* found = std::memchr(input.data() + end, '\n', input.size() - end);
+            end = found ? static_cast<size_t>(static_cast<const char*>(found) - input.data()) + 1 : input.size();
+            ++lines;
+        }
+
+        results.acquireSlot();
+        queue.push(Chunk{chunkCount++, lineNumber, input.substr(pos, end - pos)});
+        lineNumber += lines;
+        pos = end;
+    }
+
+    results.finish(chunkCount);
+    queue.close();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    writer.join();
+
+    return summary;
+}
+
+BatchSummary ExpressionBatchProcessor::processFile(const std::string& inputFile, const std::string& outputFile) {
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        throw std::runtime_error("Cannot open file: " + outputFile);
+    }
+    return processFile(inputFile, output);
+}
+
+const BatchOptions& ExpressionBatchProcessor::getOptions() const {
+    return options;
+}
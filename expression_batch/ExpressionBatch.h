@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <ostream>
+#include <unordered_map>
+#include <cstddef>
+#include "../postfix_reader/PostfixReader.h"
+#include "../prefix_reader/PrefixReader.h"
+
+// Multi-threaded batch validation/evaluation of expression files.
+// Build together with the readers it drives:
+//   g++ -std=c++17 -O2 -pthread *.cpp ../postfix_reader/PostfixReader.cpp ../prefix_reader/PrefixReader.cpp
+
+enum class ExpressionNotation {
+    POSTFIX,
+    PREFIX
+};
+
+struct BatchOptions {
+    ExpressionNotation notation = ExpressionNotation::POSTFIX;
+    unsigned workerCount = 0;        // 0 = one worker per hardware thread
+    size_t linesPerChunk = 4096;     // Lines handed to a worker at a time
+    size_t maxChunksInFlight = 0;    // 0 = four chunks per worker
+};
+
+struct BatchSummary {
+    size_t expressions = 0;
+    size_t evaluated = 0;
+    size_t invalid = 0;              // Rejected by validateWithDetails
+    size_t failed = 0;               // Valid shape but evaluation threw (undefined variable, division by zero, ...)
+};
+
+// Pipeline: the calling thread maps the file and splits it into chunks of lines,
+// worker threads tokenize, validate and evaluate each chunk with their own reader,
+// and a writer thread emits the results strictly in input order.
+// Output has one line per expression: "<line>: <value>" or "<line>: error: <message>".
+class ExpressionBatchProcessor {
+public:
+    explicit ExpressionBatchProcessor(const BatchOptions& options = BatchOptions());
+
+    // Variables and functions are copied into every worker's reader
+    void setVariable(const std::string& name, double value);
+    void setVariables(const std::unordered_map<std::string, double>& vars);
+
+    // Process inputFile and write results to output (or to outputFile)
+    BatchSummary processFile(const std::string& inputFile, std::ostream& output);
+    BatchSummary processFile(const std::string& inputFile, const std::string& outputFile);
+
+    const BatchOptions& getOptions() const;
+
+private:
+    BatchOptions options;
+    PostfixReader postfixPrototype;
+    PrefixReader prefixPrototype;
+};
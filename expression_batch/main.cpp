@@ -0,0 +1,104 @@
+#include "ExpressionBatch.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+void writeSampleFile(const std::string& filename, size_t count) {
+    std::ofstream file(filename);
+    file << "# generated postfix expressions\n";
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 5) {
+            case 0: file << i << " 2 * 3 +\n"; break;
+            case 1: file << "x y + " << i << " *\n"; break;
+            case 2: file << i << " 0 /\n"; break;          // Division by zero
+            case 3: file << i << " +\n"; break;            // Too few operands
+            case 4: file << i << " sqrt 1 -\n"; break;
+        }
+    }
+}
+
+void testSmallBatch() {
+    std::cout << "\n=== Small Batch (results in input order) ===" << std::endl;
+    
+    const std::string filename = "batch_small.txt";
+    writeSampleFile(filename, 10);
+    
+    BatchOptions options;
+    options.workerCount = 3;
+    options.linesPerChunk = 2;
+    
+    ExpressionBatchProcessor processor(options);
+    processor.setVariable("x", 1.5);
+    processor.setVariable("y", 2.5);
+    
+    std::ostringstream output;
+    BatchSummary summary = processor.processFile(filename, output);
+    std::cout << output.str();
+    std::cout << "Expressions: " << summary.expressions
+              << ", evaluated: " << summary.evaluated
+              << ", invalid: " << summary.invalid
+              << ", failed: " << summary.failed << std::endl;
+}
+
+void testPrefixBatch() {
+    std::cout << "\n=== Prefix Batch ===" << std::endl;
+    
+    const std::string filename = "batch_prefix.txt";
+    {
+        std::ofstream file(filename);
+        file << "+ 3 * 4 5\n";
+        file << "sqrt 16\n";
+        file << "- 10\n";
+    }
+    
+    BatchOptions options;
+    options.notation = ExpressionNotation::PREFIX;
+    
+    ExpressionBatchProcessor processor(options);
+    std::ostringstream output;
+    processor.processFile(filename, output);
+    std::cout << output.str();
+}
+
+void testLargeBatch() {
+    std::cout << "\n=== Large Batch Throughput ===" << std::endl;
+    
+    const std::string filename = "batch_large.txt";
+    const size_t count = 1000000;
+    writeSampleFile(filename, count);
+    
+    for (unsigned workers : {1u, 2u, 4u, 8u}) {
+        BatchOptions options;
+        options.workerCount = workers;
+        
+        ExpressionBatchProcessor processor(options);
+        processor.setVariable("x", 1.5);
+        processor.setVariable("y", 2.5);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        BatchSummary summary = processor.processFile(filename, "batch_large_results.txt");
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << workers << " worker(s): " << summary.expressions << " expressions in "
+                  << seconds << " s (" << static_cast<size_t>(summary.expressions / seconds)
+                  << " expr/s)" << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "Parallel Expression Batch Processor" << std::endl;
+    std::cout << "===================================" << std::endl;
+    
+    try {
+        testSmallBatch();
+        testPrefixBatch();
+        testLargeBatch();
+    } catch (const std::exception& e) {
+        std::cout << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,634 @@
+// Expression reader benchmarks.
+// Build: g++ -std=c++17 -O2 main.cpp ../prefix_reader/PrefixReader.cpp ../postfix_reader/PostfixReader.cpp
+//        ../postfix_linkedStack/LinkedStack.cpp ../postfix_arrayStack/ArrayStack.cpp ../prefix_arrayStack/PrefixArrayStack.cpp
+//        ../value_eval/ValueEvaluator.cpp
+//        (add -DTRACK_ALLOCATIONS for the per-container allocation table at the end)
+#include "../prefix_reader/PrefixReader.h"
+#include "../postfix_reader/PostfixReader.h"
+#include "../postfix_linkedStack/LinkedStack.h"
+#include "../postfix_arrayStack/ArrayStack.h"
+#include "../prefix_arrayStack/PrefixArrayStack.h"
+#include "../value_eval/ValueEvaluator.h"
+#include "../expression_core/AutoDiff.h"
+#include "../expression_core/Interval.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cmath>
+
+// "+ 1 + 1 ... + 1 0": every operator nests inside the previous one
+std::string makeDeepChain(size_t depth) {
+    std::string expression;
+    expression.reserve(depth * 4 + 1);
+    for (size_t i = 0; i < depth; ++i) {
+        expression += "+ 1 ";
+    }
+    expression += "0";
+    return expression;
+}
+
+template<typename Func>
+double measureMicroseconds(Func func, int repetitions) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; ++i) {
+        func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / repetitions;
+}
+
+void compareAtDepth(PrefixReader& reader, size_t depth, int repetitions) {
+    std::string expression = makeDeepChain(depth);
+    std::vector<PrefixToken> tokens = reader.readFromString(expression);
+    
+    double recursiveEval = measureMicroseconds([&] { reader.evaluatePrefixRecursive(tokens); }, repetitions);
+    double iterativeEval = measureMicroseconds([&] { reader.evaluatePrefix(tokens); }, repetitions);
+    double recursiveInfix = measureMicroseconds([&] { reader.prefixToInfixRecursive(expression); }, repetitions);
+    double iterativeInfix = measureMicroseconds([&] { reader.prefixToInfix(expression); }, repetitions);
+    
+    std::cout << std::setw(8) << depth
+              << std::setw(14) << recursiveEval
+              << std::setw(14) << iterativeEval
+              << std::setw(14) << recursiveInfix
+              << std::setw(14) << iterativeInfix << std::endl;
+}
+
+void testRecursiveVsIterative() {
+    std::cout << "\n=== Recursive vs Iterative (microseconds per call) ===" << std::endl;
+    std::cout << std::setw(8) << "depth"
+              << std::setw(14) << "eval rec"
+              << std::setw(14) << "eval iter"
+              << std::setw(14) << "infix rec"
+              << std::setw(14) << "infix iter" << std::endl;
+    
+    PrefixReader reader;
+    std::cout << std::fixed << std::setprecision(2);
+    // Recursion depth stays small enough here for the default call stack
+    compareAtDepth(reader, 10, 10000);
+    compareAtDepth(reader, 100, 2000);
+    compareAtDepth(reader, 1000, 200);
+    compareAtDepth(reader, 10000, 20);
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+}
+
+void testVeryDeepExpressions() {
+    std::cout << "\n=== Very Deep Expressions (iterative only) ===" << std::endl;
+    
+    PrefixReader reader;
+    for (size_t depth : {100000u, 1000000u}) {
+        std::string expression = makeDeepChain(depth);
+        
+        auto start = std::chrono::steady_clock::now();
+        double value = reader.evaluatePrefix(expression);
+        size_t postfixLength = reader.prefixToPostfix(expression).size();
+        size_t infixLength = reader.prefixToInfix(expression).size();
+        auto end = std::chrono::steady_clock::now();
+        
+        std::cout << "Depth " << depth << ": value = " << value
+                  << ", postfix length = " << postfixLength
+                  << ", infix length = " << infixLength
+                  << " (" << std::chrono::duration<double, std::milli>(end - start).count() << " ms)" << std::endl;
+    }
+}
+
+void testLargeConversions() {
+    std::cout << "\n=== Large Conversions (postfix/infix to prefix) ===" << std::endl;
+    
+    PrefixReader reader;
+    for (size_t terms : {10000u, 100000u, 1000000u}) {
+        // "1 1 + 1 + ..." and "1 + 1 + ..." with terms operators
+        std::string postfix = "1";
+        std::string infix = "1";
+        postfix.reserve(terms * 4 + 1);
+        infix.reserve(terms * 4 + 1);
+        for (size_t i = 0; i < terms; ++i) {
+            postfix += " 1 +";
+            infix += " + 1";
+        }
+        
+        double postfixTime = measureMicroseconds([&] { reader.postfixToPrefix(postfix); }, 3) / 1000.0;
+        double infixTime = measureMicroseconds([&] { reader.infixToPrefix(infix); }, 3) / 1000.0;
+        
+        std::cout << "Input " << postfix.size() << " bytes: postfixToPrefix " << postfixTime
+                  << " ms, infixToPrefix " << infixTime << " ms" << std::endl;
+    }
+}
+
+void testCompactTokens() {
+    std::cout << "\n=== String Tokens vs Compact Tokens (microseconds per evaluation) ===" << std::endl;
+    
+    PostfixReader reader;
+    reader.setVariable("alpha", 1.5);
+    reader.setVariable("beta", 2.5);
+    reader.setVariable("gamma", 0.5);
+    
+    std::string expression = "alpha beta * gamma + sqrt";
+    for (int i = 0; i < 50; ++i) {
+        expression += " alpha beta - abs gamma * +";
+    }
+    
+    std::vector<Token> tokens = reader.readFromString(expression);
+    std::vector<CompactToken> program = reader.compile(expression);
+    
+    double stringTime = measureMicroseconds([&] { reader.evaluatePostfix(tokens); }, 20000);
+    double compactTime = measureMicroseconds([&] { reader.evaluateCompiled(program); }, 20000);
+    
+    std::cout << tokens.size() << " tokens (" << sizeof(Token) << " vs " << sizeof(CompactToken) << " bytes each): "
+              << "string " << stringTime << ", compact " << compactTime << std::endl;
+}
+
+void testArrayStackEvaluators() {
+    std::cout << "\n=== ArrayStack vs LinkedStack Evaluators (microseconds per evaluation) ===" << std::endl;
+    
+    // Flat: "1 2 + 3 + ..." ; nested: "1 2 3 ... + + +"
+    std::string flatPostfix = "1";
+    std::string nestedPostfix = "1";
+    std::string prefix = "1";
+    for (int i = 2; i <= 200; ++i) {
+        flatPostfix += " " + std::to_string(i) + " +";
+        nestedPostfix += " " + std::to_string(i);
+        prefix = "+ " + std::to_string(i) + " " + prefix;
+    }
+    for (int i = 2; i <= 200; ++i) {
+        nestedPostfix += " *";
+    }
+    
+    // First calls create the per-thread stacks (and print their constructor trace)
+    PostfixArrayEvaluator::evaluate(flatPostfix);
+    PrefixArrayEvaluator::evaluate(prefix);
+    
+    const int repetitions = 20000;
+    std::cout << "postfix flat:   linked " << measureMicroseconds([&] { PostfixLinkedEvaluator::evaluate(flatPostfix); }, repetitions)
+              << ", array " << measureMicroseconds([&] { PostfixArrayEvaluator::evaluate(flatPostfix); }, repetitions) << std::endl;
+    std::cout << "postfix nested: linked " << measureMicroseconds([&] { PostfixLinkedEvaluator::evaluate(nestedPostfix); }, repetitions)
+              << ", array " << measureMicroseconds([&] { PostfixArrayEvaluator::evaluate(nestedPostfix); }, repetitions) << std::endl;
+    
+    // The prefix linked-stack evaluator is declaration-only, so PrefixReader stands in for it
+    PrefixReader reader;
+    std::cout << "prefix:         reader " << measureMicroseconds([&] { reader.evaluatePrefix(prefix); }, repetitions)
+              << ", array " << measureMicroseconds([&] { PrefixArrayEvaluator::evaluate(prefix); }, repetitions) << std::endl;
+}
+
+void testNumericTypes() {
+    std::cout << "\n=== Number Types (microseconds per evaluation) ===" << std::endl;
+    
+    // Compound interest over 12 periods: principal * (1 + rate / 12) ^ 12
+    PostfixReader reader;
+    std::string expression = "1000.00 1 0.05 12 / + 12 ^ *";
+    const int repetitions = 2000;
+    
+    std::cout << "double:           " << reader.evaluatePostfixAs<double>(expression) << " in "
+              << measureMicroseconds([&] { reader.evaluatePostfixAs<double>(expression); }, repetitions) << std::endl;
+    std::cout << "FixedDecimal<10>: " << reader.evaluatePostfixAs<FixedDecimal<10>>(expression).toString() << " in "
+              << measureMicroseconds([&] { reader.evaluatePostfixAs<FixedDecimal<10>>(expression); }, repetitions) << std::endl;
+    std::cout << "Rational:         " << reader.evaluatePostfixAs<Rational>(expression).toDouble() << " (exact) in "
+              << measureMicroseconds([&] { reader.evaluatePostfixAs<Rational>(expression); }, repetitions) << std::endl;
+}
+
+void testGradients() {
+    std::cout << "\n=== Gradients (microseconds per gradient) ===" << std::endl;
+    
+    // sin(x0 * x1) + sin(x1 * x2) + ... over 32 variables, in postfix
+    const size_t count = 32;
+    std::vector<std::string> names;
+    std::vector<double> point;
+    std::string expression;
+    for (size_t i = 0; i < count; ++i) {
+        names.push_back("x" + std::to_string(i));
+        point.push_back(0.1 * static_cast<double>(i + 1));
+    }
+    for (size_t i = 0; i + 1 < count; ++i) {
+        expression += names[i] + " " + names[i + 1] + " * sin ";
+        if (i > 0) expression += "+ ";
+    }
+    
+    GradientProgram program(expression, names);
+    std::vector<double> gradient;
+    const int repetitions = 2000;
+    
+    // Central differences: two extra evaluations per variable
+    double finiteDifferences = measureMicroseconds([&] {
+        std::vector<double> shifted = point;
+        gradient.assign(count, 0.0);
+        for (size_t i = 0; i < count; ++i) {
+            const double h = 1e-6;
+            shifted[i] = point[i] + h;
+            double above = program.evaluate(shifted);
+            shifted[i] = point[i] - h;
+            double below = program.evaluate(shifted);
+            shifted[i] = point[i];
+            gradient[i] = (above - below) / (2 * h);
+        }
+    }, repetitions);
+    double reverseMode = measureMicroseconds([&] { program.evaluate(point, gradient); }, repetitions);
+    
+    std::cout << count << " variables, " << program.size() << " instructions" << std::endl;
+    std::cout << "Single evaluation:  " << measureMicroseconds([&] { program.evaluate(point); }, repetitions) << std::endl;
+    std::cout << "Finite differences: " << finiteDifferences << std::endl;
+    std::cout << "Reverse mode:       " << reverseMode << std::endl;
+}
+
+// Grid points in [x0, x0 + cells * step) x [y0, ...) satisfying "lhs < 1", pruning
+// sub-boxes whose interval bound decides the comparison for every point
+long countBelowOne(const std::string& lhs, double x0, double y0, double step, int cells, long& evaluations) {
+    Interval xs(x0, x0 + (cells - 1) * step);
+    Interval ys(y0, y0 + (cells - 1) * step);
+    Interval decided = compareIntervals(evaluateNumeric<Interval>(lhs, false, {{"x", xs}, {"y", ys}}), "<", Interval(1.0));
+    if (decided.isPoint()) {
+        return decided.lower == 1.0 ? static_cast<long>(cells) * cells : 0;
+    }
+    
+    if (cells <= 4) {
+        long count = 0;
+        for (int i = 0; i < cells; ++i) {
+            for (int j = 0; j < cells; ++j) {
+                ++evaluations;
+                count += evaluateNumeric<double>(lhs, false, {{"x", x0 + i * step}, {"y", y0 + j * step}}) < 1.0;
+            }
+        }
+        return count;
+    }
+    
+    int half = cells / 2;
+    return countBelowOne(lhs, x0, y0, step, half, evaluations) +
+           countBelowOne(lhs, x0 + half * step, y0, step, half, evaluations) +
+           countBelowOne(lhs, x0, y0 + half * step, step, half, evaluations) +
+           countBelowOne(lhs, x0 + half * step, y0 + half * step, step, half, evaluations);
+}
+
+void testRangePruning() {
+    std::cout << "\n=== Interval Pruning (x^2 + sin(y)^2 < 1 on a 256 x 256 grid) ===" << std::endl;
+    
+    std::string lhs = "x 2 ^ y sin 2 ^ +";
+    const int cells = 256;
+    const double step = 8.0 / cells;
+    
+    long sweepCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cells; ++i) {
+        for (int j = 0; j < cells; ++j) {
+            sweepCount += evaluateNumeric<double>(lhs, false, {{"x", -4 + i * step}, {"y", -4 + j * step}}) < 1.0;
+        }
+    }
+    double sweepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    long evaluations = 0;
+    start = std::chrono::steady_clock::now();
+    long prunedCount = countBelowOne(lhs, -4, -4, step, cells, evaluations);
+    double prunedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Full sweep: " << sweepCount << " points inside, " << cells * cells
+              << " evaluations, " << sweepMs << " ms" << std::endl;
+    std::cout << "Pruned:     " << prunedCount << " points inside, " << evaluations
+              << " evaluations, " << prunedMs << " ms" << std::endl;
+}
+
+void testFormulaDag() {
+    std::cout << "\n=== Shared Formula DAG (microseconds per pass over all formulas) ===" << std::endl;
+    
+    // 2000 formulas, each a different weighting of the same two costly terms
+    PrefixReader reader;
+    reader.setVariable("x", 0.7);
+    reader.setVariable("y", 1.3);
+    std::string shared = "+ sqrt + * x x * y y * exp - 0 x cos * 3 y";
+    std::string other = "/ log + 1 * x y atan - x y";
+    
+    std::vector<std::vector<CompactToken>> programs;
+    for (int i = 0; i < 2000; ++i) {
+        std::string formula = "+ * " + std::to_string(i % 50) + " " + shared + " * " + std::to_string(i / 50) + " " + other;
+        programs.push_back(reader.compile(formula));
+        reader.addFormula(formula);
+    }
+    
+    std::vector<double> results;
+    double separate = measureMicroseconds([&] {
+        for (const auto& program : programs) {
+            reader.evaluateCompiled(program);
+        }
+    }, 200);
+    double dag = measureMicroseconds([&] { reader.evaluateFormulas(results); }, 200);
+    
+    const ExpressionDag& formulas = reader.getFormulas();
+    std::cout << formulas.getFormulaCount() << " formulas, " << formulas.getTokenCount() << " tokens, "
+              << formulas.getNodeCount() << " unique nodes" << std::endl;
+    std::cout << "One by one: " << separate << std::endl;
+    std::cout << "Shared DAG: " << dag << std::endl;
+}
+
+// The fallback chain ValueEvaluator::evaluate used before tryEvaluate: up to three throws per bad input
+double evaluateWithFallbacks(const std::string& expression) {
+    try {
+        return ValueEvaluator::evaluateComplex(expression);
+    } catch (const std::exception&) {
+        try {
+            return ValueEvaluator::evaluateArithmetic(expression);
+        } catch (const std::exception&) {
+            return ValueEvaluator::evaluatePostfix(ValueEvaluator::infixToPostfix(expression));
+        }
+    }
+}
+
+void testErrorHandling() {
+    std::cout << "\n=== Exceptions vs Result Codes (nanoseconds per input, half invalid) ===" << std::endl;
+    
+    std::vector<std::string> infix = {
+        "(1 + 2) * 3 - 4 / 5", "(1 + 2", "2 * (3 + 4) % 5", "1 + * 2",
+        "sqrt(16) + abs(0 - 3)", "1 / (2 - 2)", "10 - 4 - 3 + 2", "3 $ 4"
+    };
+    std::vector<std::string> postfix = {
+        "1 2 + 3 * 4 5 / -", "1 2 + +", "2 3 4 + * 5 %", "1 2 $",
+        "16 sqrt 3 abs +", "1 2 2 - /", "10 4 - 3 - 2 +", "1 2"
+    };
+    
+    const int repetitions = 20000;
+    auto perInput = [&](double microseconds, size_t inputs) { return microseconds * 1000.0 / inputs; };
+    size_t failures = 0;
+    
+    double fallbackChain = measureMicroseconds([&] {
+        for (const std::string& expression : infix) {
+            try { evaluateWithFallbacks(expression); } catch (const std::exception&) { ++failures; }
+        }
+    }, repetitions);
+    double singleThrow = measureMicroseconds([&] {
+        for (const std::string& expression : infix) {
+            try { ValueEvaluator::evaluate(expression); } catch (const std::exception&) { ++failures; }
+        }
+    }, repetitions);
+    double resultCodes = measureMicroseconds([&] {
+        for (const std::string& expression : infix) {
+            failures += !ValueEvaluator::tryEvaluate(expression);
+        }
+    }, repetitions);
+    
+    std::cout << "Infix, fallback chain:       " << perInput(fallbackChain, infix.size()) << std::endl;
+    std::cout << "Infix, evaluate + catch:     " << perInput(singleThrow, infix.size()) << std::endl;
+    std::cout << "Infix, tryEvaluate:          " << perInput(resultCodes, infix.size()) << std::endl;
+    
+    PostfixReader reader;
+    double readerThrow = measureMicroseconds([&] {
+        for (const std::string& expression : postfix) {
+            try { reader.evaluatePostfix(expression); } catch (const std::exception&) { ++failures; }
+        }
+    }, repetitions);
+    double readerResult = measureMicroseconds([&] {
+        for (const std::string& expression : postfix) {
+            failures += !reader.tryEvaluatePostfix(expression);
+        }
+    }, repetitions);
+    
+    std::cout << "Postfix, evaluate + catch:   " << perInput(readerThrow, postfix.size()) << std::endl;
+    std::cout << "Postfix, tryEvaluatePostfix: " << perInput(readerResult, postfix.size()) << std::endl;
+    std::cout << "(" << failures << " failures)" << std::endl;
+}
+
+void testProgramFile() {
+    std::cout << "\n=== Program File Load (milliseconds to first result of every formula) ===" << std::endl;
+    
+    std::vector<std::string> formulas;
+    for (int i = 0; i < 20000; ++i) {
+        formulas.push_back("x " + std::to_string(i) + " * rate sqrt + y " + std::to_string(i % 7 + 1) + " / sin *");
+    }
+    std::string filename = "benchmark_programs.bin";
+    {
+        PostfixReader writer;
+        std::vector<std::vector<CompactToken>> programs;
+        for (const std::string& formula : formulas) {
+            programs.push_back(writer.compile(formula));
+        }
+        writer.saveCompiled(filename, programs);
+    }
+    
+    auto setInputs = [](PostfixReader& reader) {
+        reader.setVariable("x", 0.5);
+        reader.setVariable("y", 2.0);
+        reader.setVariable("rate", 0.3);
+    };
+    double fromText = 0.0;
+    double fromFile = 0.0;
+    double textMs = measureMicroseconds([&] {
+        PostfixReader reader;
+        setInputs(reader);
+        fromText = 0.0;
+        for (const std::string& formula : formulas) {
+            fromText += reader.evaluateCompiled(reader.compile(formula));
+        }
+    }, 5) / 1000.0;
+    double fileMs = measureMicroseconds([&] {
+        PostfixReader reader;
+        setInputs(reader);
+        ProgramFile file = reader.loadCompiled(filename);
+        fromFile = 0.0;
+        for (size_t i = 0; i < file.getProgramCount(); ++i) {
+            fromFile += reader.evaluateCompiled(file, i);
+        }
+    }, 5) / 1000.0;
+    std::remove(filename.c_str());
+    
+    std::cout << "Parse text:   " << textMs << std::endl;
+    std::cout << "Mapped file:  " << fileMs << std::endl;
+    std::cout << "Results match: " << (fromText == fromFile ? "yes" : "no") << std::endl;
+}
+
+void testFunctionCalls() {
+    std::cout << "\n=== Function Calls (nanoseconds per compiled evaluation) ===" << std::endl;
+    
+    PostfixReader reader;
+    reader.setVariable("x", 0.75);
+    reader.setVariable("y", -1.5);
+    
+    // lerp(a, b, t) as a callback that runs a second program, against inlining it
+    PostfixReader body;
+    std::vector<CompactToken> lerpBody = body.compile("a b a - t * +");
+    body.setVariable("a", 0.0);
+    body.setVariable("b", 10.0);
+    PostfixReader wrapped = reader;
+    wrapped.setFunction("lerp", [&](double t) {
+        body.setVariable("t", t);
+        return body.evaluateCompiled(lerpBody);
+    });
+    reader.defineFunction("lerp", {"a", "b", "t"}, "a b a - t * +");
+    std::vector<CompactToken> wrappedLerp = wrapped.compile("x y * lerp");
+    std::vector<CompactToken> inlinedLerp = reader.compile("0 10 x y * lerp");
+    
+    // min(x, y) without an n-ary function: (x + y - |x - y|) / 2
+    std::vector<CompactToken> emulatedMin = reader.compile("x y + x y - abs - 2 /");
+    std::vector<CompactToken> builtinMin = reader.compile("x y min");
+    
+    const int repetitions = 1000000;
+    auto perEvaluation = [&](const PostfixReader& evaluator, const std::vector<CompactToken>& program) {
+        return measureMicroseconds([&] { evaluator.evaluateCompiled(program); }, repetitions) * 1000.0;
+    };
+    std::cout << "lerp as a callback: " << perEvaluation(wrapped, wrappedLerp) << std::endl;
+    std::cout << "lerp inlined:       " << perEvaluation(reader, inlinedLerp) << std::endl;
+    std::cout << "min emulated:       " << perEvaluation(reader, emulatedMin) << std::endl;
+    std::cout << "min builtin:        " << perEvaluation(reader, builtinMin) << std::endl;
+}
+
+// The n-ary builtins in every engine: each result is checked against the
+// compiled program, and exact types must reject what they cannot compute
+void testNaryFunctionsAcrossEngines() {
+    std::cout << "\n=== n-ary Builtins Across Engines (min, max, atan2, hypot, clamp) ===" << std::endl;
+    
+    const std::string infix = "min(x, y) * 2 + hypot(x, y) - clamp(x, 0, 1) + atan2(y, x) * max(x, y)";
+    const std::string postfix = "x y min 2 * x y hypot + x 0 1 clamp - y x atan2 x y max * +";
+    const std::string prefix = "+ - + * min x y 2 hypot x y clamp x 0 1 * atan2 y x max x y";
+    const double x = 3.0;
+    const double y = -4.0;
+    
+    PostfixReader postfixReader;
+    PrefixReader prefixReader;
+    postfixReader.setVariable("x", x);
+    postfixReader.setVariable("y", y);
+    prefixReader.setVariable("x", x);
+    prefixReader.setVariable("y", y);
+    double expected = postfixReader.evaluateCompiled(postfixReader.compile(postfix));
+    
+    int failures = 0;
+    auto check = [&](const char* label, double value) {
+        bool same = std::abs(value - expected) <= 1e-12 * (1.0 + std::abs(expected));
+        failures += same ? 0 : 1;
+        std::cout << std::left << std::setw(28) << label << value << (same ? "" : "  MISMATCH") << std::endl;
+    };
+    
+    std::unordered_map<std::string, double> point = {{"x", x}, {"y", y}};
+    check("Compiled postfix:", expected);
+    check("Postfix tokens:", postfixReader.evaluatePostfix(postfixReader.readFromString(postfix)));
+    check("Prefix tokens:", prefixReader.evaluatePrefix(prefixReader.readFromString(prefix)));
+    check("Prefix recursive:", prefixReader.evaluatePrefixRecursive(prefixReader.readFromString(prefix)));
+    check("Infix:", ValueEvaluator::evaluate(infix, point));
+    check("evaluateAs<double>:", ValueEvaluator::evaluateAs<double>(infix, point));
+    check("Infix to prefix:", prefixReader.evaluatePrefix(prefixReader.infixToPrefix(infix)));
+    check("Prefix to infix:", ValueEvaluator::evaluate(prefixReader.prefixToInfix(prefix), point));
+    check("Postfix to prefix:", prefixReader.evaluatePrefix(prefixReader.postfixToPrefix(postfix)));
+    
+    // Gradients (min, max and clamp take the subgradient of the operand they pick)
+    // against central differences, in both automatic differentiation modes
+    GradientProgram gradientProgram(postfix, {"x", "y"});
+    std::vector<double> gradient;
+    gradientProgram.evaluate({x, y}, gradient);
+    Dual forward = evaluateNumeric<Dual>(postfix, false, {{"x", Dual(x, 1.0)}, {"y", Dual(y)}});
+    const double h = 1e-6;
+    double centralX = (ValueEvaluator::evaluate(infix, {{"x", x + h}, {"y", y}}) -
+                       ValueEvaluator::evaluate(infix, {{"x", x - h}, {"y", y}})) / (2 * h);
+    bool gradientsAgree = std::abs(gradient[0] - centralX) < 1e-6 && std::abs(forward.derivative - gradient[0]) < 1e-12;
+    failures += gradientsAgree ? 0 : 1;
+    std::cout << std::left << std::setw(28) << "d/dx reverse, forward:" << gradient[0] << ", " << forward.derivative
+              << " (central differences " << centralX << ")" << (gradientsAgree ? "" : "  MISMATCH") << std::endl;
+    
+    // Interval bound must contain every sampled point of the box
+    Interval range = ValueEvaluator::evaluateRange(infix, {{"x", Interval(2.0, 4.0)}, {"y", Interval(-5.0, -3.0)}});
+    bool enclosed = true;
+    for (int i = 0; i <= 20; ++i) {
+        for (int j = 0; j <= 20; ++j) {
+            enclosed = enclosed && range.contains(ValueEvaluator::evaluate(infix, {{"x", 2.0 + i * 0.1}, {"y", -5.0 + j * 0.1}}));
+        }
+    }
+    failures += enclosed ? 0 : 1;
+    std::cout << std::left << std::setw(28) << "Range over the box:" << NumericTraits<Interval>::toString(range)
+              << (enclosed ? "" : "  MISSES A POINT") << std::endl;
+    
+    // Exact types order min, max and clamp exactly and reject atan2 and hypot
+    Rational exact = postfixReader.evaluatePostfixAs<Rational>("0.1 0.2 1 clamp 1 3 / 0.3 max +");
+    failures += exact.toString() == "8/15" ? 0 : 1;
+    std::cout << std::left << std::setw(28) << "Rational clamp + max:" << exact.toString() << std::endl;
+    try {
+        postfixReader.evaluatePostfixAs<Rational>("1 2 atan2");
+        failures += 1;
+        std::cout << "Rational atan2 was not rejected" << std::endl;
+    } catch (const std::invalid_argument& error) {
+        std::cout << std::left << std::setw(28) << "Rational atan2:" << error.what() << std::endl;
+    }
+    
+    std::cout << (failures == 0 ? "All engines agree" : "FAILURES: " + std::to_string(failures)) << std::endl;
+}
+
+void testValueCache() {
+    std::cout << "\n=== Cached vs Uncached Infix Evaluation ===" << std::endl;
+    
+    const std::vector<std::pair<std::string, std::unordered_map<std::string, double>>> cases = {
+        {"-(x)^2", {{"x", 3.0}}},
+        {"-(x + 1)^y", {{"x", 3.0}, {"y", 2.0}}},
+        {"2 * -(x)^y + 1", {{"x", 3.0}, {"y", 3.0}}},
+        {"-sqrt(x)^2", {{"x", 4.0}}},
+        {"-x^2", {{"x", 3.0}}},
+        {"_x + 1", {{"_x", 100.0}, {"x", 3.0}}},
+        {"neg + 1", {{"neg", 2.0}}},
+        {"-neg * _", {{"neg", 2.0}, {"_", 5.0}}},
+    };
+    
+    int failures = 0;
+    for (const auto& entry : cases) {
+        ValueEvaluator::disableCache();
+        double expected = ValueEvaluator::evaluate(entry.first, entry.second);
+        ValueEvaluator::enableCache();
+        // First call compiles, the next ones run the cached program
+        double cached[3];
+        for (double& value : cached) {
+            value = ValueEvaluator::evaluate(entry.first, entry.second);
+        }
+        double numeric = ValueEvaluator::evaluateAs<double>(entry.first, entry.second);
+        bool same = cached[0] == expected && cached[1] == expected && cached[2] == expected && numeric == expected;
+        failures += same ? 0 : 1;
+        std::cout << std::left << std::setw(20) << entry.first << expected << " | cached " << cached[0] << ", "
+                  << cached[1] << ", " << cached[2] << " | evaluateAs " << numeric << (same ? "" : "  MISMATCH") << std::endl;
+    }
+    ValueEvaluator::disableCache();
+    
+    std::cout << (failures == 0 ? "Cache agrees with the parser" : "FAILURES: " + std::to_string(failures)) << std::endl;
+}
+
+void testConditionals() {
+    std::cout << "\n=== Conditional Rules (nanoseconds per rule) ===" << std::endl;
+    
+    PostfixReader reader;
+    reader.setVariable("x", 0.3);
+    reader.setVariable("y", 2.0);
+    std::string condition = "x 0.5 >";
+    std::string high = "x sin x cos * y sqrt + x y hypot /";
+    std::string low = "y exp x log - x y atan2 * 3 /";
+    
+    // Before: condition and both branches evaluated as separate programs
+    std::vector<CompactToken> conditionProgram = reader.compile(condition);
+    std::vector<CompactToken> highProgram = reader.compile(high);
+    std::vector<CompactToken> lowProgram = reader.compile(low);
+    std::vector<CompactToken> rule = reader.compile(condition + " " + high + " " + low + " ?");
+    
+    const int repetitions = 1000000;
+    double separate = measureMicroseconds([&] {
+        reader.evaluateCompiled(conditionProgram);
+        reader.evaluateCompiled(highProgram);
+        reader.evaluateCompiled(lowProgram);
+    }, repetitions) * 1000.0;
+    double jumping = measureMicroseconds([&] { reader.evaluateCompiled(rule); }, repetitions) * 1000.0;
+    
+    std::cout << "Condition and both branches: " << separate << std::endl;
+    std::cout << "One program with jumps:      " << jumping << std::endl;
+}
+
+int main() {
+    std::cout << "=== Expression Benchmarks ===" << std::endl;
+    
+    testRecursiveVsIterative();
+    testVeryDeepExpressions();
+    testLargeConversions();
+    testCompactTokens();
+    testArrayStackEvaluators();
+    testNumericTypes();
+    testGradients();
+    testRangePruning();
+    testFormulaDag();
+    testErrorHandling();
+    testProgramFile();
+    testFunctionCalls();
+    testNaryFunctionsAcrossEngines();
+    testValueCache();
+    testConditionals();
+    
+    std::cout << "\n=== Tracked Allocations ===" << std::endl;
+    AllocationTracker::report(std::cout);
+    
+    return 0;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <ostream>
+
+// Opt-in allocation accounting for the containers and evaluators.
+//
+// Build with -DTRACK_ALLOCATIONS to count, per kind of allocation ("NodePool
+// slab", "Arena block", ...), how many blocks were allocated and released, the
+// bytes allocated and the high-water mark of live bytes. Without it every
+// TRACK_* hook expands to nothing and AllocationTracker only reports that
+// tracking is off, so the hooks cost nothing in normal builds.
+//
+//   TRACK_ALLOCATION(name, pointer, bytes)     after a new; null pointers are ignored
+//   TRACK_DEALLOCATION(name, pointer, bytes)   before the matching delete
+//   TRACK_GROWTH(name, bytes)                  a standard container reallocated; its
+//                                              release is not followed, so it adds to
+//                                              the counts and bytes but not to live bytes,
+//                                              and the report shows "-" for the frees and
+//                                              peak bytes of its kind
+//   TRACK_PUSH_BACK(name, vector, value)       vector.push_back(value), reporting growth
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <mutex>
+#include <list>
+#include <cstring>
+#include <cstddef>
+#include <iomanip>
+
+// Counters for one kind of allocation; updated with relaxed atomics so
+// containers on several threads can share them
+struct AllocationStats {
+    const char* name;
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> deallocations{0};
+    std::atomic<size_t> bytes{0};           // Allocated in total
+    std::atomic<size_t> liveBytes{0};
+    std::atomic<size_t> peakBytes{0};       // High-water mark of liveBytes
+    std::atomic<size_t> growths{0};         // Allocations whose release is not followed
+
+    explicit AllocationStats(const char* name) : name(name) {}
+
+    void allocated(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        size_t live = liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+    }
+
+    void released(size_t size) {
+        deallocations.fetch_add(1, std::memory_order_relaxed);
+        liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    void grew(size_t size) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        growths.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+};
+
+class AllocationTracker {
+public:
+    static constexpr bool enabled = true;
+
+    // Counters for name, created on first use; the reference stays valid for
+    // the life of the program, so hooks look it up once per call site
+    static AllocationStats& stats(const char* name) {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (AllocationStats& entry : registry()) {
+            if (std::strcmp(entry.name, name) == 0) {
+                return entry;
+            }
+        }
+        registry().emplace_back(name);
+        return registry().back();
+    }
+
+    // One line per kind that allocated since the last reset. Kinds with
+    // growth allocations print "-" for frees and peak bytes: releases were
+    // not followed, so zeros there would read as leaks
+    static void report(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex());
+        out << std::left << std::setw(28) << "allocation" << std::right
+            << std::setw(12) << "allocs"
+            << std::setw(12) << "frees"
+            << std::setw(14) << "bytes"
+            << std::setw(14) << "peak bytes" << std::endl;
+        for (const AllocationStats& entry : registry()) {
+            if (entry.allocations.load(std::memory_order_relaxed) == 0) {
+                continue;
+            }
+            bool followed = entry.growths.load(std::memory_order_relaxed) == 0;
+            out << std::left << std::setw(28) << entry.name << std::right
+                << std::setw(12) << entry.allocations.load(std::memory_order_relaxed);
+            if (followed) {
+                out << std::setw(12) << entry.deallocations.load(std::memory_order_relaxed)
+                    << std::setw(14) << entry.bytes.load(std::memory_order_relaxed)
+                    << std::setw(14) << entry.peakBytes.load(std::memory_order_relaxed) << std::endl;
+            } else {
+                out << std::setw(12) << "-"
+                    << std::setw(14) << entry.bytes.load(std::memory_order_relaxed)
+                    << std::setw(14) << "-" << std::endl;
+            }
+        }
+    }
+
+    // Zero the counts; live bytes stay, and the peaks restart from them
+    static void reset() {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (AllocationStats& entry : registry()) {
+            entry.allocations.store(0, std::memory_order_relaxed);
+            entry.deallocations.store(0, std::memory_order_relaxed);
+            entry.bytes.store(0, std::memory_order_relaxed);
+            entry.growths.store(0, std::memory_order_relaxed);
+            entry.peakBytes.store(entry.liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static std::mutex& mutex() {
+        static std::mutex instance;
+        return instance;
+    }
+
+    // A list, so entries never move once handed out
+    static std::list<AllocationStats>& registry() {
+        static std::list<AllocationStats> instance;
+        return instance;
+    }
+};
+
+#define TRACK_ALLOCATION(name, pointer, size)                                          \
+    do {                                                                               \
+        if ((pointer) != nullptr) {                                                    \
+            static AllocationStats& trackedStats = AllocationTracker::stats(name);      \
+            trackedStats.allocated(size);                                              \
+        }                                                                              \
+    } while (false)
+
+#define TRACK_DEALLOCATION(name, pointer, size)                                        \
+    do {                                                                               \
+        if ((pointer) != nullptr) {                                                    \
+            static AllocationStats& trackedStats = AllocationTracker::stats(name);      \
+            trackedStats.released(size);                                               \
+        }                                                                              \
+    } while (false)
+
+#define TRACK_GROWTH(name, size)                                                       \
+    do {                                                                               \
+        static AllocationStats& trackedStats = AllocationTracker::stats(name);          \
+        trackedStats.grew(size);                                                       \
+    } while (false)
+
+#define TRACK_PUSH_BACK(name, vector, value)                                           \
+    do {                                                                               \
+        size_t trackedCapacity = (vector).capacity();                                  \
+        (vector).push_back(value);                                                     \
+        if ((vector).capacity() != trackedCapacity) {                                  \
+            TRACK_GROWTH(name, (vector).capacity() * sizeof((vector)[0]));             \
+        }                                                                              \
+    } while (false)
+
+#else
+
+class AllocationTracker {
+public:
+    static constexpr bool enabled = false;
+
+    static void report(std::ostream& out) {
+        out << "Allocation tracking is off (build with -DTRACK_ALLOCATIONS)" << std::endl;
+    }
+
+    static void reset() {}
+};
+
+#define TRACK_ALLOCATION(name, pointer, size) ((void)0)
+#define TRACK_DEALLOCATION(name, pointer, size) ((void)0)
+#define TRACK_GROWTH(name, size) ((void)0)
+#define TRACK_PUSH_BACK(name, vector, value) (vector).push_back(value)
+
+#endif
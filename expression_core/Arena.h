@@ -0,0 +1,133 @@
+#pragma once
+#include <string_view>
+#include <unordered_set>
+#include <type_traits>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "AllocationTracker.h"
+
+// Bump allocator: objects are carved out of large blocks and released all at once
+// when the arena is reset or destroyed. Destructors are never run, so only
+// trivially destructible types may be created in it.
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    Block* head;
+    char* cursor;
+    char* limit;
+    size_t blockSize;
+    size_t bytesUsed;
+    size_t blockCount;
+
+    void addBlock(size_t minimumSize) {
+        size_t size = minimumSize > blockSize ? minimumSize : blockSize;
+        Block* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+        TRACK_ALLOCATION("Arena block", block, sizeof(Block) + size);
+        block->next = head;
+        block->size = size;
+        head = block;
+        cursor = reinterpret_cast<char*>(block + 1);
+        limit = cursor + size;
+        ++blockCount;
+    }
+
+    void releaseBlocks() {
+        while (head != nullptr) {
+            Block* next = head->next;
+            TRACK_DEALLOCATION("Arena block", head, sizeof(Block) + head->size);
+            ::operator delete(head);
+            head = next;
+        }
+        cursor = nullptr;
+        limit = nullptr;
+        bytesUsed = 0;
+        blockCount = 0;
+    }
+
+public:
+    explicit Arena(size_t blockSize = 64 * 1024)
+        : head(nullptr), cursor(nullptr), limit(nullptr), blockSize(blockSize), bytesUsed(0), blockCount(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        releaseBlocks();
+    }
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(cursor);
+        uintptr_t aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+        if (cursor == nullptr || aligned + size > reinterpret_cast<uintptr_t>(limit)) {
+            addBlock(size + alignment);
+            address = reinterpret_cast<uintptr_t>(cursor);
+            aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        }
+
+        cursor = reinterpret_cast<char*>(aligned + size);
+        bytesUsed += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copy text into the arena; the view stays valid for the arena's lifetime
+    std::string_view copyString(std::string_view text) {
+        if (text.empty()) {
+            return std::string_view();
+        }
+        char* memory = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(memory, text.data(), text.size());
+        return std::string_view(memory, text.size());
+    }
+
+    // Release everything allocated so far
+    void reset() {
+        releaseBlocks();
+    }
+
+    size_t getBytesUsed() const {
+        return bytesUsed;
+    }
+
+    size_t getBlockCount() const {
+        return blockCount;
+    }
+};
+
+// Deduplicates strings into an arena: equal text always maps to the same view,
+// so repeated operators and identifiers are stored once per arena.
+class StringInterner {
+public:
+    explicit StringInterner(Arena& arena) : arena(arena) {}
+
+    std::string_view intern(std::string_view text) {
+        auto it = strings.find(text);
+        if (it != strings.end()) {
+            return *it;
+        }
+        std::string_view stored = arena.copyString(text);
+        strings.insert(stored);
+        return stored;
+    }
+
+    size_t size() const {
+        return strings.size();
+    }
+
+private:
+    Arena& arena;
+    std::unordered_set<std::string_view> strings;
+};
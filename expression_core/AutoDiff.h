@@ -0,0 +1,433 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "ExpressionLexer.h"
+#include "CompactToken.h"
+#include "Numeric.h"
+
+// Automatic differentiation for the expression engines.
+//   Forward mode: Dual, a number type for evaluateNumeric<Dual> that carries one
+//   directional derivative alongside the value.
+//   Reverse mode: GradientProgram, compiled once from postfix/prefix text; each
+//   evaluate() gives the value and the full gradient in one forward and one
+//   backward sweep, whatever the number of variables.
+
+// Builtin functions of one argument both modes can differentiate (NEG is
+// ExpressionLexer::UNARY_MINUS)
+enum class UnaryFunction : uint8_t {
+    NEG, SIN, COS, TAN, LOG, LOG10, SQRT, ABS, FLOOR, CEIL, EXP, ASIN, ACOS, ATAN, NONE
+};
+
+inline UnaryFunction unaryFunctionByName(std::string_view name) {
+    if (name == ExpressionLexer::UNARY_MINUS) return UnaryFunction::NEG;
+    if (name == "sin") return UnaryFunction::SIN;
+    if (name == "cos") return UnaryFunction::COS;
+    if (name == "tan") return UnaryFunction::TAN;
+    if (name == "log" || name == "ln") return UnaryFunction::LOG;
+    if (name == "log10") return UnaryFunction::LOG10;
+    if (name == "sqrt") return UnaryFunction::SQRT;
+    if (name == "abs") return UnaryFunction::ABS;
+    if (name == "floor") return UnaryFunction::FLOOR;
+    if (name == "ceil") return UnaryFunction::CEIL;
+    if (name == "exp") return UnaryFunction::EXP;
+    if (name == "asin") return UnaryFunction::ASIN;
+    if (name == "acos") return UnaryFunction::ACOS;
+    if (name == "atan") return UnaryFunction::ATAN;
+    return UnaryFunction::NONE;
+}
+
+inline double applyUnaryFunction(UnaryFunction function, double x) {
+    switch (function) {
+        case UnaryFunction::NEG: return -x;
+        case UnaryFunction::SIN: return std::sin(x);
+        case UnaryFunction::COS: return std::cos(x);
+        case UnaryFunction::TAN: return std::tan(x);
+        case UnaryFunction::LOG: return std::log(x);
+        case UnaryFunction::LOG10: return std::log10(x);
+        case UnaryFunction::SQRT: return std::sqrt(x);
+        case UnaryFunction::ABS: return std::abs(x);
+        case UnaryFunction::FLOOR: return std::floor(x);
+        case UnaryFunction::CEIL: return std::ceil(x);
+        case UnaryFunction::EXP: return std::exp(x);
+        case UnaryFunction::ASIN: return std::asin(x);
+        case UnaryFunction::ACOS: return std::acos(x);
+        case UnaryFunction::ATAN: return std::atan(x);
+        default: throw std::invalid_argument("Unknown function");
+    }
+}
+
+// d f(x) / dx, given x and the already computed f(x)
+inline double unaryDerivative(UnaryFunction function, double x, double fx) {
+    switch (function) {
+        case UnaryFunction::NEG: return -1.0;
+        case UnaryFunction::SIN: return std::cos(x);
+        case UnaryFunction::COS: return -std::sin(x);
+        case UnaryFunction::TAN: return 1.0 + fx * fx;
+        case UnaryFunction::LOG: return 1.0 / x;
+        case UnaryFunction::LOG10: return 1.0 / (x * std::log(10.0));
+        case UnaryFunction::SQRT: return 0.5 / fx;
+        case UnaryFunction::ABS: return x > 0 ? 1.0 : (x < 0 ? -1.0 : 0.0);
+        case UnaryFunction::FLOOR:
+        case UnaryFunction::CEIL: return 0.0;
+        case UnaryFunction::EXP: return fx;
+        case UnaryFunction::ASIN: return 1.0 / std::sqrt(1.0 - x * x);
+        case UnaryFunction::ACOS: return -1.0 / std::sqrt(1.0 - x * x);
+        case UnaryFunction::ATAN: return 1.0 / (1.0 + x * x);
+        default: throw std::invalid_argument("Unknown function");
+    }
+}
+
+// Builtins of two arguments both modes can differentiate; clamp(x, low, high)
+// is differentiated as min(max(x, low), high)
+enum class BinaryFunction : uint8_t {
+    MIN, MAX, ATAN2, HYPOT, NONE
+};
+
+inline BinaryFunction binaryFunctionByName(std::string_view name) {
+    if (name == "min") return BinaryFunction::MIN;
+    if (name == "max") return BinaryFunction::MAX;
+    if (name == "atan2") return BinaryFunction::ATAN2;
+    if (name == "hypot") return BinaryFunction::HYPOT;
+    return BinaryFunction::NONE;
+}
+
+inline double applyBinaryFunction(BinaryFunction function, double l, double r) {
+    switch (function) {
+        case BinaryFunction::MIN: return std::min(l, r);
+        case BinaryFunction::MAX: return std::max(l, r);
+        case BinaryFunction::ATAN2: return std::atan2(l, r);
+        case BinaryFunction::HYPOT: return std::hypot(l, r);
+        default: throw std::invalid_argument("Unknown function");
+    }
+}
+
+// Partial derivatives of f(l, r), given f(l, r). Where min or max has a kink
+// (l == r) the subgradient of the operand it returns (l) is used; atan2 and
+// hypot get 0 at the origin.
+inline void binaryFunctionPartials(BinaryFunction function, double l, double r, double value, double& dl, double& dr) {
+    switch (function) {
+        case BinaryFunction::MIN: dl = r < l ? 0.0 : 1.0; dr = 1.0 - dl; break;
+        case BinaryFunction::MAX: dl = l < r ? 0.0 : 1.0; dr = 1.0 - dl; break;
+        case BinaryFunction::ATAN2: {
+            double squared = l * l + r * r;
+            dl = squared == 0 ? 0.0 : r / squared;
+            dr = squared == 0 ? 0.0 : -l / squared;
+            break;
+        }
+        case BinaryFunction::HYPOT:
+            dl = value == 0 ? 0.0 : l / value;
+            dr = value == 0 ? 0.0 : r / value;
+            break;
+        default: throw std::invalid_argument("Unknown function");
+    }
+}
+
+// Partial derivatives of l op r with respect to l and r
+inline void binaryPartials(OpCode op, double l, double r, double value, double& dl, double& dr) {
+    switch (op) {
+        case OpCode::ADD: dl = 1.0; dr = 1.0; break;
+        case OpCode::SUBTRACT: dl = 1.0; dr = -1.0; break;
+        case OpCode::MULTIPLY: dl = r; dr = l; break;
+        case OpCode::DIVIDE: dl = 1.0 / r; dr = -l / (r * r); break;
+        case OpCode::POWER:
+            dl = r == 0 ? 0.0 : r * std::pow(l, r - 1);
+            dr = l > 0 ? value * std::log(l) : 0.0; // Only defined for a positive base
+            break;
+        case OpCode::MODULO: dl = 1.0; dr = -std::trunc(l / r); break;
+        default: throw std::invalid_argument("Not a binary operator");
+    }
+}
+
+// Forward-mode dual number: value + derivative * epsilon, epsilon^2 = 0.
+// Seed a variable's derivative with 1 to get d(expression)/d(variable).
+struct Dual {
+    double value;
+    double derivative;
+
+    Dual(double value = 0.0, double derivative = 0.0) : value(value), derivative(derivative) {}
+
+    Dual operator-() const { return Dual(-value, -derivative); }
+
+    friend Dual operator+(const Dual& a, const Dual& b) { return Dual(a.value + b.value, a.derivative + b.derivative); }
+    friend Dual operator-(const Dual& a, const Dual& b) { return Dual(a.value - b.value, a.derivative - b.derivative); }
+    friend Dual operator*(const Dual& a, const Dual& b) {
+        return Dual(a.value * b.value, a.derivative * b.value + a.value * b.derivative);
+    }
+    friend Dual operator/(const Dual& a, const Dual& b) {
+        return Dual(a.value / b.value, (a.derivative * b.value - a.value * b.derivative) / (b.value * b.value));
+    }
+};
+
+// Applies a binary operator to duals through the shared partials table
+inline Dual applyDualOperator(OpCode op, const Dual& a, const Dual& b, double value) {
+    double dl = 0.0;
+    double dr = 0.0;
+    binaryPartials(op, a.value, b.value, value, dl, dr);
+    return Dual(value, dl * a.derivative + dr * b.derivative);
+}
+
+template<>
+struct NumericTraits<Dual> {
+    static Dual parse(std::string_view text) {
+        return Dual(NumericTraits<double>::parse(text));
+    }
+
+    static Dual divide(const Dual& a, const Dual& b) {
+        if (b.value == 0) throw std::runtime_error("Division by zero");
+        return a / b;
+    }
+
+    static Dual modulo(const Dual& a, const Dual& b) {
+        if (b.value == 0) throw std::runtime_error("Modulo by zero");
+        return applyDualOperator(OpCode::MODULO, a, b, std::fmod(a.value, b.value));
+    }
+
+    static Dual power(const Dual& a, const Dual& b) {
+        return applyDualOperator(OpCode::POWER, a, b, std::pow(a.value, b.value));
+    }
+
+    static bool applyFunction(std::string_view name, const Dual& x, Dual& result) {
+        UnaryFunction function = unaryFunctionByName(name);
+        if (function == UnaryFunction::NONE) {
+            return false;
+        }
+        double value = applyUnaryFunction(function, x.value);
+        result = Dual(value, unaryDerivative(function, x.value, value) * x.derivative);
+        return true;
+    }
+
+    static bool applyNaryFunction(std::string_view name, const Dual* x, Dual& result) {
+        if (name == "clamp") {
+            Dual raised[2];
+            applyNaryFunction("max", x, raised[0]);
+            raised[1] = x[2];
+            return applyNaryFunction("min", raised, result);
+        }
+        BinaryFunction function = binaryFunctionByName(name);
+        if (function == BinaryFunction::NONE) {
+            return false;
+        }
+        double value = applyBinaryFunction(function, x[0].value, x[1].value);
+        double dl = 0.0;
+        double dr = 0.0;
+        binaryFunctionPartials(function, x[0].value, x[1].value, value, dl, dr);
+        result = Dual(value, dl * x[0].derivative + dr * x[1].derivative);
+        return true;
+    }
+
+    static std::string toString(const Dual& x) {
+        return NumericTraits<double>::toString(x.value) + " + " + NumericTraits<double>::toString(x.derivative) + "e";
+    }
+};
+
+// Reverse-mode gradient of one expression over a fixed list of variables.
+// Compilation resolves every token to a straight-line instruction list; each
+// instruction writes one slot and reads only earlier slots, so the backward
+// sweep is a reverse walk over the same list.
+class GradientProgram {
+private:
+    enum class Kind : uint8_t { CONSTANT, VARIABLE, BINARY, UNARY, BINARY_FUNCTION };
+
+    struct Instruction {
+        Kind kind;
+        OpCode op;                 // BINARY
+        UnaryFunction function;    // UNARY
+        BinaryFunction pair;       // BINARY_FUNCTION
+        uint32_t left;             // Operand slot, or variable index for VARIABLE
+        uint32_t right;
+        double constant;
+    };
+
+    std::vector<Instruction> code;
+    std::vector<std::string> variableNames;
+    std::vector<double> values;    // Forward sweep results, one per instruction
+    std::vector<double> adjoints;  // Backward sweep, d(result)/d(slot)
+
+    double forward(const std::vector<double>& point) {
+        if (point.size() != variableNames.size()) {
+            throw std::invalid_argument("Expected " + std::to_string(variableNames.size()) + " variable values");
+        }
+
+        for (size_t i = 0; i < code.size(); ++i) {
+            const Instruction& instruction = code[i];
+            switch (instruction.kind) {
+                case Kind::CONSTANT:
+                    values[i] = instruction.constant;
+                    break;
+                case Kind::VARIABLE:
+                    values[i] = point[instruction.left];
+                    break;
+                case Kind::BINARY:
+                    values[i] = applyOpCode(instruction.op, values[instruction.left], values[instruction.right]);
+                    break;
+                case Kind::UNARY:
+                    values[i] = applyUnaryFunction(instruction.function, values[instruction.left]);
+                    break;
+                case Kind::BINARY_FUNCTION:
+                    values[i] = applyBinaryFunction(instruction.pair, values[instruction.left], values[instruction.right]);
+                    break;
+            }
+        }
+
+        return values.back();
+    }
+
+public:
+    // Compile postfix (or prefix) text. Identifiers listed in variables become
+    // inputs, numbered in that order; other identifiers must be builtins.
+    GradientProgram(std::string_view expression, const std::vector<std::string>& variables, bool prefixOrder = false)
+        : variableNames(variables) {
+        std::unordered_map<std::string, uint32_t> variableIndex;
+        for (size_t i = 0; i < variables.size(); ++i) {
+            variableIndex.emplace(variables[i], static_cast<uint32_t>(i));
+        }
+
+        std::vector<std::string_view> tokens;
+        ExpressionLexer::forEachToken(expression, [&](std::string_view token) {
+            tokens.push_back(token);
+        });
+
+        std::vector<uint32_t> slots; // Operand stack of instruction indices
+        code.reserve(tokens.size());
+
+        for (size_t step = 0; step < tokens.size(); ++step) {
+            std::string_view token = prefixOrder ? tokens[tokens.size() - 1 - step] : tokens[step];
+            uint32_t next = static_cast<uint32_t>(code.size());
+
+            double number = 0.0;
+            if (ExpressionLexer::isNumber(token) && ExpressionLexer::parseNumber(token, number)) {
+                code.push_back(Instruction{Kind::CONSTANT, OpCode::INVALID, UnaryFunction::NONE, BinaryFunction::NONE, 0, 0, number});
+                slots.push_back(next);
+                continue;
+            }
+
+            OpCode op = binaryOpCode(token);
+            if (op != OpCode::INVALID) {
+                if (slots.size() < 2) {
+                    throw std::invalid_argument("Insufficient operands for operator: " + std::string(token));
+                }
+                uint32_t top = slots.back();
+                slots.pop_back();
+                uint32_t below = slots.back();
+                slots.back() = next;
+                code.push_back(Instruction{Kind::BINARY, op, UnaryFunction::NONE, BinaryFunction::NONE,
+                                           prefixOrder ? top : below, prefixOrder ? below : top, 0.0});
+                continue;
+            }
+
+            auto it = variableIndex.find(std::string(token));
+            if (it != variableIndex.end()) {
+                code.push_back(Instruction{Kind::VARIABLE, OpCode::INVALID, UnaryFunction::NONE, BinaryFunction::NONE, it->second, 0, 0.0});
+                slots.push_back(next);
+                continue;
+            }
+
+            size_t arity = naryBuiltinArity(token);
+            if (arity != 0) {
+                if (slots.size() < arity) {
+                    throw std::invalid_argument("Insufficient operands for function: " + std::string(token));
+                }
+                // First argument on top for prefix, deepest for postfix
+                uint32_t arguments[3];
+                for (size_t k = 0; k < arity; ++k) {
+                    arguments[prefixOrder ? k : arity - 1 - k] = slots.back();
+                    slots.pop_back();
+                }
+                if (token == "clamp") {
+                    code.push_back(Instruction{Kind::BINARY_FUNCTION, OpCode::INVALID, UnaryFunction::NONE,
+                                               BinaryFunction::MAX, arguments[0], arguments[1], 0.0});
+                    code.push_back(Instruction{Kind::BINARY_FUNCTION, OpCode::INVALID, UnaryFunction::NONE,
+                                               BinaryFunction::MIN, next, arguments[2], 0.0});
+                    slots.push_back(next + 1);
+                } else {
+                    code.push_back(Instruction{Kind::BINARY_FUNCTION, OpCode::INVALID, UnaryFunction::NONE,
+                                               binaryFunctionByName(token), arguments[0], arguments[1], 0.0});
+                    slots.push_back(next);
+                }
+                continue;
+            }
+
+            UnaryFunction function = unaryFunctionByName(token);
+            if (function == UnaryFunction::NONE) {
+                throw std::invalid_argument("Unknown token: " + std::string(token));
+            }
+            if (slots.empty()) {
+                throw std::invalid_argument("Insufficient operands for function: " + std::string(token));
+            }
+            code.push_back(Instruction{Kind::UNARY, OpCode::INVALID, function, BinaryFunction::NONE, slots.back(), 0, 0.0});
+            slots.back() = next;
+        }
+
+        if (slots.size() != 1) {
+            throw std::invalid_argument(prefixOrder ? "Invalid prefix expression" : "Invalid postfix expression");
+        }
+
+        values.resize(code.size());
+        adjoints.resize(code.size());
+    }
+
+    // Value at point (one entry per variable, in compile order)
+    double evaluate(const std::vector<double>& point) {
+        return forward(point);
+    }
+
+    // Value at point; gradient[i] receives d(result)/d(variables[i])
+    double evaluate(const std::vector<double>& point, std::vector<double>& gradient) {
+        double result = forward(point);
+
+        std::fill(adjoints.begin(), adjoints.end(), 0.0);
+        adjoints.back() = 1.0;
+        gradient.assign(variableNames.size(), 0.0);
+
+        for (size_t i = code.size(); i-- > 0;) {
+            const Instruction& instruction = code[i];
+            double adjoint = adjoints[i];
+            if (adjoint == 0.0) {
+                continue;
+            }
+
+            switch (instruction.kind) {
+                case Kind::CONSTANT:
+                    break;
+                case Kind::VARIABLE:
+                    gradient[instruction.left] += adjoint;
+                    break;
+                case Kind::BINARY: {
+                    double dl = 0.0;
+                    double dr = 0.0;
+                    binaryPartials(instruction.op, values[instruction.left], values[instruction.right], values[i], dl, dr);
+                    adjoints[instruction.left] += adjoint * dl;
+                    adjoints[instruction.right] += adjoint * dr;
+                    break;
+                }
+                case Kind::UNARY:
+                    adjoints[instruction.left] += adjoint * unaryDerivative(instruction.function, values[instruction.left], values[i]);
+                    break;
+                case Kind::BINARY_FUNCTION: {
+                    double dl = 0.0;
+                    double dr = 0.0;
+                    binaryFunctionPartials(instruction.pair, values[instruction.left], values[instruction.right], values[i], dl, dr);
+                    adjoints[instruction.left] += adjoint * dl;
+                    adjoints[instruction.right] += adjoint * dr;
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    const std::vector<std::string>& getVariableNames() const {
+        return variableNames;
+    }
+
+    size_t size() const {
+        return code.size();
+    }
+};
@@ -0,0 +1,1132 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
+#include <cmath>
+#include <cstdint>
+#include "ExpressionLexer.h"
+#include "SmallStack.h"
+#include "AllocationTracker.h"
+#include "EvalResult.h"
+
+// What a compact token does when evaluated
+enum class OpCode : uint8_t {
+    NUMBER,
+    VARIABLE,
+    FUNCTION,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    POWER,
+    MODULO,
+    CALL,       // Function of any arity registered as a pointer; arity in the token
+    LESS,       // Comparisons give 1.0 or 0.0
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    EQUAL,
+    NOT_EQUAL,
+    AND,        // Source forms of &&, || and ? (condition, then, else);
+    OR,         // lowerConditionals replaces them with the jumps below
+    SELECT,
+    JUMP,           // Skip the next `symbol` tokens
+    JUMP_IF_FALSE,  // Pop; skip the next `symbol` tokens if it was 0
+    AND_JUMP,       // 0 on top: leave 0 and skip `symbol` tokens; otherwise pop
+    OR_JUMP,        // Nonzero on top: replace with 1 and skip `symbol` tokens; otherwise pop
+    INVALID
+};
+
+// Evaluation form of a token: two machine words, no strings.
+// NUMBER carries its value, VARIABLE/FUNCTION/CALL the id of their name in a
+// SymbolTable; CALL also its argument count, jumps their distance in symbol.
+struct CompactToken {
+    double number;
+    uint32_t symbol;
+    OpCode op;
+    uint8_t arity;
+
+    CompactToken() : number(0.0), symbol(0), op(OpCode::INVALID), arity(0) {}
+    explicit CompactToken(OpCode op, double number = 0.0, uint32_t symbol = 0, uint8_t arity = 0)
+        : number(number), symbol(symbol), op(op), arity(arity) {}
+};
+
+static_assert(sizeof(CompactToken) == 16, "CompactToken should stay 16 bytes");
+
+// Binary operator spelled by text, or INVALID
+inline OpCode binaryOpCode(std::string_view text) {
+    if (text == "+") return OpCode::ADD;
+    if (text == "-") return OpCode::SUBTRACT;
+    if (text == "*") return OpCode::MULTIPLY;
+    if (text == "/" || text == "div") return OpCode::DIVIDE;
+    if (text == "^" || text == "pow") return OpCode::POWER;
+    if (text == "%" || text == "mod") return OpCode::MODULO;
+    return OpCode::INVALID;
+}
+
+// Comparison or logical operator spelled by text ("?" is the 3-operand
+// conditional), or INVALID. Kept apart from binaryOpCode so evaluators that
+// only do arithmetic keep rejecting these tokens.
+inline OpCode logicOpCode(std::string_view text) {
+    if (text == "<") return OpCode::LESS;
+    if (text == "<=") return OpCode::LESS_EQUAL;
+    if (text == ">") return OpCode::GREATER;
+    if (text == ">=") return OpCode::GREATER_EQUAL;
+    if (text == "==") return OpCode::EQUAL;
+    if (text == "!=") return OpCode::NOT_EQUAL;
+    if (text == "&&") return OpCode::AND;
+    if (text == "||") return OpCode::OR;
+    if (text == "?") return OpCode::SELECT;
+    return OpCode::INVALID;
+}
+
+// Operands a token takes from the stack (jumps are not counted: they only
+// appear after lowerConditionals)
+inline size_t operandCount(const CompactToken& token) {
+    switch (token.op) {
+        case OpCode::NUMBER:
+        case OpCode::VARIABLE: return 0;
+        case OpCode::FUNCTION: return 1;
+        case OpCode::CALL: return token.arity;
+        case OpCode::SELECT: return 3;
+        default: return 2;
+    }
+}
+
+inline double applyOpCode(OpCode op, double left, double right) {
+    switch (op) {
+        case OpCode::ADD: return left + right;
+        case OpCode::SUBTRACT: return left - right;
+        case OpCode::MULTIPLY: return left * right;
+        case OpCode::DIVIDE:
+            if (right == 0) throw std::runtime_error("Division by zero");
+            return left / right;
+        case OpCode::POWER: return std::pow(left, right);
+        case OpCode::MODULO:
+            if (right == 0) throw std::runtime_error("Modulo by zero");
+            return std::fmod(left, right);
+        case OpCode::LESS: return left < right ? 1.0 : 0.0;
+        case OpCode::LESS_EQUAL: return left <= right ? 1.0 : 0.0;
+        case OpCode::GREATER: return left > right ? 1.0 : 0.0;
+        case OpCode::GREATER_EQUAL: return left >= right ? 1.0 : 0.0;
+        case OpCode::EQUAL: return left == right ? 1.0 : 0.0;
+        case OpCode::NOT_EQUAL: return left != right ? 1.0 : 0.0;
+        case OpCode::AND: return left != 0 && right != 0 ? 1.0 : 0.0;
+        case OpCode::OR: return left != 0 || right != 0 ? 1.0 : 0.0;
+        default:
+            throw std::runtime_error("Not a binary operator");
+    }
+}
+
+// Builtin-style function of one or more arguments, arguments[0] first.
+// A plain pointer, so calls are direct instead of going through std::function.
+using NaryFunction = double (*)(const double* arguments);
+
+const size_t MAX_FUNCTION_ARITY = 8;
+
+// Function written in the expression language, stored compiled in stack order
+// (see compileCompactProgram) and copied into every caller, so calling it costs
+// nothing beyond its body. parameterOf[i] is the parameter token i stands for, or -1.
+// lowered is body after lowerConditionals (with loweredParameterOf), for running
+// the function on its own (tryEvaluateInlineFunction) without inlining it.
+struct InlineFunction {
+    std::vector<CompactToken> body;
+    std::vector<int> parameterOf;
+    std::vector<CompactToken> lowered;
+    std::vector<int> loweredParameterOf;
+    size_t arity = 0;
+};
+
+// Maps variable and function names to dense ids, and keeps variable values and
+// functions in arrays indexed by id, so evaluation never hashes a name.
+// Copies share the name/id mapping (ids stay meaningful across copies, and
+// programs compiled by one copy run on another) but own their values and functions.
+// Looking a name up takes no lock and builds no string: the mapping is an
+// open-addressed index that only intern() of a new name writes to, under a mutex.
+class SymbolTable {
+private:
+    struct Entry {
+        std::string name;
+        uint32_t id;
+        size_t hash;
+    };
+
+    // Never more than half full; slots go from null to an entry exactly once
+    struct Index {
+        size_t mask;
+        std::vector<std::atomic<const Entry*>> slots;
+
+        explicit Index(size_t size) : mask(size - 1), slots(size) {}
+    };
+
+    struct Names {
+        std::mutex mutex;                               // Taken by intern() of a new name and getName()
+        std::deque<Entry> entries;                      // By id; addresses never change
+        std::vector<std::unique_ptr<Index>> indexes;    // Current one last; older ones stay for readers still probing them
+        std::atomic<const Index*> index;
+
+        Names() : index(nullptr) {
+            indexes.push_back(std::make_unique<Index>(16));
+            index.store(indexes.back().get(), std::memory_order_release);
+        }
+
+        static void place(Index& target, const Entry* entry) {
+            size_t slot = entry->hash & target.mask;
+            while (target.slots[slot].load(std::memory_order_relaxed) != nullptr) {
+                slot = (slot + 1) & target.mask;
+            }
+            target.slots[slot].store(entry, std::memory_order_release);
+        }
+
+        const Entry* lookup(std::string_view name, size_t hash) const {
+            const Index* current = index.load(std::memory_order_acquire);
+            for (size_t slot = hash & current->mask;; slot = (slot + 1) & current->mask) {
+                const Entry* entry = current->slots[slot].load(std::memory_order_acquire);
+                if (entry == nullptr) {
+                    return nullptr;
+                }
+                if (entry->hash == hash && entry->name == name) {
+                    return entry;
+                }
+            }
+        }
+
+        // Caller holds mutex and has checked that name is new
+        uint32_t add(std::string_view name, size_t hash) {
+            uint32_t id = static_cast<uint32_t>(entries.size());
+            entries.push_back(Entry{std::string(name), id, hash});
+
+            Index* current = indexes.back().get();
+            if (entries.size() * 2 > current->slots.size()) {
+                // Readers switch to the larger copy once it is complete
+                auto larger = std::make_unique<Index>(current->slots.size() * 2);
+                for (const Entry& entry : entries) {
+                    place(*larger, &entry);
+                }
+                indexes.push_back(std::move(larger));
+                index.store(indexes.back().get(), std::memory_order_release);
+            } else {
+                place(*current, &entries.back());
+            }
+            return id;
+        }
+    };
+
+    std::shared_ptr<Names> shared;
+    std::vector<double> values;
+    std::vector<unsigned char> defined;
+    std::vector<std::function<double(double)>> functions;
+    std::vector<NaryFunction> pointers;
+    std::vector<uint8_t> arities;
+    std::vector<std::shared_ptr<const InlineFunction>> inlineFunctions;
+
+    // Slots for id in every function array; a name holds one kind of function
+    void resetFunction(uint32_t id) {
+        if (id >= functions.size()) {
+            functions.resize(id + 1);
+            pointers.resize(id + 1, nullptr);
+            arities.resize(id + 1, 0);
+            inlineFunctions.resize(id + 1);
+        }
+        functions[id] = nullptr;
+        pointers[id] = nullptr;
+        arities[id] = 0;
+        inlineFunctions[id].reset();
+    }
+
+public:
+    SymbolTable() : shared(std::make_shared<Names>()) {}
+
+    // Id for name, assigning the next free one on first use
+    uint32_t intern(std::string_view name) {
+        size_t hash = std::hash<std::string_view>()(name);
+        if (const Entry* entry = shared->lookup(name, hash)) {
+            return entry->id;
+        }
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (const Entry* entry = shared->lookup(name, hash)) {
+            return entry->id;
+        }
+        return shared->add(name, hash);
+    }
+
+    bool find(std::string_view name, uint32_t& id) const {
+        const Entry* entry = shared->lookup(name, std::hash<std::string_view>()(name));
+        if (entry == nullptr) {
+            return false;
+        }
+        id = entry->id;
+        return true;
+    }
+
+    // For messages and listings; takes the mutex
+    std::string getName(uint32_t id) const {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        return id < shared->entries.size() ? shared->entries[id].name : std::string();
+    }
+
+    void setVariable(std::string_view name, double value) {
+        uint32_t id = intern(name);
+        if (id >= values.size()) {
+            values.resize(id + 1, 0.0);
+            defined.resize(id + 1, 0);
+        }
+        values[id] = value;
+        defined[id] = 1;
+    }
+
+    bool hasVariable(uint32_t id) const {
+        return id < defined.size() && defined[id] != 0;
+    }
+
+    // Value of a variable known to be defined
+    double getVariable(uint32_t id) const {
+        return values[id];
+    }
+
+    bool findVariable(std::string_view name, double& value) const {
+        uint32_t id = 0;
+        if (!find(name, id) || !hasVariable(id)) {
+            return false;
+        }
+        value = values[id];
+        return true;
+    }
+
+    void setFunction(std::string_view name, std::function<double(double)> func) {
+        uint32_t id = intern(name);
+        resetFunction(id);
+        functions[id] = std::move(func);
+        arities[id] = functions[id] ? 1 : 0;
+    }
+
+    void setFunction(std::string_view name, NaryFunction func, size_t arity) {
+        if (arity == 0 || arity > MAX_FUNCTION_ARITY) {
+            throw std::invalid_argument("Function arity must be between 1 and " + std::to_string(MAX_FUNCTION_ARITY));
+        }
+        uint32_t id = intern(name);
+        resetFunction(id);
+        pointers[id] = func;
+        arities[id] = func != nullptr ? static_cast<uint8_t>(arity) : 0;
+    }
+
+    void setInlineFunction(std::string_view name, std::shared_ptr<const InlineFunction> func) {
+        uint32_t id = intern(name);
+        resetFunction(id);
+        inlineFunctions[id] = std::move(func);
+    }
+
+    // Callable with one argument (std::function or a pointer of arity 1)
+    bool isFunction(uint32_t id) const {
+        return id < arities.size() && arities[id] == 1;
+    }
+
+    bool isFunction(std::string_view name) const {
+        uint32_t id = 0;
+        return find(name, id) && isFunction(id);
+    }
+
+    // Arguments taken by a function called through callFunction, 0 for anything else
+    size_t getArity(uint32_t id) const {
+        return id < arities.size() ? arities[id] : 0;
+    }
+
+    const InlineFunction* getInlineFunction(uint32_t id) const {
+        return id < inlineFunctions.size() ? inlineFunctions[id].get() : nullptr;
+    }
+
+    // Arguments taken by a function of any kind, including one from
+    // defineInlineFunction; 0 for anything else
+    size_t getCallArity(uint32_t id) const {
+        const InlineFunction* function = getInlineFunction(id);
+        return function != nullptr ? function->arity : getArity(id);
+    }
+
+    size_t getCallArity(std::string_view name) const {
+        uint32_t id = 0;
+        return find(name, id) ? getCallArity(id) : 0;
+    }
+
+    // Call a function known to be defined
+    double callFunction(uint32_t id, double argument) const {
+        return pointers[id] != nullptr ? pointers[id](&argument) : functions[id](argument);
+    }
+
+    // Call a function of getArity(id) arguments
+    double callFunction(uint32_t id, const double* arguments) const {
+        return pointers[id] != nullptr ? pointers[id](arguments) : functions[id](arguments[0]);
+    }
+};
+
+// First id of the names compileCompactProgramReadOnly finds no id for; no
+// table interns that many names, so symbols treats them as undefined
+const uint32_t UNKNOWN_SYMBOL = 0x80000000u;
+
+// Classify one lexed token; resolve(name) gives an identifier's id
+template<typename Resolve>
+CompactToken classifyCompactToken(std::string_view text, const SymbolTable& symbols, Resolve resolve) {
+    double value = 0.0;
+    if (ExpressionLexer::isNumber(text) && ExpressionLexer::parseNumber(text, value)) {
+        return CompactToken(OpCode::NUMBER, value);
+    }
+
+    OpCode op = binaryOpCode(text);
+    if (op == OpCode::INVALID) {
+        op = logicOpCode(text);
+    }
+    if (op != OpCode::INVALID) {
+        return CompactToken(op);
+    }
+
+    if (ExpressionLexer::isIdentifier(text)) {
+        uint32_t id = resolve(text);
+        size_t arity = symbols.getArity(id);
+        if (arity == 1) return CompactToken(OpCode::FUNCTION, 0.0, id);
+        if (arity > 1) return CompactToken(OpCode::CALL, 0.0, id, static_cast<uint8_t>(arity));
+        return CompactToken(OpCode::VARIABLE, 0.0, id);
+    }
+
+    return CompactToken();
+}
+
+// Classify one lexed token; identifiers are interned into symbols
+inline CompactToken makeCompactToken(std::string_view text, SymbolTable& symbols) {
+    return classifyCompactToken(text, symbols, [&](std::string_view name) { return symbols.intern(name); });
+}
+
+// Compile postfix (or prefix) text into program, in text order like the
+// readers' compile(); &&, || and ? keep their source form until
+// lowerConditionals. Calls of inline functions are replaced by the function's
+// body, with each parameter replaced by the tokens of its argument (so an
+// argument used twice in the body is computed twice). Programs without inline
+// calls take a single pass. When parameters is given (compiling a function
+// body), those names become parameter references, recorded in parameterOf.
+// classify(text) makes the token of everything else (see makeCompactToken).
+template<typename Classify>
+void compileCompactTokens(std::string_view expression, const SymbolTable& symbols, bool prefixOrder, Classify classify,
+                          std::vector<CompactToken>& program, const std::vector<std::string>* parameters,
+                          std::vector<int>* parameterOf) {
+    program.clear();
+    std::vector<int> noParameters;
+    std::vector<int>& marks = parameterOf != nullptr ? *parameterOf : noParameters;
+    marks.clear();
+
+    bool hasInlineCalls = false;
+    ExpressionLexer::forEachToken(expression, [&](std::string_view text) {
+        int parameter = -1;
+        for (size_t i = 0; parameters != nullptr && i < parameters->size(); ++i) {
+            if ((*parameters)[i] == text) parameter = static_cast<int>(i);
+        }
+        if (parameter >= 0) {
+            TRACK_PUSH_BACK("Compiled program", program, CompactToken(OpCode::VARIABLE));
+        } else {
+            TRACK_PUSH_BACK("Compiled program", program, classify(text));
+            hasInlineCalls = hasInlineCalls ||
+                             (program.back().op == OpCode::VARIABLE && symbols.getInlineFunction(program.back().symbol) != nullptr);
+        }
+        if (parameterOf != nullptr) marks.push_back(parameter);
+    });
+    if (!hasInlineCalls) {
+        return;
+    }
+    if (parameterOf == nullptr) {
+        marks.assign(program.size(), -1);
+    }
+
+    // Expand in stack order, tracking where each operand on the stack starts;
+    // past the first malformed token the rest is copied for evaluation to reject
+    std::vector<CompactToken> out;
+    std::vector<int> outMarks;
+    std::vector<size_t> starts;
+    out.reserve(program.size());
+    outMarks.reserve(program.size());
+    bool malformed = false;
+
+    for (size_t step = 0; step < program.size(); ++step) {
+        size_t i = prefixOrder ? program.size() - 1 - step : step;
+        const CompactToken& token = program[i];
+        const InlineFunction* function = nullptr;
+        if (marks[i] < 0 && token.op == OpCode::VARIABLE) {
+            function = symbols.getInlineFunction(token.symbol);
+        }
+
+        if (!malformed && function != nullptr) {
+            size_t arity = function->arity;
+            if (starts.size() < arity) {
+                malformed = true;
+                out.push_back(CompactToken());
+                outMarks.push_back(-1);
+                continue;
+            }
+
+            // Arguments in stack order, bottom of the stack first; argument k
+            // is arguments[bounds[k], bounds[k + 1])
+            size_t first = arity > 0 ? starts[starts.size() - arity] : out.size();
+            std::vector<CompactToken> arguments(out.begin() + first, out.end());
+            std::vector<int> argumentMarks(outMarks.begin() + first, outMarks.end());
+            std::vector<size_t> bounds;
+            for (size_t k = starts.size() - arity; k < starts.size(); ++k) {
+                bounds.push_back(starts[k] - first);
+            }
+            bounds.push_back(arguments.size());
+            out.resize(first);
+            outMarks.resize(first);
+
+            for (size_t b = 0; b < function->body.size(); ++b) {
+                int parameter = function->parameterOf[b];
+                if (parameter < 0) {
+                    out.push_back(function->body[b]);
+                    outMarks.push_back(-1);
+                    continue;
+                }
+                // Prefix order keeps the first argument on top of the stack
+                size_t k = prefixOrder ? arity - 1 - static_cast<size_t>(parameter) : static_cast<size_t>(parameter);
+                out.insert(out.end(), arguments.begin() + bounds[k], arguments.begin() + bounds[k + 1]);
+                outMarks.insert(outMarks.end(), argumentMarks.begin() + bounds[k], argumentMarks.begin() + bounds[k + 1]);
+            }
+            starts.resize(starts.size() - arity);
+            starts.push_back(first);
+            continue;
+        }
+
+        if (!malformed) {
+            size_t operands = operandCount(token);
+            if (token.op == OpCode::INVALID || starts.size() < operands || (token.op == OpCode::CALL && operands == 0)) {
+                malformed = true;
+            } else {
+                // An operator's result starts where its deepest operand did
+                size_t start = operands > 0 ? starts[starts.size() - operands] : out.size();
+                starts.resize(starts.size() - operands);
+                starts.push_back(start);
+            }
+        }
+        out.push_back(token);
+        outMarks.push_back(marks[i]);
+    }
+
+    if (prefixOrder) {
+        std::reverse(out.begin(), out.end());
+        std::reverse(outMarks.begin(), outMarks.end());
+    }
+    program.swap(out);
+    marks.swap(outMarks);
+}
+
+// Compile text with compileCompactTokens, interning its names into symbols
+inline void compileCompactProgram(std::string_view expression, SymbolTable& symbols, bool prefixOrder,
+                                  std::vector<CompactToken>& program,
+                                  const std::vector<std::string>* parameters = nullptr,
+                                  std::vector<int>* parameterOf = nullptr) {
+    compileCompactTokens(expression, symbols, prefixOrder, [&](std::string_view text) { return makeCompactToken(text, symbols); },
+                         program, parameters, parameterOf);
+}
+
+// Compile text for a single evaluation without adding names to symbols, so
+// evaluating arbitrary text never grows the shared name table. A name symbols
+// does not know becomes VARIABLE UNKNOWN_SYMBOL + k with its text in
+// unknownNames[k] (views into expression); evaluateCompactProgram reports it
+// as an undefined variable if it is reached.
+inline void compileCompactProgramReadOnly(std::string_view expression, const SymbolTable& symbols, bool prefixOrder,
+                                          std::vector<CompactToken>& program,
+                                          std::vector<std::string_view>& unknownNames) {
+    unknownNames.clear();
+    auto resolve = [&](std::string_view name) {
+        uint32_t id = 0;
+        if (symbols.find(name, id)) {
+            return id;
+        }
+        size_t k = static_cast<size_t>(std::find(unknownNames.begin(), unknownNames.end(), name) - unknownNames.begin());
+        if (k == unknownNames.size()) {
+            unknownNames.push_back(name);
+        }
+        return UNKNOWN_SYMBOL + static_cast<uint32_t>(k);
+    };
+    compileCompactTokens(expression, symbols, prefixOrder,
+                         [&](std::string_view text) { return classifyCompactToken(text, symbols, resolve); },
+                         program, nullptr, nullptr);
+}
+
+// Replace the source forms of &&, || and ? with jumps, so the operand that is
+// not needed is skipped instead of evaluated:
+//   a && b      ->  a AND_JUMP(n) b 0 !=        n = tokens in "b 0 !="
+//   a || b      ->  a OR_JUMP(n) b 0 !=
+//   c ? a : b   ->  c JUMP_IF_FALSE(n) a JUMP(m) b
+// Distances count tokens in stack order, so prefix programs (run back to
+// front) are rewritten back to front as well. marks, when given, runs parallel
+// to program and follows its tokens; inserted tokens are marked -1.
+inline void lowerConditionals(std::vector<CompactToken>& program, bool prefixOrder,
+                              std::vector<int>* marks = nullptr) {
+    bool hasConditionals = std::any_of(program.begin(), program.end(), [](const CompactToken& token) {
+        return token.op == OpCode::AND || token.op == OpCode::OR || token.op == OpCode::SELECT;
+    });
+    if (!hasConditionals) {
+        return;
+    }
+
+    std::vector<CompactToken> out;
+    std::vector<int> outMarks;
+    std::vector<size_t> starts;     // Where each operand on the stack starts in out
+    out.reserve(program.size() + program.size() / 2);
+    TRACK_GROWTH("Compiled program", out.capacity() * sizeof(CompactToken));
+    bool malformed = false;
+    auto emit = [&](const CompactToken& token, int mark) {
+        out.push_back(token);
+        if (marks != nullptr) outMarks.push_back(mark);
+    };
+
+    for (size_t step = 0; step < program.size(); ++step) {
+        size_t i = prefixOrder ? program.size() - 1 - step : step;
+        const CompactToken& token = program[i];
+        int mark = marks != nullptr ? (*marks)[i] : -1;
+        size_t operands = operandCount(token);
+        if (malformed || token.op == OpCode::INVALID || starts.size() < operands ||
+            (token.op == OpCode::CALL && operands == 0)) {
+            // Copied as is for evaluation to reject
+            malformed = true;
+            emit(token, mark);
+            continue;
+        }
+
+        size_t first = operands > 0 ? starts[starts.size() - operands] : out.size();
+        if (token.op == OpCode::AND || token.op == OpCode::OR || token.op == OpCode::SELECT) {
+            // Operand k (condition or left first) is pieces[bounds[k], bounds[k + 1]);
+            // prefix order keeps the first operand on top of the stack
+            std::vector<CompactToken> pieces(out.begin() + first, out.end());
+            std::vector<int> pieceMarks(outMarks.begin() + (marks != nullptr ? first : 0), outMarks.end());
+            std::vector<size_t> bounds;
+            for (size_t k = 0; k < operands; ++k) {
+                size_t slot = prefixOrder ? operands - 1 - k : k;
+                bounds.push_back(starts[starts.size() - operands + slot] - first);
+                bounds.push_back(slot + 1 < operands ? starts[starts.size() - operands + slot + 1] - first : pieces.size());
+            }
+            auto length = [&](size_t k) { return static_cast<uint32_t>(bounds[2 * k + 1] - bounds[2 * k]); };
+            auto append = [&](size_t k) {
+                out.insert(out.end(), pieces.begin() + bounds[2 * k], pieces.begin() + bounds[2 * k + 1]);
+                if (marks != nullptr) {
+                    outMarks.insert(outMarks.end(), pieceMarks.begin() + bounds[2 * k], pieceMarks.begin() + bounds[2 * k + 1]);
+                }
+            };
+
+            out.resize(first);
+            if (marks != nullptr) outMarks.resize(first);
+            append(0);
+            if (token.op == OpCode::SELECT) {
+                emit(CompactToken(OpCode::JUMP_IF_FALSE, 0.0, length(1) + 1), -1);
+                append(1);
+                emit(CompactToken(OpCode::JUMP, 0.0, length(2)), -1);
+                append(2);
+            } else {
+                emit(CompactToken(token.op == OpCode::AND ? OpCode::AND_JUMP : OpCode::OR_JUMP, 0.0, length(1) + 2), -1);
+                append(1);
+                emit(CompactToken(OpCode::NUMBER, 0.0), -1);
+                emit(CompactToken(OpCode::NOT_EQUAL), -1);
+            }
+        } else {
+            emit(token, mark);
+        }
+        starts.resize(starts.size() - operands);
+        starts.push_back(first);
+    }
+
+    if (prefixOrder) {
+        std::reverse(out.begin(), out.end());
+        std::reverse(outMarks.begin(), outMarks.end());
+    }
+    program.swap(out);
+    if (marks != nullptr) marks->swap(outMarks);
+}
+
+// Define name(parameters...) as body, postfix (or prefix) text over the
+// parameters, other variables, numbers and functions defined so far. Calls
+// compiled afterwards inline it; other names in body are variables read at
+// evaluation time. A malformed body throws std::invalid_argument.
+inline void defineInlineFunction(SymbolTable& symbols, std::string_view name, const std::vector<std::string>& parameters,
+                                 std::string_view body, bool prefixOrder) {
+    if (!ExpressionLexer::isIdentifier(name) || binaryOpCode(name) != OpCode::INVALID) {
+        throw std::invalid_argument("Invalid function name: " + std::string(name));
+    }
+    if (parameters.size() > MAX_FUNCTION_ARITY) {
+        throw std::invalid_argument("Too many parameters for function: " + std::string(name));
+    }
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (!ExpressionLexer::isIdentifier(parameters[i]) || binaryOpCode(parameters[i]) != OpCode::INVALID ||
+            std::find(parameters.begin(), parameters.begin() + i, parameters[i]) != parameters.begin() + i) {
+            throw std::invalid_argument("Invalid parameter '" + parameters[i] + "' for function: " + std::string(name));
+        }
+    }
+
+    auto function = std::make_shared<InlineFunction>();
+    function->arity = parameters.size();
+    compileCompactProgram(body, symbols, prefixOrder, function->body, &parameters, &function->parameterOf);
+    function->lowered = function->body;
+    function->loweredParameterOf = function->parameterOf;
+    lowerConditionals(function->lowered, prefixOrder, &function->loweredParameterOf);
+    if (prefixOrder) {
+        std::reverse(function->body.begin(), function->body.end());
+        std::reverse(function->parameterOf.begin(), function->parameterOf.end());
+        std::reverse(function->lowered.begin(), function->lowered.end());
+        std::reverse(function->loweredParameterOf.begin(), function->loweredParameterOf.end());
+    }
+
+    size_t depth = 0;
+    for (const CompactToken& token : function->body) {
+        size_t operands = operandCount(token);
+        if (token.op == OpCode::INVALID || depth < operands || (token.op == OpCode::CALL && operands == 0)) {
+            throw std::invalid_argument("Invalid body for function " + std::string(name) + ": " + std::string(body));
+        }
+        depth = depth - operands + 1;
+    }
+    if (depth != 1) {
+        throw std::invalid_argument("Invalid body for function " + std::string(name) + ": " + std::string(body));
+    }
+
+    symbols.setInlineFunction(name, std::move(function));
+}
+
+// Gather the arity arguments of a call from the top of a stack, first argument
+// in arguments[0]; prefix order keeps the first argument on top
+inline void popCallArguments(SmallStack<double>& operands, size_t arity, bool prefixOrder, double* arguments) {
+    for (size_t k = 0; k < arity; ++k) {
+        arguments[k] = operands.peek(prefixOrder ? k : arity - 1 - k);
+    }
+    operands.drop(arity);
+}
+
+// Run a jump of a lowered program (see lowerConditionals) on the stack; true
+// when it is taken. AND_JUMP and OR_JUMP leave the decided result when taken.
+inline bool takeJump(OpCode op, SmallStack<double>& operands) {
+    switch (op) {
+        case OpCode::JUMP:
+            return true;
+
+        case OpCode::JUMP_IF_FALSE:
+            return operands.pop() == 0;
+
+        case OpCode::AND_JUMP:
+            if (operands.peek(0) == 0) {
+                operands.peek(0) = 0.0;
+                return true;
+            }
+            operands.drop(1);
+            return false;
+
+        default:    // OR_JUMP
+            if (operands.peek(0) != 0) {
+                operands.peek(0) = 1.0;
+                return true;
+            }
+            operands.drop(1);
+            return false;
+    }
+}
+
+// A jump target in the pre-check of evaluateCompactProgram, kept as the
+// number of tokens left after it
+struct JumpTarget {
+    size_t remaining;
+    size_t depth;   // On arrival
+};
+
+// Evaluate a compact program visited in stack order: postfix front to back
+// (begin/end), prefix back to front (rbegin/rend). The operator's first operand
+// is on top of the stack for prefix order and below it for postfix order.
+// Malformed programs throw std::invalid_argument(invalidMessage) before anything
+// is evaluated; undefined variables and unknown functions throw std::runtime_error.
+// Programs whose ids belong to another numbering (such as a ProgramFile) pass
+// symbolMap, which translates each token's id into an id of symbols. Programs
+// from compileCompactProgramReadOnly pass its unknownNames for the messages.
+template<typename Iterator>
+double evaluateCompactProgram(Iterator begin, Iterator end, const SymbolTable& symbols,
+                              bool prefixOrder, const char* invalidMessage,
+                              const uint32_t* symbolMap = nullptr, size_t symbolMapSize = 0,
+                              const std::vector<std::string_view>* unknownNames = nullptr) {
+    size_t depth = 0;
+    SmallStack<JumpTarget, 16> jumpTargets;
+    for (Iterator it = begin; it != end; ++it) {
+        // Lowered conditionals nest, so the nearest target is always the latest;
+        // it must find the stack exactly as deep as its jump left it, and then
+        // no path through the program can underflow the stack
+        while (!jumpTargets.isEmpty() && jumpTargets.peek(0).remaining == static_cast<size_t>(end - it)) {
+            if (jumpTargets.peek(0).depth != depth) throw std::invalid_argument(invalidMessage);
+            jumpTargets.drop(1);
+        }
+        switch (it->op) {
+            case OpCode::NUMBER:
+                ++depth;
+                break;
+            case OpCode::VARIABLE:
+                if (symbolMap != nullptr && it->symbol >= symbolMapSize) throw std::invalid_argument(invalidMessage);
+                ++depth;
+                break;
+            case OpCode::FUNCTION:
+                if (symbolMap != nullptr && it->symbol >= symbolMapSize) throw std::invalid_argument(invalidMessage);
+                if (depth < 1) throw std::invalid_argument(invalidMessage);
+                break;
+            case OpCode::CALL:
+                if (symbolMap != nullptr && it->symbol >= symbolMapSize) throw std::invalid_argument(invalidMessage);
+                if (it->arity == 0 || it->arity > MAX_FUNCTION_ARITY || depth < it->arity) throw std::invalid_argument(invalidMessage);
+                depth -= it->arity - 1u;
+                break;
+            case OpCode::ADD:
+            case OpCode::SUBTRACT:
+            case OpCode::MULTIPLY:
+            case OpCode::DIVIDE:
+            case OpCode::POWER:
+            case OpCode::MODULO:
+            case OpCode::LESS:
+            case OpCode::LESS_EQUAL:
+            case OpCode::GREATER:
+            case OpCode::GREATER_EQUAL:
+            case OpCode::EQUAL:
+            case OpCode::NOT_EQUAL:
+                if (depth < 2) throw std::invalid_argument(invalidMessage);
+                --depth;
+                break;
+            case OpCode::JUMP:
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::AND_JUMP:
+            case OpCode::OR_JUMP:
+                // JUMP ends a then-branch, whose value the else-branch replaces
+                if (depth < 1 || it->symbol >= static_cast<size_t>(end - it)) throw std::invalid_argument(invalidMessage);
+                --depth;
+                // The else-branch's JUMP_IF_FALSE lands right after the JUMP
+                // that ends its then-branch
+                while (!jumpTargets.isEmpty() && jumpTargets.peek(0).remaining == static_cast<size_t>(end - it) - 1) {
+                    if (jumpTargets.peek(0).depth != depth) throw std::invalid_argument(invalidMessage);
+                    jumpTargets.drop(1);
+                }
+                if (!jumpTargets.isEmpty() && jumpTargets.peek(0).remaining > static_cast<size_t>(end - it) - 1 - it->symbol) {
+                    throw std::invalid_argument(invalidMessage);
+                }
+                jumpTargets.push(JumpTarget{static_cast<size_t>(end - it) - 1 - it->symbol,
+                                            it->op == OpCode::JUMP_IF_FALSE ? depth : depth + 1});
+                break;
+            default:
+                throw std::invalid_argument(invalidMessage);
+        }
+    }
+    while (!jumpTargets.isEmpty() && jumpTargets.peek(0).remaining == 0 && jumpTargets.peek(0).depth == depth) {
+        jumpTargets.drop(1);
+    }
+    if (depth != 1 || !jumpTargets.isEmpty()) {
+        throw std::invalid_argument(invalidMessage);
+    }
+
+    SmallStack<double> operands;
+    for (Iterator it = begin; it != end; ++it) {
+        switch (it->op) {
+            case OpCode::NUMBER:
+                operands.push(it->number);
+                break;
+
+            case OpCode::VARIABLE: {
+                uint32_t id = symbolMap != nullptr ? symbolMap[it->symbol] : it->symbol;
+                if (!symbols.hasVariable(id)) {
+                    if (unknownNames != nullptr && id >= UNKNOWN_SYMBOL && id - UNKNOWN_SYMBOL < unknownNames->size()) {
+                        throw std::runtime_error("Undefined variable: " + std::string((*unknownNames)[id - UNKNOWN_SYMBOL]));
+                    }
+                    throw std::runtime_error("Undefined variable: " + symbols.getName(id));
+                }
+                operands.push(symbols.getVariable(id));
+                break;
+            }
+
+            case OpCode::FUNCTION: {
+                uint32_t id = symbolMap != nullptr ? symbolMap[it->symbol] : it->symbol;
+                if (!symbols.isFunction(id)) {
+                    throw std::runtime_error("Unknown function: " + symbols.getName(id));
+                }
+                double& argument = operands.peek(0);
+                argument = symbols.callFunction(id, argument);
+                break;
+            }
+
+            case OpCode::CALL: {
+                uint32_t id = symbolMap != nullptr ? symbolMap[it->symbol] : it->symbol;
+                if (symbols.getArity(id) != it->arity) {
+                    throw std::runtime_error("Unknown function: " + symbols.getName(id));
+                }
+                double arguments[MAX_FUNCTION_ARITY];
+                popCallArguments(operands, it->arity, prefixOrder, arguments);
+                operands.push(symbols.callFunction(id, arguments));
+                break;
+            }
+
+            case OpCode::JUMP:
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::AND_JUMP:
+            case OpCode::OR_JUMP:
+                if (takeJump(it->op, operands)) it += it->symbol;
+                break;
+
+            default: {
+                double top = operands.pop();
+                double& below = operands.peek(0);
+                below = prefixOrder ? applyOpCode(it->op, top, below) : applyOpCode(it->op, below, top);
+                break;
+            }
+        }
+    }
+
+    return operands.peek(0);
+}
+
+// Run an inline function's body on its arguments without throwing (for
+// tryEvaluateSymbolic, which interprets text and has nothing to inline into)
+inline EvalError tryEvaluateInlineFunction(const InlineFunction& function, const double* arguments,
+                                           const SymbolTable& symbols, bool prefixOrder, double& result) {
+    // Bodies are validated when defined, so the stack never underflows; the
+    // lowered body jumps over the operand of &&, || or ? that is not needed
+    SmallStack<double> operands;
+    for (size_t i = 0; i < function.lowered.size(); ++i) {
+        const CompactToken& token = function.lowered[i];
+        if (function.loweredParameterOf[i] >= 0) {
+            operands.push(arguments[function.loweredParameterOf[i]]);
+            continue;
+        }
+
+        switch (token.op) {
+            case OpCode::NUMBER:
+                operands.push(token.number);
+                break;
+
+            case OpCode::VARIABLE:
+                if (!symbols.hasVariable(token.symbol)) return EvalError::UNDEFINED_VARIABLE;
+                operands.push(symbols.getVariable(token.symbol));
+                break;
+
+            case OpCode::FUNCTION:
+            case OpCode::CALL: {
+                size_t arity = token.op == OpCode::CALL ? token.arity : 1;
+                if (symbols.getArity(token.symbol) != arity) return EvalError::UNKNOWN_TOKEN;
+                double callArguments[MAX_FUNCTION_ARITY];
+                popCallArguments(operands, arity, prefixOrder, callArguments);
+                operands.push(symbols.callFunction(token.symbol, callArguments));
+                break;
+            }
+
+            case OpCode::JUMP:
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::AND_JUMP:
+            case OpCode::OR_JUMP:
+                if (takeJump(token.op, operands)) i += token.symbol;
+                break;
+
+            default: {
+                double top = operands.pop();
+                double& below = operands.peek(0);
+                double left = prefixOrder ? top : below;
+                double right = prefixOrder ? below : top;
+                if (right == 0 && (token.op == OpCode::DIVIDE || token.op == OpCode::MODULO)) {
+                    return token.op == OpCode::DIVIDE ? EvalError::DIVISION_BY_ZERO : EvalError::MODULO_BY_ZERO;
+                }
+                below = applyOpCode(token.op, left, right);
+                break;
+            }
+        }
+    }
+    result = operands.peek(0);
+    return EvalError::NONE;
+}
+
+// Call a function of any kind with its getCallArity(id) arguments in order (for
+// the token-vector APIs, which interpret tokens and have nothing to inline into)
+inline double callAnyFunction(const SymbolTable& symbols, uint32_t id, const double* arguments, bool prefixOrder) {
+    const InlineFunction* function = symbols.getInlineFunction(id);
+    if (function == nullptr) {
+        return symbols.callFunction(id, arguments);
+    }
+    double result = 0.0;
+    EvalError error = tryEvaluateInlineFunction(*function, arguments, symbols, prefixOrder, result);
+    if (error != EvalError::NONE) {
+        throw std::runtime_error(std::string(evalErrorName(error)) + " in function " + symbols.getName(id));
+    }
+    return result;
+}
+
+// Non-throwing evaluation of postfix (or prefix) text against a symbol table.
+// Identifiers are looked up, never interned, so symbols stays untouched.
+// Text with &&, || or ? is lowered first (lowerConditionals over a stand-in
+// token per text token), so the operand that is not needed is jumped over
+// as in a compiled program; other text is interpreted as it is read.
+// Errors carry the byte offset of the offending token; leftover operands are
+// reported at the end of the text for postfix and at its start for prefix.
+inline EvalResult tryEvaluateSymbolic(std::string_view expression, const SymbolTable& symbols, bool prefixOrder) {
+    SmallStack<double> operands;
+
+    // Run one token on the stack
+    auto run = [&](std::string_view token) -> EvalError {
+        if (ExpressionLexer::isNumber(token)) {
+            double number = 0.0;
+            if (!ExpressionLexer::parseNumber(token, number)) {
+                return EvalError::MALFORMED_NUMBER;
+            }
+            operands.push(number);
+            return EvalError::NONE;
+        }
+
+        OpCode op = binaryOpCode(token);
+        if (op == OpCode::INVALID) {
+            op = logicOpCode(token);
+        }
+        if (op == OpCode::SELECT) {
+            if (operands.size() < 3) {
+                return EvalError::MISSING_OPERAND;
+            }
+            double choice[3];
+            popCallArguments(operands, 3, prefixOrder, choice);
+            operands.push(choice[0] != 0 ? choice[1] : choice[2]);
+            return EvalError::NONE;
+        }
+        if (op != OpCode::INVALID) {
+            if (operands.size() < 2) {
+                return EvalError::MISSING_OPERAND;
+            }
+            double top = operands.pop();
+            double& below = operands.peek(0);
+            double left = prefixOrder ? top : below;
+            double right = prefixOrder ? below : top;
+            if (right == 0 && (op == OpCode::DIVIDE || op == OpCode::MODULO)) {
+                return op == OpCode::DIVIDE ? EvalError::DIVISION_BY_ZERO : EvalError::MODULO_BY_ZERO;
+            }
+            below = applyOpCode(op, left, right);
+            return EvalError::NONE;
+        }
+
+        uint32_t id = 0;
+        if (!ExpressionLexer::isIdentifier(token)) {
+            return EvalError::UNKNOWN_TOKEN;
+        }
+        if (!symbols.find(token, id)) {
+            return EvalError::UNDEFINED_VARIABLE;
+        }
+        size_t arity = symbols.getArity(id);
+        const InlineFunction* function = symbols.getInlineFunction(id);
+        if (arity > 0 || function != nullptr) {
+            size_t count = function != nullptr ? function->arity : arity;
+            if (operands.size() < count) {
+                return EvalError::MISSING_OPERAND;
+            }
+            double arguments[MAX_FUNCTION_ARITY];
+            popCallArguments(operands, count, prefixOrder, arguments);
+            double value = 0.0;
+            if (function == nullptr) {
+                value = symbols.callFunction(id, arguments);
+            } else {
+                EvalError error = tryEvaluateInlineFunction(*function, arguments, symbols, prefixOrder, value);
+                if (error != EvalError::NONE) {
+                    return error;
+                }
+            }
+            operands.push(value);
+        } else if (symbols.hasVariable(id)) {
+            operands.push(symbols.getVariable(id));
+        } else {
+            return EvalError::UNDEFINED_VARIABLE;
+        }
+        return EvalError::NONE;
+    };
+
+    bool hasConditionals = expression.find('?') != std::string_view::npos ||
+                           expression.find("&&") != std::string_view::npos ||
+                           expression.find("||") != std::string_view::npos;
+    if (hasConditionals) {
+        // Stand-ins only carry the operand count; a token that cannot be
+        // classified stops lowering there, and is reported when run
+        std::vector<std::string_view> tokens;
+        std::vector<CompactToken> program;
+        std::vector<int> marks;
+        ExpressionLexer::forEachToken(expression, [&](std::string_view token) {
+            CompactToken standIn(OpCode::NUMBER, 0.0);
+            OpCode op = binaryOpCode(token);
+            if (op == OpCode::INVALID) {
+                op = logicOpCode(token);
+            }
+            uint32_t id = 0;
+            if (op != OpCode::INVALID) {
+                standIn = CompactToken(op);
+            } else if (ExpressionLexer::isIdentifier(token)) {
+                if (symbols.find(token, id)) {
+                    const InlineFunction* function = symbols.getInlineFunction(id);
+                    size_t arity = function != nullptr ? function->arity : symbols.getArity(id);
+                    if (arity == 1) standIn = CompactToken(OpCode::FUNCTION, 0.0, id);
+                    if (arity > 1) standIn = CompactToken(OpCode::CALL, 0.0, id, static_cast<uint8_t>(arity));
+                }
+            } else if (!ExpressionLexer::isNumber(token)) {
+                standIn = CompactToken();
+            }
+            marks.push_back(static_cast<int>(tokens.size()));
+            tokens.push_back(token);
+            program.push_back(standIn);
+        });
+        lowerConditionals(program, prefixOrder, &marks);
+
+        for (size_t step = 0; step < program.size(); ++step) {
+            size_t i = prefixOrder ? program.size() - 1 - step : step;
+            const CompactToken& token = program[i];
+            if (marks[i] >= 0) {
+                std::string_view text = tokens[static_cast<size_t>(marks[i])];
+                EvalError error = run(text);
+                if (error != EvalError::NONE) {
+                    return EvalResult::failure(error, static_cast<size_t>(text.data() - expression.data()));
+                }
+            } else if (token.op == OpCode::NUMBER) {
+                operands.push(token.number);
+            } else if (token.op == OpCode::NOT_EQUAL) {
+                double top = operands.pop();
+                operands.peek(0) = applyOpCode(OpCode::NOT_EQUAL, operands.peek(0), top);
+            } else if (takeJump(token.op, operands)) {
+                step += token.symbol;
+            }
+        }
+    } else {
+        const char* begin = expression.data();
+        const char* end = begin + expression.size();
+        const char* p = prefixOrder ? end : begin;
+
+        while (true) {
+            // Next token: forward for postfix, backward for prefix
+            const char* tokenBegin;
+            const char* tokenEnd;
+            if (prefixOrder) {
+                while (p > begin && ExpressionLexer::isSpace(p[-1])) --p;
+                if (p == begin) break;
+                tokenEnd = p;
+                while (p > begin && !ExpressionLexer::isSpace(p[-1])) --p;
+                tokenBegin = p;
+            } else {
+                while (p < end && ExpressionLexer::isSpace(*p)) ++p;
+                if (p == end) break;
+                tokenBegin = p;
+                while (p < end && !ExpressionLexer::isSpace(*p)) ++p;
+                tokenEnd = p;
+            }
+
+            EvalError error = run(std::string_view(tokenBegin, static_cast<size_t>(tokenEnd - tokenBegin)));
+            if (error != EvalError::NONE) {
+                return EvalResult::failure(error, static_cast<size_t>(tokenBegin - begin));
+            }
+        }
+    }
+
+    if (operands.size() == 0) {
+        return EvalResult::failure(EvalError::EMPTY_EXPRESSION, 0);
+    }
+    if (operands.size() > 1) {
+        size_t offset = expression.size();
+        if (prefixOrder) {
+            offset = 0;
+            while (offset < expression.size() && ExpressionLexer::isSpace(expression[offset])) ++offset;
+        }
+        return EvalResult::failure(EvalError::MISSING_OPERATOR, offset);
+    }
+    return EvalResult::success(operands.peek(0));
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// Why an evaluation failed; NONE means it succeeded
+enum class EvalError : uint8_t {
+    NONE,
+    EMPTY_EXPRESSION,
+    UNEXPECTED_CHARACTER,
+    MALFORMED_NUMBER,
+    MISSING_OPERAND,
+    MISSING_OPERATOR,
+    UNBALANCED_PARENTHESIS,
+    UNDEFINED_VARIABLE,
+    UNKNOWN_TOKEN,
+    FUNCTION_NEEDS_PARENTHESES,
+    DIVISION_BY_ZERO,
+    MODULO_BY_ZERO,
+    TOO_DEEP
+};
+
+inline const char* evalErrorName(EvalError error) {
+    switch (error) {
+        case EvalError::NONE: return "No error";
+        case EvalError::EMPTY_EXPRESSION: return "Empty expression";
+        case EvalError::UNEXPECTED_CHARACTER: return "Unexpected character";
+        case EvalError::MALFORMED_NUMBER: return "Malformed number";
+        case EvalError::MISSING_OPERAND: return "Missing operand";
+        case EvalError::MISSING_OPERATOR: return "Missing operator";
+        case EvalError::UNBALANCED_PARENTHESIS: return "Unbalanced parenthesis";
+        case EvalError::UNDEFINED_VARIABLE: return "Undefined variable";
+        case EvalError::UNKNOWN_TOKEN: return "Unknown token";
+        case EvalError::FUNCTION_NEEDS_PARENTHESES: return "Function requires parentheses";
+        case EvalError::DIVISION_BY_ZERO: return "Division by zero";
+        case EvalError::MODULO_BY_ZERO: return "Modulo by zero";
+        case EvalError::TOO_DEEP: return "Expression nested too deeply";
+    }
+    return "Unknown error";
+}
+
+// Value or error code plus the byte offset in the input where it was found.
+// Returned by the try* evaluators, which never throw for bad input, so a
+// stream of invalid expressions costs no more than a stream of valid ones.
+struct EvalResult {
+    double value;
+    EvalError error;
+    size_t offset;
+
+    static EvalResult success(double value) {
+        return EvalResult{value, EvalError::NONE, 0};
+    }
+
+    static EvalResult failure(EvalError error, size_t offset) {
+        return EvalResult{0.0, error, offset};
+    }
+
+    bool ok() const {
+        return error == EvalError::NONE;
+    }
+
+    explicit operator bool() const {
+        return ok();
+    }
+
+    double valueOr(double fallback) const {
+        return ok() ? value : fallback;
+    }
+
+    // "Undefined variable 'rate' at offset 6" (the quoted token is read from input)
+    std::string describe(std::string_view input = std::string_view()) const {
+        std::string text = evalErrorName(error);
+        if (ok()) {
+            return text;
+        }
+
+        if (offset < input.size() && error != EvalError::EMPTY_EXPRESSION) {
+            size_t end = offset;
+            auto isWordChar = [](char c) {
+                return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '.';
+            };
+            while (end < input.size() && isWordChar(input[end])) {
+                ++end;
+            }
+            if (end == offset) {
+                ++end;
+            }
+            text += " '" + std::string(input.substr(offset, end - offset)) + "'";
+        }
+        return text + " at offset " + std::to_string(offset);
+    }
+};
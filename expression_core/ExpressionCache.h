@@ -0,0 +1,156 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+// Which entry a full cache shard gives up for a new one
+enum class EvictionPolicy {
+    LRU,    // Least recently looked up
+    FIFO    // Oldest insertion, lookups do not refresh
+};
+
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+};
+
+// Bounded, thread-safe map from expression text to Value.
+// Keys are spread over independently locked shards so concurrent lookups
+// of different expressions rarely contend on the same mutex.
+template<typename Value>
+class ExpressionCache {
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::pair<std::string, Value>> order; // Front = next to survive, back = next to evict
+        std::unordered_map<std::string, typename std::list<std::pair<std::string, Value>>::iterator> index;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardCapacity;
+    EvictionPolicy policy;
+
+    std::atomic<size_t> hits;
+    std::atomic<size_t> misses;
+    std::atomic<size_t> evictions;
+
+    Shard& shardFor(const std::string& key) {
+        return *shards[std::hash<std::string>()(key) % shards.size()];
+    }
+
+public:
+    explicit ExpressionCache(size_t capacity = 4096, EvictionPolicy policy = EvictionPolicy::LRU, size_t shardCount = 16)
+        : policy(policy), hits(0), misses(0), evictions(0) {
+        if (shardCount == 0) shardCount = 1;
+        if (capacity < shardCount) shardCount = capacity == 0 ? 1 : capacity;
+
+        shardCapacity = capacity == 0 ? 1 : (capacity + shardCount - 1) / shardCount;
+        for (size_t i = 0; i < shardCount; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    ExpressionCache(const ExpressionCache&) = delete;
+    ExpressionCache& operator=(const ExpressionCache&) = delete;
+
+    // Copy the cached value into out; returns false on a miss
+    bool lookup(const std::string& key, Value& out) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (policy == EvictionPolicy::LRU) {
+            shard.order.splice(shard.order.begin(), shard.order, it->second);
+        }
+        out = it->second->second;
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Insert or replace; evicts one entry when the shard is full
+    void insert(const std::string& key, const Value& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            it->second->second = value;
+            if (policy == EvictionPolicy::LRU) {
+                shard.order.splice(shard.order.begin(), shard.order, it->second);
+            }
+            return;
+        }
+
+        if (shard.index.size() >= shardCapacity) {
+            shard.index.erase(shard.order.back().first);
+            shard.order.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        shard.order.emplace_front(key, value);
+        shard.index.emplace(key, shard.order.begin());
+    }
+
+    void clear() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->order.clear();
+            shard->index.clear();
+        }
+    }
+
+    CacheStats getStats() const {
+        CacheStats stats;
+        stats.hits = hits.load(std::memory_order_relaxed);
+        stats.misses = misses.load(std::memory_order_relaxed);
+        stats.evictions = evictions.load(std::memory_order_relaxed);
+        for (const auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            stats.entries += shard->index.size();
+        }
+        return stats;
+    }
+
+    size_t getCapacity() const {
+        return shardCapacity * shards.size();
+    }
+
+    EvictionPolicy getPolicy() const {
+        return policy;
+    }
+
+    // Collapse whitespace runs to one space and trim, so "3  4 +" and "3 4 +" share an entry
+    static std::string normalize(std::string_view expression) {
+        std::string key;
+        key.reserve(expression.size());
+
+        bool pendingSpace = false;
+        for (char c : expression) {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') {
+                pendingSpace = !key.empty();
+            } else {
+                if (pendingSpace) {
+                    key += ' ';
+                    pendingSpace = false;
+                }
+                key += c;
+            }
+        }
+
+        return key;
+    }
+};
@@ -0,0 +1,312 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "ExpressionLexer.h"
+#include "CompactToken.h"
+
+// Hash-consed expression DAG shared by many formulas. Structurally identical
+// subtrees (same operator, same operands) become one node no matter how many
+// formulas contain them, so evaluating the whole set costs one step per unique
+// node. Operands of + and * are stored in a fixed order, which also merges
+// "a + b" with "b + a" (IEEE addition and multiplication are commutative).
+//
+// Nodes are appended after their operands, so a single front-to-back pass over
+// the node list evaluates everything. Conditionals (&&, ||, ?) therefore
+// choose between computed operands instead of jumping over them.
+class ExpressionDag {
+public:
+    // One unique subexpression; left/right index earlier nodes
+    struct Node {
+        double number;      // NUMBER
+        uint32_t symbol;    // VARIABLE / FUNCTION id in the SymbolTable
+        uint32_t left;      // FUNCTION argument, binary left operand, or CALL's first entry in arguments
+        uint32_t right;     // Binary right operand or CALL's arity
+        OpCode op;
+
+        Node(OpCode op, double number, uint32_t symbol, uint32_t left, uint32_t right)
+            : number(number), symbol(symbol), left(left), right(right), op(op) {}
+    };
+
+    // Add a formula in prefix (prefixOrder) or postfix order and return its index.
+    // Identifiers are interned into symbols; ones that are functions at this
+    // point are calls (inline functions are expanded), the rest variables. Malformed input throws
+    // std::invalid_argument and leaves the DAG unchanged.
+    size_t add(std::string_view expression, SymbolTable& symbols, bool prefixOrder) {
+        std::vector<CompactToken> program;
+        compileCompactProgram(expression, symbols, prefixOrder, program);
+
+        const char* invalidMessage = prefixOrder ? "Invalid prefix expression" : "Invalid postfix expression";
+        size_t firstNew = nodes.size();
+        std::vector<uint32_t> operands;
+
+        try {
+            for (size_t step = 0; step < program.size(); ++step) {
+                const CompactToken& token = prefixOrder ? program[program.size() - 1 - step] : program[step];
+
+                switch (token.op) {
+                    case OpCode::NUMBER:
+                    case OpCode::VARIABLE:
+                        operands.push_back(intern(Node(token.op, token.number, token.symbol, 0, 0)));
+                        break;
+
+                    case OpCode::FUNCTION:
+                        if (operands.empty()) throw std::invalid_argument(invalidMessage);
+                        operands.back() = intern(Node(OpCode::FUNCTION, 0.0, token.symbol, operands.back(), 0));
+                        break;
+
+                    case OpCode::SELECT:
+                    case OpCode::CALL: {
+                        size_t arity = operandCount(token);
+                        if (arity == 0 || operands.size() < arity) throw std::invalid_argument(invalidMessage);
+                        // Stored first argument first; prefix order keeps it on top
+                        std::vector<uint32_t> list(operands.end() - static_cast<std::ptrdiff_t>(arity), operands.end());
+                        if (prefixOrder) std::reverse(list.begin(), list.end());
+                        operands.resize(operands.size() - arity);
+                        operands.push_back(intern(Node(token.op, 0.0, token.symbol, internArguments(list), static_cast<uint32_t>(arity))));
+                        break;
+                    }
+
+                    case OpCode::INVALID:
+                        throw std::invalid_argument(invalidMessage);
+
+                    default: {
+                        if (operands.size() < 2) throw std::invalid_argument(invalidMessage);
+                        uint32_t top = operands.back();
+                        operands.pop_back();
+                        uint32_t left = prefixOrder ? top : operands.back();
+                        uint32_t right = prefixOrder ? operands.back() : top;
+                        if ((token.op == OpCode::ADD || token.op == OpCode::MULTIPLY) && right < left) {
+                            std::swap(left, right);
+                        }
+                        operands.back() = intern(Node(token.op, 0.0, 0, left, right));
+                        break;
+                    }
+                }
+            }
+
+            if (operands.size() != 1) {
+                throw std::invalid_argument(invalidMessage);
+            }
+        } catch (...) {
+            // Drop the nodes this formula created so no orphan is ever evaluated
+            for (size_t i = firstNew; i < nodes.size(); ++i) {
+                index.erase(nodes[i]);
+            }
+            nodes.erase(nodes.begin() + firstNew, nodes.end());
+            throw;
+        }
+
+        tokenCount += program.size();
+        roots.push_back(operands.back());
+        return roots.size() - 1;
+    }
+
+    // Evaluate every formula with the variables and functions in symbols;
+    // results[i] is formula i. A formula that fails (undefined variable, unknown
+    // function, division or modulo by zero) gets NaN and, if errors is given,
+    // its message in (*errors)[i]; the others are unaffected. Returns the
+    // number of failed formulas.
+    size_t evaluate(const SymbolTable& symbols, std::vector<double>& results,
+                    std::vector<std::string>* errors = nullptr) {
+        values.resize(nodes.size());
+        nodeErrors.assign(nodes.size(), NO_NODE_ERROR);
+        messages.clear();
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const Node& node = nodes[i];
+            try {
+                switch (node.op) {
+                    case OpCode::NUMBER:
+                        values[i] = node.number;
+                        break;
+
+                    case OpCode::VARIABLE:
+                        if (!symbols.hasVariable(node.symbol)) {
+                            throw std::runtime_error("Undefined variable: " + symbols.getName(node.symbol));
+                        }
+                        values[i] = symbols.getVariable(node.symbol);
+                        break;
+
+                    case OpCode::FUNCTION:
+                        if (inheritError(i, node.left)) break;
+                        if (!symbols.isFunction(node.symbol)) {
+                            throw std::runtime_error("Unknown function: " + symbols.getName(node.symbol));
+                        }
+                        values[i] = symbols.callFunction(node.symbol, values[node.left]);
+                        break;
+
+                    case OpCode::CALL: {
+                        double callArguments[MAX_FUNCTION_ARITY];
+                        bool failed = false;
+                        for (uint32_t k = 0; k < node.right && !failed; ++k) {
+                            failed = inheritError(i, arguments[node.left + k]);
+                            callArguments[k] = values[arguments[node.left + k]];
+                        }
+                        if (failed) break;
+                        if (symbols.getArity(node.symbol) != node.right) {
+                            throw std::runtime_error("Unknown function: " + symbols.getName(node.symbol));
+                        }
+                        values[i] = symbols.callFunction(node.symbol, callArguments);
+                        break;
+                    }
+
+                    // Every node is evaluated once per pass, so conditionals
+                    // pick among computed values; only the chosen side's error counts
+                    case OpCode::SELECT: {
+                        uint32_t condition = arguments[node.left];
+                        if (inheritError(i, condition)) break;
+                        uint32_t chosen = arguments[node.left + (values[condition] != 0 ? 1 : 2)];
+                        if (inheritError(i, chosen)) break;
+                        values[i] = values[chosen];
+                        break;
+                    }
+
+                    case OpCode::AND:
+                    case OpCode::OR: {
+                        if (inheritError(i, node.left)) break;
+                        bool decided = (values[node.left] != 0) == (node.op == OpCode::OR);
+                        if (decided) {
+                            values[i] = node.op == OpCode::OR ? 1.0 : 0.0;
+                        } else if (!inheritError(i, node.right)) {
+                            values[i] = values[node.right] != 0 ? 1.0 : 0.0;
+                        }
+                        break;
+                    }
+
+                    default:
+                        if (inheritError(i, node.left) || inheritError(i, node.right)) break;
+                        values[i] = applyOpCode(node.op, values[node.left], values[node.right]);
+                        break;
+                }
+            } catch (const std::exception& e) {
+                nodeErrors[i] = static_cast<uint32_t>(messages.size());
+                messages.push_back(e.what());
+                values[i] = std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+
+        size_t failed = 0;
+        results.resize(roots.size());
+        if (errors != nullptr) {
+            errors->assign(roots.size(), std::string());
+        }
+        for (size_t f = 0; f < roots.size(); ++f) {
+            results[f] = values[roots[f]];
+            uint32_t error = nodeErrors[roots[f]];
+            if (error != NO_NODE_ERROR) {
+                ++failed;
+                if (errors != nullptr) (*errors)[f] = messages[error];
+            }
+        }
+        return failed;
+    }
+
+    void clear() {
+        nodes.clear();
+        roots.clear();
+        index.clear();
+        arguments.clear();
+        argumentLists.clear();
+        values.clear();
+        nodeErrors.clear();
+        messages.clear();
+        tokenCount = 0;
+    }
+
+    size_t getFormulaCount() const {
+        return roots.size();
+    }
+
+    // Unique nodes, i.e. the work per evaluate()
+    size_t getNodeCount() const {
+        return nodes.size();
+    }
+
+    // Tokens added over all formulas, i.e. the work without sharing
+    size_t getTokenCount() const {
+        return tokenCount;
+    }
+
+    const std::vector<Node>& getNodes() const {
+        return nodes;
+    }
+
+    size_t getRoot(size_t formula) const {
+        return roots.at(formula);
+    }
+
+private:
+    struct NodeHash {
+        size_t operator()(const Node& node) const {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &node.number, sizeof(bits));
+            uint64_t h = bits * 0x9E3779B97F4A7C15ULL;
+            h ^= (static_cast<uint64_t>(node.symbol) << 8 | static_cast<uint64_t>(node.op)) + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+            h ^= (static_cast<uint64_t>(node.left) << 32 | node.right) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+
+    // Numbers compare by bit pattern, so 0 and -0 stay distinct
+    struct NodeEqual {
+        bool operator()(const Node& a, const Node& b) const {
+            return a.op == b.op && a.symbol == b.symbol && a.left == b.left && a.right == b.right &&
+                   std::memcmp(&a.number, &b.number, sizeof(double)) == 0;
+        }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> roots;                          // Root node per formula
+    std::unordered_map<Node, uint32_t, NodeHash, NodeEqual> index;
+    std::vector<uint32_t> arguments;                      // CALL argument lists, back to back
+    std::map<std::vector<uint32_t>, uint32_t> argumentLists; // List -> its offset in arguments
+    std::vector<double> values;                           // Scratch, one per node
+    std::vector<uint32_t> nodeErrors;                     // Index into messages, or NO_NODE_ERROR
+    std::vector<std::string> messages;
+
+    static constexpr uint32_t NO_NODE_ERROR = 0xFFFFFFFFu;
+
+    // A node with a failed operand fails with the same message
+    bool inheritError(size_t node, uint32_t operand) {
+        if (nodeErrors[operand] == NO_NODE_ERROR) {
+            return false;
+        }
+        nodeErrors[node] = nodeErrors[operand];
+        values[node] = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    size_t tokenCount = 0;
+
+    // Offset of list in arguments; equal lists share one, so equal calls intern to one node
+    uint32_t internArguments(const std::vector<uint32_t>& list) {
+        auto it = argumentLists.find(list);
+        if (it != argumentLists.end()) {
+            return it->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(arguments.size());
+        arguments.insert(arguments.end(), list.begin(), list.end());
+        argumentLists.emplace(list, offset);
+        return offset;
+    }
+
+    uint32_t intern(const Node& node) {
+        auto it = index.find(node);
+        if (it != index.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(node);
+        index.emplace(node, id);
+        return id;
+    }
+};
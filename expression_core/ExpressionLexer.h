@@ -0,0 +1,132 @@
+#pragma once
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <cctype>
+#include <cstddef>
+
+// Whitespace-delimited lexer shared by the expression modules.
+// Tokens are string_views into the source text, so scanning never allocates.
+// The source must outlive every token handed out by the lexer.
+class ExpressionLexer {
+public:
+    explicit ExpressionLexer(std::string_view source) : source_(source), pos_(0), tokenStart_(0) {}
+
+    // Advance to the next token; returns false once the input is exhausted
+    bool next(std::string_view& token) {
+        while (pos_ < source_.size() && isSpace(source_[pos_])) {
+            ++pos_;
+        }
+        if (pos_ >= source_.size()) {
+            return false;
+        }
+
+        tokenStart_ = pos_;
+        while (pos_ < source_.size() && !isSpace(source_[pos_])) {
+            ++pos_;
+        }
+        token = source_.substr(tokenStart_, pos_ - tokenStart_);
+        return true;
+    }
+
+    // Byte offset of the most recently returned token
+    size_t tokenOffset() const {
+        return tokenStart_;
+    }
+
+    // Restart scanning from the beginning of the source
+    void reset() {
+        pos_ = 0;
+        tokenStart_ = 0;
+    }
+
+    // Unary minus in postfix/prefix text converted from infix; no number or
+    // identifier can spell it, so it never shadows a variable
+    static constexpr std::string_view UNARY_MINUS = "~";
+
+    // Call func(token) for every token in source
+    template<typename Func>
+    static void forEachToken(std::string_view source, Func func) {
+        ExpressionLexer lexer(source);
+        std::string_view token;
+        while (lexer.next(token)) {
+            func(token);
+        }
+    }
+
+    // Same character set as operator>> on a stream
+    static bool isSpace(char c) {
+        return std::isspace(static_cast<unsigned char>(c)) != 0;
+    }
+
+    // Optional sign, at least one digit and at most one decimal point (e.g. "-3", "2.5", ".5")
+    static bool isNumber(std::string_view str) {
+        if (str.empty()) return false;
+
+        size_t start = 0;
+        if (str[0] == '-' || str[0] == '+') {
+            start = 1;
+        }
+
+        bool hasDecimal = false;
+        bool hasDigit = false;
+        for (size_t i = start; i < str.length(); ++i) {
+            if (str[i] == '.') {
+                if (hasDecimal) return false;
+                hasDecimal = true;
+            } else if (std::isdigit(static_cast<unsigned char>(str[i]))) {
+                hasDigit = true;
+            } else {
+                return false;
+            }
+        }
+
+        return hasDigit;
+    }
+
+    // Letter or underscore followed by letters, digits or underscores (the
+    // infix parsers' rule, so names survive conversion to postfix/prefix)
+    static bool isIdentifier(std::string_view str) {
+        if (str.empty() || (!std::isalpha(static_cast<unsigned char>(str[0])) && str[0] != '_')) {
+            return false;
+        }
+
+        for (char c : str) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Parse the whole view as a double without copying it; returns false on failure
+    static bool parseNumber(std::string_view str, double& value) {
+        if (!str.empty() && str[0] == '+') {
+            str.remove_prefix(1);
+        }
+        if (str.empty()) {
+            return false;
+        }
+
+        const char* first = str.data();
+        const char* last = first + str.size();
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+
+    static std::string_view trim(std::string_view str) {
+        size_t start = str.find_first_not_of(" \t\n\r");
+        if (start == std::string_view::npos) {
+            return std::string_view();
+        }
+
+        size_t end = str.find_last_not_of(" \t\n\r");
+        return str.substr(start, end - start + 1);
+    }
+
+private:
+    std::string_view source_;
+    size_t pos_;
+    size_t tokenStart_;
+};
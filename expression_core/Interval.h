@@ -0,0 +1,405 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cfloat>
+#include "Numeric.h"
+
+// Interval arithmetic for range analysis: evaluateNumeric<Interval> with a box
+// (one interval per variable) returns an interval containing the value at every
+// point of the box. Bounds are rounded outward, exactly for + - * / and sqrt
+// (checked with fma), and by one ulp for the libm functions.
+//
+// Points where the expression is undefined (sqrt of a negative, log of zero or
+// less, asin outside [-1, 1], division by exactly zero) are left out; if no
+// point is left the result is empty.
+struct Interval {
+    double lower;
+    double upper;
+
+    Interval(double value = 0.0) : lower(value), upper(value) {}
+    Interval(double lower, double upper) : lower(lower), upper(upper) {
+        if (std::isnan(lower) || std::isnan(upper)) {
+            throw std::invalid_argument("Interval bounds must not be NaN");
+        }
+    }
+
+    static Interval entire() {
+        return Interval(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+    }
+
+    static Interval empty() {
+        return Interval(std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity());
+    }
+
+    bool isEmpty() const { return lower > upper; }
+    bool isPoint() const { return lower == upper; }
+    bool contains(double x) const { return lower <= x && x <= upper; }
+    double width() const { return isEmpty() ? 0.0 : upper - lower; }
+    double midpoint() const { return lower / 2 + upper / 2; }
+
+    // Smallest interval containing both
+    static Interval hull(const Interval& a, const Interval& b) {
+        if (a.isEmpty()) return b;
+        if (b.isEmpty()) return a;
+        return Interval(std::min(a.lower, b.lower), std::max(a.upper, b.upper));
+    }
+
+    static Interval intersect(const Interval& a, const Interval& b) {
+        double lower = std::max(a.lower, b.lower);
+        double upper = std::min(a.upper, b.upper);
+        return lower <= upper ? Interval(lower, upper) : empty();
+    }
+
+    Interval operator-() const {
+        return isEmpty() ? empty() : Interval(-upper, -lower);
+    }
+
+    friend Interval operator+(const Interval& a, const Interval& b);
+    friend Interval operator-(const Interval& a, const Interval& b);
+    friend Interval operator*(const Interval& a, const Interval& b);
+    friend Interval operator/(const Interval& a, const Interval& b);
+};
+
+namespace IntervalRounding {
+
+const double INF = std::numeric_limits<double>::infinity();
+
+// One ulp outward; an overflowed +inf lower bound becomes DBL_MAX
+inline double down(double x) { return std::nextafter(x, -INF); }
+inline double up(double x) { return std::nextafter(x, INF); }
+
+// Bounds on the exact a + b (TwoSum gives the rounding error)
+inline double addDown(double a, double b) {
+    double s = a + b;
+    if (std::isinf(s)) return (std::isinf(a) || std::isinf(b)) ? s : down(s);
+    double bb = s - a;
+    double error = (a - (s - bb)) + (b - bb);
+    return error < 0 ? down(s) : s;
+}
+
+inline double addUp(double a, double b) {
+    return -addDown(-a, -b);
+}
+
+// Bounds on the exact a * b; zero times an infinite bound is zero
+inline double multiplyDown(double a, double b) {
+    if (a == 0 || b == 0) return 0.0;
+    double p = a * b;
+    if (std::isinf(p)) return (std::isinf(a) || std::isinf(b)) ? p : down(p);
+    if (std::abs(p) < DBL_MIN) return down(p); // Underflow: fma can't see the error
+    return std::fma(a, b, -p) < 0 ? down(p) : p;
+}
+
+inline double multiplyUp(double a, double b) {
+    return -multiplyDown(-a, b);
+}
+
+// Bounds on the exact 1 / b, b != 0
+inline double reciprocalDown(double b) {
+    double q = 1.0 / b;
+    if (std::isinf(b)) return q;
+    if (std::isinf(q) || std::abs(q) < DBL_MIN) return down(q);
+    double remainder = std::fma(-q, b, 1.0); // Exact 1 - q * b
+    return (b > 0 ? remainder : -remainder) < 0 ? down(q) : q;
+}
+
+inline double reciprocalUp(double b) {
+    return -reciprocalDown(-b);
+}
+
+inline double sqrtDown(double x) {
+    double s = std::sqrt(x);
+    if (std::isinf(s) || s == 0) return s;
+    return std::fma(-s, s, x) < 0 ? down(s) : s;
+}
+
+inline double sqrtUp(double x) {
+    double s = std::sqrt(x);
+    if (std::isinf(s)) return s;
+    if (s == 0) return x == 0 ? 0.0 : up(s);
+    return std::fma(-s, s, x) > 0 ? up(s) : s;
+}
+
+// Does phase + k * period fall in [lower, upper] for some integer k? Errs towards yes.
+inline bool containsPhase(double lower, double upper, double phase, double period) {
+    const double slack = 1e-9;
+    double k = std::ceil((lower - slack - phase) / period);
+    return phase + k * period <= upper + slack;
+}
+
+// f increasing on [lower, upper], result within one ulp
+template<typename Func>
+Interval increasing(Func f, double lower, double upper) {
+    return Interval(down(f(lower)), up(f(upper)));
+}
+
+} // namespace IntervalRounding
+
+inline Interval operator+(const Interval& a, const Interval& b) {
+    if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+    return Interval(IntervalRounding::addDown(a.lower, b.lower), IntervalRounding::addUp(a.upper, b.upper));
+}
+
+inline Interval operator-(const Interval& a, const Interval& b) {
+    return a + -b;
+}
+
+inline Interval operator*(const Interval& a, const Interval& b) {
+    using namespace IntervalRounding;
+    if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+
+    double lower = std::min(std::min(multiplyDown(a.lower, b.lower), multiplyDown(a.lower, b.upper)),
+                            std::min(multiplyDown(a.upper, b.lower), multiplyDown(a.upper, b.upper)));
+    double upper = std::max(std::max(multiplyUp(a.lower, b.lower), multiplyUp(a.lower, b.upper)),
+                            std::max(multiplyUp(a.upper, b.lower), multiplyUp(a.upper, b.upper)));
+    return Interval(lower, upper);
+}
+
+// Division by an interval containing zero skips the zero itself: [1, 2] / [0, 4]
+// is [0.25, inf], and a divisor with zero strictly inside gives two half-lines,
+// returned as their hull (the entire line). Only [0, 0] is an error, as for doubles.
+inline Interval operator/(const Interval& a, const Interval& b) {
+    using namespace IntervalRounding;
+    if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+    if (b.lower == 0 && b.upper == 0) throw std::runtime_error("Division by zero");
+
+    if (!b.contains(0)) {
+        return a * Interval(reciprocalDown(b.upper), reciprocalUp(b.lower));
+    }
+    if (a.contains(0) || (b.lower < 0 && b.upper > 0)) {
+        return Interval::entire();
+    }
+    if (b.lower == 0) {
+        return a * Interval(reciprocalDown(b.upper), INF);
+    }
+    return a * Interval(-INF, reciprocalUp(b.lower));
+}
+
+// Comparison over intervals, in the 1.0 / 0.0 convention of evaluateComparison:
+// [1, 1] holds for every pair of points, [0, 0] for none, [0, 1] undecided.
+// An empty side compares like NaN: only "!=" holds.
+inline Interval compareIntervals(const Interval& a, std::string_view op, const Interval& b) {
+    const Interval yes(1.0), no(0.0), maybe(0.0, 1.0);
+
+    if (a.isEmpty() || b.isEmpty()) {
+        if (op == "!=") return yes;
+        if (op == "==" || op == "<" || op == "<=" || op == ">" || op == ">=") return no;
+    } else if (op == "<") {
+        return a.upper < b.lower ? yes : (a.lower >= b.upper ? no : maybe);
+    } else if (op == "<=") {
+        return a.upper <= b.lower ? yes : (a.lower > b.upper ? no : maybe);
+    } else if (op == ">") {
+        return compareIntervals(b, "<", a);
+    } else if (op == ">=") {
+        return compareIntervals(b, "<=", a);
+    } else if (op == "==") {
+        if (a.isPoint() && b.isPoint() && a.lower == b.lower) return yes;
+        return (a.upper < b.lower || b.upper < a.lower) ? no : maybe;
+    } else if (op == "!=") {
+        Interval equal = compareIntervals(a, "==", b);
+        return Interval(1.0 - equal.upper, 1.0 - equal.lower);
+    }
+
+    throw std::invalid_argument("Unknown comparison operator: " + std::string(op));
+}
+
+template<>
+struct NumericTraits<Interval> {
+    // Literals that are not exact doubles get the two neighbouring doubles
+    static Interval parse(std::string_view text) {
+        double value = NumericTraits<double>::parse(text);
+        if (std::abs(value) < 9007199254740992.0 && value == std::trunc(value)) {
+            return Interval(value);
+        }
+        return Interval(IntervalRounding::down(value), IntervalRounding::up(value));
+    }
+
+    static Interval divide(const Interval& a, const Interval& b) {
+        return a / b;
+    }
+
+    // fmod keeps the dividend's sign and is smaller than the divisor in magnitude
+    static Interval modulo(const Interval& a, const Interval& b) {
+        if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+        if (b.lower == 0 && b.upper == 0) throw std::runtime_error("Modulo by zero");
+
+        double limit = std::max(std::abs(b.lower), std::abs(b.upper));
+        double smallest = b.contains(0) ? 0.0 : std::min(std::abs(b.lower), std::abs(b.upper));
+        if (a.lower >= 0 && a.upper < smallest) return a;
+        if (a.upper <= 0 && -a.lower < smallest) return a;
+
+        return Interval(a.lower < 0 ? std::max(a.lower, -limit) : 0.0,
+                        a.upper > 0 ? std::min(a.upper, limit) : 0.0);
+    }
+
+    static Interval power(const Interval& base, const Interval& exponent) {
+        using namespace IntervalRounding;
+        if (base.isEmpty() || exponent.isEmpty()) return Interval::empty();
+
+        // Integer exponent: negative bases are fine
+        if (exponent.isPoint() && exponent.lower == std::trunc(exponent.lower) && std::abs(exponent.lower) <= 1e9) {
+            long long n = static_cast<long long>(exponent.lower);
+            if (n == 0) return Interval(1.0);
+            Interval magnitude = base;
+            if (n % 2 == 0) {
+                double low = base.contains(0) ? 0.0 : std::min(std::abs(base.lower), std::abs(base.upper));
+                magnitude = Interval(low, std::max(std::abs(base.lower), std::abs(base.upper)));
+            }
+            // x^n is monotone on magnitude; pow is accurate to about one ulp
+            auto f = [n](double x) { return std::pow(x, static_cast<double>(n > 0 ? n : -n)); };
+            Interval result = increasing(f, magnitude.lower, magnitude.upper);
+            if (n % 2 == 0 || magnitude.lower >= 0) result.lower = std::max(result.lower, 0.0);
+            return n > 0 ? result : Interval(1.0) / result;
+        }
+
+        // Real exponent: only non-negative bases are defined. x^y is monotone in
+        // each argument separately there, so the extremes are at the corners.
+        Interval defined = Interval::intersect(base, Interval(0.0, INF));
+        if (defined.isEmpty()) return Interval::empty();
+
+        double corners[4] = {
+            std::pow(defined.lower, exponent.lower), std::pow(defined.lower, exponent.upper),
+            std::pow(defined.upper, exponent.lower), std::pow(defined.upper, exponent.upper)
+        };
+        double lower = INF;
+        double upper = -INF;
+        for (double corner : corners) {
+            if (std::isnan(corner)) return Interval(0.0, INF); // inf ^ 0 style corners
+            lower = std::min(lower, corner);
+            upper = std::max(upper, corner);
+        }
+        return Interval(std::max(down(lower), 0.0), up(upper));
+    }
+
+    static bool applyFunction(std::string_view name, const Interval& x, Interval& result) {
+        using namespace IntervalRounding;
+        const double pi = 3.14159265358979323846;
+
+        if (x.isEmpty()) {
+            double unused = 0.0;
+            if (!NumericTraits<double>::applyFunction(name, 0.0, unused)) return false;
+            result = Interval::empty();
+            return true;
+        }
+
+        if (name == "sin" || name == "cos") {
+            bool isSin = name == "sin";
+            if (x.upper - x.lower >= 2 * pi || std::max(std::abs(x.lower), std::abs(x.upper)) > 1e8) {
+                result = Interval(-1.0, 1.0);
+                return true;
+            }
+            auto f = [isSin](double v) { return isSin ? std::sin(v) : std::cos(v); };
+            double a = f(x.lower);
+            double b = f(x.upper);
+            double lower = containsPhase(x.lower, x.upper, isSin ? -pi / 2 : pi, 2 * pi) ? -1.0 : down(std::min(a, b));
+            double upper = containsPhase(x.lower, x.upper, isSin ? pi / 2 : 0.0, 2 * pi) ? 1.0 : up(std::max(a, b));
+            result = Interval(std::max(lower, -1.0), std::min(upper, 1.0));
+        } else if (name == "tan") {
+            if (x.upper - x.lower >= pi || std::max(std::abs(x.lower), std::abs(x.upper)) > 1e8 ||
+                containsPhase(x.lower, x.upper, pi / 2, pi)) {
+                result = Interval::entire();
+            } else {
+                result = increasing([](double v) { return std::tan(v); }, x.lower, x.upper);
+            }
+        } else if (name == "log" || name == "ln" || name == "log10") {
+            // Defined on (0, inf): nothing left when x.upper <= 0, and a box
+            // reaching down to 0 is unbounded below
+            if (x.upper <= 0) {
+                result = Interval::empty();
+            } else {
+                bool base10 = name == "log10";
+                auto f = [base10](double v) { return base10 ? std::log10(v) : std::log(v); };
+                result = increasing(f, std::max(x.lower, 0.0), x.upper);
+            }
+        } else if (name == "sqrt") {
+            result = x.upper < 0 ? Interval::empty() : Interval(sqrtDown(std::max(x.lower, 0.0)), sqrtUp(x.upper));
+        } else if (name == "abs") {
+            double low = x.contains(0) ? 0.0 : std::min(std::abs(x.lower), std::abs(x.upper));
+            result = Interval(low, std::max(std::abs(x.lower), std::abs(x.upper)));
+        } else if (name == "floor") {
+            result = Interval(std::floor(x.lower), std::floor(x.upper));
+        } else if (name == "ceil") {
+            result = Interval(std::ceil(x.lower), std::ceil(x.upper));
+        } else if (name == "exp") {
+            result = increasing([](double v) { return std::exp(v); }, x.lower, x.upper);
+            result.lower = std::max(result.lower, 0.0);
+        } else if (name == "asin" || name == "acos") {
+            Interval defined = Interval::intersect(x, Interval(-1.0, 1.0));
+            if (defined.isEmpty()) {
+                result = Interval::empty();
+            } else if (name == "asin") {
+                result = increasing([](double v) { return std::asin(v); }, defined.lower, defined.upper);
+            } else {
+                result = -increasing([](double v) { return -std::acos(v); }, defined.lower, defined.upper);
+                result.lower = std::max(result.lower, 0.0);
+            }
+        } else if (name == "atan") {
+            result = increasing([](double v) { return std::atan(v); }, x.lower, x.upper);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool applyNaryFunction(std::string_view name, const Interval* x, Interval& result) {
+        using namespace IntervalRounding;
+        const double pi = 3.14159265358979323846;
+
+        size_t arity = naryBuiltinArity(name);
+        if (arity == 0) {
+            return false;
+        }
+        for (size_t k = 0; k < arity; ++k) {
+            if (x[k].isEmpty()) {
+                result = Interval::empty();
+                return true;
+            }
+        }
+
+        // min and max are increasing in both arguments, so they apply bound by bound
+        if (name == "min") {
+            result = Interval(std::min(x[0].lower, x[1].lower), std::min(x[0].upper, x[1].upper));
+        } else if (name == "max") {
+            result = Interval(std::max(x[0].lower, x[1].lower), std::max(x[0].upper, x[1].upper));
+        } else if (name == "clamp") {
+            Interval raised(std::max(x[0].lower, x[1].lower), std::max(x[0].upper, x[1].upper));
+            result = Interval(std::min(raised.lower, x[2].lower), std::min(raised.upper, x[2].upper));
+        } else if (name == "hypot") {
+            // Increasing in each magnitude
+            double low[2];
+            double high[2];
+            for (size_t k = 0; k < 2; ++k) {
+                low[k] = x[k].contains(0) ? 0.0 : std::min(std::abs(x[k].lower), std::abs(x[k].upper));
+                high[k] = std::max(std::abs(x[k].lower), std::abs(x[k].upper));
+            }
+            result = Interval(std::max(down(std::hypot(low[0], low[1])), 0.0), up(std::hypot(high[0], high[1])));
+        } else {
+            // atan2(y, x): a box that holds the origin or meets the cut along the
+            // negative x axis covers every angle; otherwise the angle is
+            // continuous on the box and its extremes are at the corners
+            const Interval& y = x[0];
+            const Interval& across = x[1];
+            Interval whole(-up(pi), up(pi));
+            if (y.contains(0) && across.lower < 0) {
+                result = whole;
+            } else {
+                double corners[4] = {
+                    std::atan2(y.lower, across.lower), std::atan2(y.lower, across.upper),
+                    std::atan2(y.upper, across.lower), std::atan2(y.upper, across.upper)
+                };
+                result = Interval(down(*std::min_element(corners, corners + 4)), up(*std::max_element(corners, corners + 4)));
+                result = Interval::intersect(result, whole);
+            }
+        }
+        return true;
+    }
+
+    static std::string toString(const Interval& x) {
+        if (x.isEmpty()) return "[empty]";
+        return "[" + NumericTraits<double>::toString(x.lower) + ", " + NumericTraits<double>::toString(x.upper) + "]";
+    }
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+
+// What happened to an object of a traced type
+enum class LifecycleEvent : uint8_t {
+    CONSTRUCT,
+    COPY_CONSTRUCT,
+    MOVE_CONSTRUCT,
+    COPY_ASSIGN,
+    MOVE_ASSIGN,
+    DESTRUCT
+};
+
+const size_t LIFECYCLE_EVENT_COUNT = 6;
+
+inline const char* lifecycleEventName(LifecycleEvent event) {
+    switch (event) {
+        case LifecycleEvent::CONSTRUCT: return "constructor";
+        case LifecycleEvent::COPY_CONSTRUCT: return "copy constructor";
+        case LifecycleEvent::MOVE_CONSTRUCT: return "move constructor";
+        case LifecycleEvent::COPY_ASSIGN: return "copy assignment";
+        case LifecycleEvent::MOVE_ASSIGN: return "move assignment";
+        case LifecycleEvent::DESTRUCT: return "destructor";
+    }
+    return "unknown event";
+}
+
+// Tracing policies for the Trace parameter of ArrayStack, PrefixArrayStack,
+// Node, LinkedStack, PrefixNode and PrefixLinkedStack. A policy provides
+//   static void record(const char* type, LifecycleEvent event);
+// and is chosen at compile time, so the default costs nothing.
+
+// Default: no output and no state; the calls compile away
+struct NoTrace {
+    static void record(const char*, LifecycleEvent) {}
+};
+
+// "LinkedStack copy constructor called", for demos that show the semantics
+struct PrintTrace {
+    static void record(const char* type, LifecycleEvent event) {
+        std::cout << type << ' ' << lifecycleEventName(event) << " called\n";
+    }
+};
+
+// Counts events, for tests. Each Tag has its own counters (CountTrace<int> for
+// containers of int, or a tag struct per test), so stacks traced with
+// different tags never add to each other's counts
+template<typename Tag>
+struct CountTrace {
+    static void record(const char*, LifecycleEvent event) {
+        counters()[static_cast<size_t>(event)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static size_t count(LifecycleEvent event) {
+        return counters()[static_cast<size_t>(event)].load(std::memory_order_relaxed);
+    }
+
+    // Copy constructions plus copy assignments
+    static size_t copies() {
+        return count(LifecycleEvent::COPY_CONSTRUCT) + count(LifecycleEvent::COPY_ASSIGN);
+    }
+
+    // Move constructions plus move assignments
+    static size_t moves() {
+        return count(LifecycleEvent::MOVE_CONSTRUCT) + count(LifecycleEvent::MOVE_ASSIGN);
+    }
+
+    static void reset() {
+        for (size_t i = 0; i < LIFECYCLE_EVENT_COUNT; ++i) {
+            counters()[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    static std::atomic<size_t>* counters() {
+        static std::atomic<size_t> instance[LIFECYCLE_EVENT_COUNT] = {};
+        return instance;
+    }
+};
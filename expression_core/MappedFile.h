@@ -0,0 +1,183 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file.
+// The mapping lives as long as the object, so views into it stay valid until then.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) : data_(nullptr), size_(0) {
+        open(filename);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    std::string_view view() const {
+        return std::string_view(data_, size_);
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+
+#ifdef _WIN32
+    void open(const std::string& filename) {
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot read size of file: " + filename);
+        }
+
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        if (size_ == 0) {
+            CloseHandle(file);
+            return; // Nothing to map
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            throw std::runtime_error("Cannot map file: " + filename);
+        }
+
+        data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (data_ == nullptr) {
+            throw std::runtime_error("Cannot map file: " + filename);
+        }
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+    }
+#else
+    void open(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file: " + filename);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read size of file: " + filename);
+        }
+
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            return; // mmap rejects zero-length mappings
+        }
+
+        void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            size_ = 0;
+            throw std::runtime_error("Cannot map file: " + filename);
+        }
+
+        // Lines are consumed front to back exactly once
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+            data_ = nullptr;
+        }
+        size_ = 0;
+    }
+#endif
+};
+
+// Splits a buffer into lines without copying.
+// The newline search goes through memchr, which the C runtime implements
+// with SIMD compares, so long lines are scanned many bytes at a time.
+class LineScanner {
+public:
+    explicit LineScanner(std::string_view buffer) : buffer_(buffer), pos_(0) {}
+
+    // Next line without its terminator ('\n' or "\r\n"); false at end of buffer
+    bool next(std::string_view& line) {
+        if (pos_ >= buffer_.size()) {
+            return false;
+        }
+
+        const char* start = buffer_.data() + pos_;
+        size_t remaining = buffer_.size() - pos_;
+        const void* found = std::memchr(start, '\n', remaining);
+
+        size_t length = found ? static_cast<size_t>(static_cast<const char*>(found) - start) : remaining;
+        pos_ += found ? length + 1 : length;
+
+        if (length > 0 && start[length - 1] == '\r') {
+            --length;
+        }
+        line = std::string_view(start, length);
+        return true;
+    }
+
+    // Byte offset of the first unread character
+    size_t position() const {
+        return pos_;
+    }
+
+private:
+    std::string_view buffer_;
+    size_t pos_;
+};
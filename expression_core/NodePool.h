@@ -0,0 +1,151 @@
+#pragma once
+#include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include "AllocationTracker.h"
+
+// Node allocators for the linked containers (LinkedStack, LinkedQueue,
+// LinkedDeque), chosen by their NodeAllocator template parameter. Each
+// container owns one allocator object and gets its nodes from it:
+//   template<typename... Args> Node* create(Args&&... args);
+//   void destroy(Node* node);
+// The allocator moves with the container's nodes and is never copied.
+
+// Default: nodes are carved out of slabs of node-sized slots, and destroyed
+// nodes go on a free list that create() reuses, so once a container has
+// reached its working size, push/pop pairs never call into malloc. Slabs
+// start at 16 slots and double up to 4096; they are all released together
+// when the pool (its container) is destroyed, so memory stays at the
+// container's high-water mark until then.
+template<typename Node>
+class NodePool {
+private:
+    union Slot {
+        Slot* next;     // While on the free list
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    static const size_t FIRST_SLAB = 16;
+    static const size_t LARGEST_SLAB = 4096;
+
+    Slot* freeList;
+    Slot* cursor;       // Unused slots of the newest slab
+    Slot* limit;
+    std::vector<std::pair<Slot*, size_t>> slabs;
+
+    void addSlab() {
+        size_t count = slabs.empty() ? FIRST_SLAB : slabs.back().second * 2;
+        if (count > LARGEST_SLAB) {
+            count = LARGEST_SLAB;
+        }
+        slabs.reserve(slabs.size() + 1);
+        Slot* slab = new Slot[count];
+        TRACK_ALLOCATION("NodePool slab", slab, count * sizeof(Slot));
+        slabs.emplace_back(slab, count);
+        cursor = slab;
+        limit = slab + count;
+    }
+
+    void releaseSlabs() {
+        for (const auto& slab : slabs) {
+            TRACK_DEALLOCATION("NodePool slab", slab.first, slab.second * sizeof(Slot));
+            delete[] slab.first;
+        }
+        slabs.clear();
+        freeList = nullptr;
+        cursor = nullptr;
+        limit = nullptr;
+    }
+
+    void* allocate() {
+        if (freeList != nullptr) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            return slot->storage;
+        }
+        if (cursor == limit) {
+            addSlab();
+        }
+        return (cursor++)->storage;
+    }
+
+    void release(void* memory) {
+        Slot* slot = static_cast<Slot*>(memory);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+public:
+    NodePool() : freeList(nullptr), cursor(nullptr), limit(nullptr) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    NodePool(NodePool&& other) noexcept
+        : freeList(other.freeList), cursor(other.cursor), limit(other.limit), slabs(std::move(other.slabs)) {
+        other.freeList = nullptr;
+        other.cursor = nullptr;
+        other.limit = nullptr;
+        other.slabs.clear();
+    }
+
+    // Every node of this pool must have been destroyed first
+    NodePool& operator=(NodePool&& other) noexcept {
+        if (this != &other) {
+            releaseSlabs();
+            freeList = other.freeList;
+            cursor = other.cursor;
+            limit = other.limit;
+            slabs = std::move(other.slabs);
+            other.freeList = nullptr;
+            other.cursor = nullptr;
+            other.limit = nullptr;
+            other.slabs.clear();
+        }
+        return *this;
+    }
+
+    ~NodePool() {
+        releaseSlabs();
+    }
+
+    template<typename... Args>
+    Node* create(Args&&... args) {
+        void* memory = allocate();
+        try {
+            return new (memory) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            release(memory);
+            throw;
+        }
+    }
+
+    void destroy(Node* node) {
+        node->~Node();
+        release(node);
+    }
+};
+
+// Every node from new and back to delete, as the containers did before pools
+template<typename Node>
+class HeapNodes {
+public:
+    HeapNodes() = default;
+    HeapNodes(const HeapNodes&) = delete;
+    HeapNodes& operator=(const HeapNodes&) = delete;
+    HeapNodes(HeapNodes&&) noexcept = default;
+    HeapNodes& operator=(HeapNodes&&) noexcept = default;
+
+    template<typename... Args>
+    Node* create(Args&&... args) {
+        Node* node = new Node(std::forward<Args>(args)...);
+        TRACK_ALLOCATION("Heap node", node, sizeof(Node));
+        return node;
+    }
+
+    void destroy(Node* node) {
+        TRACK_DEALLOCATION("Heap node", node, sizeof(Node));
+        delete node;
+    }
+};
@@ -0,0 +1,850 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cctype>
+#include <sstream>
+#include "ExpressionLexer.h"
+
+// Exact number types for the expression engines, and the NumericTraits
+// that tell the templated evaluator (NumericEngine.h) how to parse, divide,
+// raise to a power and apply builtins for each of them.
+
+// Arbitrary-precision signed integer, magnitude stored base 10^9, least significant limb first
+class BigInt {
+private:
+    static constexpr uint32_t BASE = 1000000000u;
+
+    std::vector<uint32_t> limbs; // Empty for zero
+    bool negative;
+
+    void trim() {
+        while (!limbs.empty() && limbs.back() == 0) {
+            limbs.pop_back();
+        }
+        if (limbs.empty()) {
+            negative = false;
+        }
+    }
+
+    static int compareMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        if (a.size() != b.size()) {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static std::vector<uint32_t> addMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        std::vector<uint32_t> result;
+        result.reserve(std::max(a.size(), b.size()) + 1);
+        uint32_t carry = 0;
+        for (size_t i = 0; i < a.size() || i < b.size() || carry != 0; ++i) {
+            uint64_t sum = static_cast<uint64_t>(carry) + (i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0);
+            result.push_back(static_cast<uint32_t>(sum % BASE));
+            carry = static_cast<uint32_t>(sum / BASE);
+        }
+        return result;
+    }
+
+    // a - b for |a| >= |b|
+    static std::vector<uint32_t> subtractMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        std::vector<uint32_t> result(a);
+        int64_t borrow = 0;
+        for (size_t i = 0; i < result.size(); ++i) {
+            int64_t difference = static_cast<int64_t>(result[i]) - borrow - (i < b.size() ? b[i] : 0);
+            borrow = difference < 0 ? 1 : 0;
+            result[i] = static_cast<uint32_t>(difference + borrow * BASE);
+        }
+        while (!result.empty() && result.back() == 0) {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    static std::vector<uint32_t> multiplyMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+        if (a.empty() || b.empty()) {
+            return std::vector<uint32_t>();
+        }
+        std::vector<uint64_t> wide(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size() || carry != 0; ++j) {
+                uint64_t current = wide[i + j] + carry + (j < b.size() ? static_cast<uint64_t>(a[i]) * b[j] : 0);
+                wide[i + j] = current % BASE;
+                carry = current / BASE;
+            }
+        }
+        std::vector<uint32_t> result(wide.begin(), wide.end());
+        while (!result.empty() && result.back() == 0) {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    static std::vector<uint32_t> multiplySmall(const std::vector<uint32_t>& a, uint32_t factor) {
+        std::vector<uint32_t> result;
+        if (factor == 0 || a.empty()) {
+            return result;
+        }
+        result.reserve(a.size() + 1);
+        uint64_t carry = 0;
+        for (uint32_t limb : a) {
+            uint64_t current = static_cast<uint64_t>(limb) * factor + carry;
+            result.push_back(static_cast<uint32_t>(current % BASE));
+            carry = current / BASE;
+        }
+        if (carry != 0) {
+            result.push_back(static_cast<uint32_t>(carry));
+        }
+        return result;
+    }
+
+    // Schoolbook long division; each quotient limb is found by a binary search
+    // bracketed by the leading limbs
+    static void divideMagnitude(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+                                std::vector<uint32_t>& quotient, std::vector<uint32_t>& remainder) {
+        quotient.assign(a.size(), 0);
+        remainder.clear();
+
+        if (b.size() == 1) {
+            uint64_t rest = 0;
+            for (size_t i = a.size(); i-- > 0;) {
+                uint64_t current = rest * BASE + a[i];
+                quotient[i] = static_cast<uint32_t>(current / b[0]);
+                rest = current % b[0];
+            }
+            if (rest != 0) {
+                remainder.push_back(static_cast<uint32_t>(rest));
+            }
+        } else {
+            for (size_t i = a.size(); i-- > 0;) {
+                remainder.insert(remainder.begin(), a[i]);
+                while (!remainder.empty() && remainder.back() == 0) {
+                    remainder.pop_back();
+                }
+
+                // Bracket the quotient limb using the leading limbs, then binary search
+                size_t n = b.size();
+                uint32_t low = 0;
+                uint32_t high = 0;
+                if (remainder.size() >= n) {
+                    uint64_t leading = remainder[n - 1] + (remainder.size() > n ? static_cast<uint64_t>(remainder[n]) * BASE : 0);
+                    low = static_cast<uint32_t>(std::min<uint64_t>(leading / (static_cast<uint64_t>(b[n - 1]) + 1), BASE - 1));
+                    high = static_cast<uint32_t>(std::min<uint64_t>(leading / b[n - 1], BASE - 1));
+                }
+                while (low < high) {
+                    uint32_t middle = low + (high - low + 1) / 2;
+                    if (compareMagnitude(multiplySmall(b, middle), remainder) <= 0) {
+                        low = middle;
+                    } else {
+                        high = middle - 1;
+                    }
+                }
+
+                quotient[i] = low;
+                if (low != 0) {
+                    remainder = subtractMagnitude(remainder, multiplySmall(b, low));
+                }
+            }
+        }
+
+        while (!quotient.empty() && quotient.back() == 0) {
+            quotient.pop_back();
+        }
+    }
+
+public:
+    BigInt() : negative(false) {}
+
+    BigInt(long long value) : negative(value < 0) {
+        unsigned long long magnitude = value < 0 ? 0ull - static_cast<unsigned long long>(value)
+                                                 : static_cast<unsigned long long>(value);
+        while (magnitude != 0) {
+            limbs.push_back(static_cast<uint32_t>(magnitude % BASE));
+            magnitude /= BASE;
+        }
+    }
+
+    // Optional sign followed by decimal digits
+    static BigInt parse(std::string_view text) {
+        BigInt result;
+        bool isNegative = false;
+        if (!text.empty() && (text[0] == '+' || text[0] == '-')) {
+            isNegative = text[0] == '-';
+            text.remove_prefix(1);
+        }
+        if (text.empty()) {
+            throw std::invalid_argument("Malformed integer");
+        }
+
+        for (size_t end = text.size(); end > 0;) {
+            size_t start = end >= 9 ? end - 9 : 0;
+            uint32_t limb = 0;
+            for (size_t i = start; i < end; ++i) {
+                if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+                    throw std::invalid_argument("Malformed integer");
+                }
+                limb = limb * 10 + static_cast<uint32_t>(text[i] - '0');
+            }
+            result.limbs.push_back(limb);
+            end = start;
+        }
+
+        result.negative = isNegative;
+        result.trim();
+        return result;
+    }
+
+    static BigInt pow10(unsigned exponent) {
+        BigInt result;
+        result.limbs.assign(exponent / 9 + 1, 0);
+        uint32_t top = 1;
+        for (unsigned i = 0; i < exponent % 9; ++i) {
+            top *= 10;
+        }
+        result.limbs.back() = top;
+        return result;
+    }
+
+    // Truncating division, like the built-in integer operators; remainder takes the dividend's sign
+    static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+        if (b.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        BigInt q;
+        BigInt r;
+        divideMagnitude(a.limbs, b.limbs, q.limbs, r.limbs);
+        q.negative = a.negative != b.negative;
+        r.negative = a.negative;
+        q.trim();
+        r.trim();
+        quotient = std::move(q);
+        remainder = std::move(r);
+    }
+
+    static BigInt gcd(BigInt a, BigInt b) {
+        a.negative = false;
+        b.negative = false;
+        while (!b.isZero()) {
+            BigInt quotient;
+            BigInt remainder;
+            divMod(a, b, quotient, remainder);
+            a = std::move(b);
+            b = std::move(remainder);
+        }
+        return a;
+    }
+
+    bool isZero() const {
+        return limbs.empty();
+    }
+
+    bool isNegative() const {
+        return negative;
+    }
+
+    bool isEven() const {
+        return limbs.empty() || limbs[0] % 2 == 0;
+    }
+
+    BigInt abs() const {
+        BigInt result(*this);
+        result.negative = false;
+        return result;
+    }
+
+    // Fits in a long long without overflow
+    bool toLongLong(long long& value) const {
+        if (limbs.size() > 3) {
+            return false;
+        }
+        // Three limbs reach 10^27, so every step is checked before it can wrap
+        unsigned long long magnitude = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            if (magnitude > (static_cast<unsigned long long>(INT64_MAX) - limbs[i]) / BASE) {
+                return false;
+            }
+            magnitude = magnitude * BASE + limbs[i];
+        }
+        value = negative ? -static_cast<long long>(magnitude) : static_cast<long long>(magnitude);
+        return true;
+    }
+
+    double toDouble() const {
+        double result = 0.0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            result = result * BASE + limbs[i];
+        }
+        return negative ? -result : result;
+    }
+
+    std::string toString() const {
+        if (limbs.empty()) {
+            return "0";
+        }
+        std::string result = negative ? "-" : "";
+        result += std::to_string(limbs.back());
+        for (size_t i = limbs.size() - 1; i-- > 0;) {
+            std::string part = std::to_string(limbs[i]);
+            result.append(9 - part.size(), '0');
+            result += part;
+        }
+        return result;
+    }
+
+    BigInt operator-() const {
+        BigInt result(*this);
+        if (!result.isZero()) {
+            result.negative = !result.negative;
+        }
+        return result;
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        BigInt result;
+        if (a.negative == b.negative) {
+            result.limbs = addMagnitude(a.limbs, b.limbs);
+            result.negative = a.negative;
+        } else if (compareMagnitude(a.limbs, b.limbs) >= 0) {
+            result.limbs = subtractMagnitude(a.limbs, b.limbs);
+            result.negative = a.negative;
+        } else {
+            result.limbs = subtractMagnitude(b.limbs, a.limbs);
+            result.negative = b.negative;
+        }
+        result.trim();
+        return result;
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        return a + (-b);
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        BigInt result;
+        result.limbs = multiplyMagnitude(a.limbs, b.limbs);
+        result.negative = a.negative != b.negative;
+        result.trim();
+        return result;
+    }
+
+    friend BigInt operator/(const BigInt& a, const BigInt& b) {
+        BigInt quotient;
+        BigInt remainder;
+        divMod(a, b, quotient, remainder);
+        return quotient;
+    }
+
+    friend BigInt operator%(const BigInt& a, const BigInt& b) {
+        BigInt quotient;
+        BigInt remainder;
+        divMod(a, b, quotient, remainder);
+        return remainder;
+    }
+
+    friend bool operator==(const BigInt& a, const BigInt& b) {
+        return a.negative == b.negative && a.limbs == b.limbs;
+    }
+
+    friend bool operator!=(const BigInt& a, const BigInt& b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const BigInt& a, const BigInt& b) {
+        if (a.negative != b.negative) {
+            return a.negative;
+        }
+        int order = compareMagnitude(a.limbs, b.limbs);
+        return a.negative ? order > 0 : order < 0;
+    }
+
+    friend bool operator>(const BigInt& a, const BigInt& b) { return b < a; }
+    friend bool operator<=(const BigInt& a, const BigInt& b) { return !(b < a); }
+    friend bool operator>=(const BigInt& a, const BigInt& b) { return !(a < b); }
+};
+
+// Split a decimal literal ("12.5", "-3", ".25") into an integer mantissa and a
+// power-of-ten exponent, so exact types never round through double
+inline void parseDecimalLiteral(std::string_view text, BigInt& mantissa, long long& exponent) {
+    if (!ExpressionLexer::isNumber(text)) {
+        throw std::invalid_argument("Malformed number: " + std::string(text));
+    }
+
+    std::string digits;
+    digits.reserve(text.size());
+    for (char c : text) {
+        if (c != '.') {
+            digits += c;
+        }
+    }
+
+    exponent = 0;
+    size_t dot = text.find('.');
+    if (dot != std::string_view::npos) {
+        exponent = -static_cast<long long>(text.size() - dot - 1);
+    }
+
+    mantissa = BigInt::parse(digits);
+}
+
+// Exact fraction num/den, always reduced with den > 0
+class Rational {
+private:
+    BigInt num;
+    BigInt den;
+
+    void normalize() {
+        if (den.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        if (den.isNegative()) {
+            num = -num;
+            den = -den;
+        }
+        BigInt divisor = BigInt::gcd(num, den);
+        if (divisor != BigInt(1) && !divisor.isZero()) {
+            num = num / divisor;
+            den = den / divisor;
+        }
+    }
+
+public:
+    Rational() : num(0), den(1) {}
+    Rational(long long value) : num(value), den(1) {}
+    Rational(BigInt numerator, BigInt denominator = BigInt(1)) : num(std::move(numerator)), den(std::move(denominator)) {
+        normalize();
+    }
+
+    static Rational parse(std::string_view text) {
+        BigInt mantissa;
+        long long exponent = 0;
+        parseDecimalLiteral(text, mantissa, exponent);
+        if (exponent >= 0) {
+            return Rational(mantissa * BigInt::pow10(static_cast<unsigned>(exponent)));
+        }
+        return Rational(mantissa, BigInt::pow10(static_cast<unsigned>(-exponent)));
+    }
+
+    const BigInt& numerator() const { return num; }
+    const BigInt& denominator() const { return den; }
+
+    bool isZero() const { return num.isZero(); }
+    bool isInteger() const { return den == BigInt(1); }
+
+    // Rounded toward zero
+    BigInt truncate() const {
+        return num / den;
+    }
+
+    double toDouble() const {
+        return num.toDouble() / den.toDouble();
+    }
+
+    std::string toString() const {
+        return isInteger() ? num.toString() : num.toString() + "/" + den.toString();
+    }
+
+    Rational operator-() const {
+        Rational result(*this);
+        result.num = -result.num;
+        return result;
+    }
+
+    friend Rational operator+(const Rational& a, const Rational& b) {
+        return Rational(a.num * b.den + b.num * a.den, a.den * b.den);
+    }
+
+    friend Rational operator-(const Rational& a, const Rational& b) {
+        return Rational(a.num * b.den - b.num * a.den, a.den * b.den);
+    }
+
+    friend Rational operator*(const Rational& a, const Rational& b) {
+        return Rational(a.num * b.num, a.den * b.den);
+    }
+
+    friend Rational operator/(const Rational& a, const Rational& b) {
+        if (b.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        return Rational(a.num * b.den, a.den * b.num);
+    }
+
+    friend bool operator==(const Rational& a, const Rational& b) {
+        return a.num == b.num && a.den == b.den;
+    }
+
+    friend bool operator!=(const Rational& a, const Rational& b) { return !(a == b); }
+    friend bool operator<(const Rational& a, const Rational& b) { return a.num * b.den < b.num * a.den; }
+    friend bool operator>(const Rational& a, const Rational& b) { return b < a; }
+    friend bool operator<=(const Rational& a, const Rational& b) { return !(b < a); }
+    friend bool operator>=(const Rational& a, const Rational& b) { return !(a < b); }
+};
+
+// Decimal fixed point with Digits fractional digits (value = raw / 10^Digits).
+// The raw value is a BigInt, so the range is unbounded; products and quotients
+// are rounded half away from zero back to Digits places.
+template<unsigned Digits>
+class FixedDecimal {
+private:
+    BigInt raw;
+
+    static const BigInt& scale() {
+        static const BigInt value = BigInt::pow10(Digits);
+        return value;
+    }
+
+    // numerator / denominator rounded half away from zero
+    static BigInt roundedQuotient(const BigInt& numerator, const BigInt& denominator) {
+        BigInt quotient;
+        BigInt remainder;
+        BigInt::divMod(numerator, denominator, quotient, remainder);
+        if (remainder.abs() * BigInt(2) >= denominator.abs()) {
+            quotient = quotient + BigInt(numerator.isNegative() != denominator.isNegative() ? -1 : 1);
+        }
+        return quotient;
+    }
+
+public:
+    FixedDecimal() {}
+    FixedDecimal(long long value) : raw(BigInt(value) * scale()) {}
+
+    static FixedDecimal fromRaw(BigInt value) {
+        FixedDecimal result;
+        result.raw = std::move(value);
+        return result;
+    }
+
+    static FixedDecimal parse(std::string_view text) {
+        BigInt mantissa;
+        long long exponent = 0;
+        parseDecimalLiteral(text, mantissa, exponent);
+        exponent += Digits;
+        if (exponent >= 0) {
+            return fromRaw(mantissa * BigInt::pow10(static_cast<unsigned>(exponent)));
+        }
+        return fromRaw(roundedQuotient(mantissa, BigInt::pow10(static_cast<unsigned>(-exponent))));
+    }
+
+    const BigInt& getRaw() const { return raw; }
+    bool isZero() const { return raw.isZero(); }
+
+    double toDouble() const {
+        return raw.toDouble() / scale().toDouble();
+    }
+
+    std::string toString() const {
+        std::string digits = raw.abs().toString();
+        if (digits.size() <= Digits) {
+            digits.insert(0, Digits - digits.size() + 1, '0');
+        }
+        if (Digits > 0) {
+            digits.insert(digits.size() - Digits, 1, '.');
+        }
+        return raw.isNegative() ? "-" + digits : digits;
+    }
+
+    FixedDecimal operator-() const {
+        return fromRaw(-raw);
+    }
+
+    friend FixedDecimal operator+(const FixedDecimal& a, const FixedDecimal& b) { return fromRaw(a.raw + b.raw); }
+    friend FixedDecimal operator-(const FixedDecimal& a, const FixedDecimal& b) { return fromRaw(a.raw - b.raw); }
+
+    friend FixedDecimal operator*(const FixedDecimal& a, const FixedDecimal& b) {
+        return fromRaw(roundedQuotient(a.raw * b.raw, scale()));
+    }
+
+    friend FixedDecimal operator/(const FixedDecimal& a, const FixedDecimal& b) {
+        if (b.isZero()) {
+            throw std::runtime_error("Division by zero");
+        }
+        return fromRaw(roundedQuotient(a.raw * scale(), b.raw));
+    }
+
+    friend bool operator==(const FixedDecimal& a, const FixedDecimal& b) { return a.raw == b.raw; }
+    friend bool operator!=(const FixedDecimal& a, const FixedDecimal& b) { return a.raw != b.raw; }
+    friend bool operator<(const FixedDecimal& a, const FixedDecimal& b) { return a.raw < b.raw; }
+    friend bool operator>(const FixedDecimal& a, const FixedDecimal& b) { return b < a; }
+    friend bool operator<=(const FixedDecimal& a, const FixedDecimal& b) { return !(b < a); }
+    friend bool operator>=(const FixedDecimal& a, const FixedDecimal& b) { return !(a < b); }
+};
+
+// x^n by repeated squaring, for n >= 0
+template<typename T>
+T powerBySquaring(T base, unsigned long long exponent) {
+    T result(1);
+    while (exponent != 0) {
+        if (exponent & 1) {
+            result = result * base;
+        }
+        exponent >>= 1;
+        if (exponent != 0) {
+            base = base * base;
+        }
+    }
+    return result;
+}
+
+// Integer exponent that an exact type can raise to, or throw
+inline long long exactExponent(const BigInt& exponent) {
+    long long value = 0;
+    if (!exponent.toLongLong(value) || value > 1000000 || value < -1000000) {
+        throw std::runtime_error("Exponent too large for exact arithmetic");
+    }
+    return value;
+}
+
+// Builtins of more than one argument, as the readers and ValueEvaluator define
+// them: min, max, atan2(y, x), hypot and clamp(x, low, high), which is
+// min(max(x, low), high). 0 for any other name.
+inline size_t naryBuiltinArity(std::string_view name) {
+    if (name == "min" || name == "max" || name == "atan2" || name == "hypot") return 2;
+    if (name == "clamp") return 3;
+    return 0;
+}
+
+// min, max and clamp for a type ordered by operator<, picking the operand
+// std::min and std::max would; false for the other n-ary builtins
+template<typename T>
+bool applyOrderedFunction(std::string_view name, const T* x, T& result) {
+    if (name == "min") {
+        result = x[1] < x[0] ? x[1] : x[0];
+    } else if (name == "max") {
+        result = x[0] < x[1] ? x[1] : x[0];
+    } else if (name == "clamp") {
+        const T& raised = x[0] < x[1] ? x[1] : x[0];
+        result = x[2] < raised ? x[2] : raised;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// How the engine treats a number type. Each specialization provides:
+//   parse(text)                  - exact value of a numeric literal
+//   divide/modulo/power(a, b)    - with the type's own domain rules
+//   applyFunction(name, x, r)    - builtins the type supports; false if unknown
+//   applyNaryFunction(name, x, r) - the same for naryBuiltinArity(name) arguments x[0], x[1], ...
+//   toString(x)
+template<typename T>
+struct NumericTraits;
+
+template<>
+struct NumericTraits<double> {
+    static double parse(std::string_view text) {
+        double value = 0.0;
+        if (!ExpressionLexer::parseNumber(text, value)) {
+            throw std::invalid_argument("Malformed number: " + std::string(text));
+        }
+        return value;
+    }
+
+    static double divide(double a, double b) {
+        if (b == 0) throw std::runtime_error("Division by zero");
+        return a / b;
+    }
+
+    static double modulo(double a, double b) {
+        if (b == 0) throw std::runtime_error("Modulo by zero");
+        return std::fmod(a, b);
+    }
+
+    static double power(double a, double b) {
+        return std::pow(a, b);
+    }
+
+    static bool applyFunction(std::string_view name, double x, double& result) {
+        if (name == "sin") result = std::sin(x);
+        else if (name == "cos") result = std::cos(x);
+        else if (name == "tan") result = std::tan(x);
+        else if (name == "log" || name == "ln") result = std::log(x);
+        else if (name == "log10") result = std::log10(x);
+        else if (name == "sqrt") result = std::sqrt(x);
+        else if (name == "abs") result = std::abs(x);
+        else if (name == "floor") result = std::floor(x);
+        else if (name == "ceil") result = std::ceil(x);
+        else if (name == "exp") result = std::exp(x);
+        else if (name == "asin") result = std::asin(x);
+        else if (name == "acos") result = std::acos(x);
+        else if (name == "atan") result = std::atan(x);
+        else return false;
+        return true;
+    }
+
+    static bool applyNaryFunction(std::string_view name, const double* x, double& result) {
+        if (name == "min") result = std::min(x[0], x[1]);
+        else if (name == "max") result = std::max(x[0], x[1]);
+        else if (name == "atan2") result = std::atan2(x[0], x[1]);
+        else if (name == "hypot") result = std::hypot(x[0], x[1]);
+        else if (name == "clamp") result = std::min(std::max(x[0], x[1]), x[2]);
+        else return false;
+        return true;
+    }
+
+    static std::string toString(double x) {
+        std::ostringstream stream;
+        stream << x;
+        return stream.str();
+    }
+};
+
+template<>
+struct NumericTraits<BigInt> {
+    static BigInt parse(std::string_view text) {
+        BigInt mantissa;
+        long long exponent = 0;
+        parseDecimalLiteral(text, mantissa, exponent);
+        if (exponent < 0) {
+            BigInt quotient;
+            BigInt remainder;
+            BigInt::divMod(mantissa, BigInt::pow10(static_cast<unsigned>(-exponent)), quotient, remainder);
+            if (!remainder.isZero()) {
+                throw std::invalid_argument("Not an integer: " + std::string(text));
+            }
+            return quotient;
+        }
+        return mantissa * BigInt::pow10(static_cast<unsigned>(exponent));
+    }
+
+    static BigInt divide(const BigInt& a, const BigInt& b) { return a / b; }
+
+    static BigInt modulo(const BigInt& a, const BigInt& b) {
+        if (b.isZero()) throw std::runtime_error("Modulo by zero");
+        return a % b;
+    }
+
+    static BigInt power(const BigInt& a, const BigInt& b) {
+        long long exponent = exactExponent(b);
+        if (exponent < 0) {
+            throw std::runtime_error("Negative exponent in integer arithmetic");
+        }
+        return powerBySquaring(a, static_cast<unsigned long long>(exponent));
+    }
+
+    static bool applyFunction(std::string_view name, const BigInt& x, BigInt& result) {
+        if (name == "abs") result = x.abs();
+        else if (name == "floor" || name == "ceil") result = x;
+        else return false;
+        return true;
+    }
+
+    // min, max and clamp; atan2 and hypot have no exact result
+    static bool applyNaryFunction(std::string_view name, const BigInt* x, BigInt& result) {
+        return applyOrderedFunction(name, x, result);
+    }
+
+    static std::string toString(const BigInt& x) {
+        return x.toString();
+    }
+};
+
+template<>
+struct NumericTraits<Rational> {
+    static Rational parse(std::string_view text) {
+        return Rational::parse(text);
+    }
+
+    static Rational divide(const Rational& a, const Rational& b) { return a / b; }
+
+    // a - b * trunc(a / b), matching fmod
+    static Rational modulo(const Rational& a, const Rational& b) {
+        if (b.isZero()) throw std::runtime_error("Modulo by zero");
+        return a - b * Rational((a / b).truncate());
+    }
+
+    static Rational power(const Rational& a, const Rational& b) {
+        if (!b.isInteger()) {
+            throw std::runtime_error("Non-integer exponent has no exact rational result");
+        }
+        long long exponent = exactExponent(b.numerator());
+        Rational result = powerBySquaring(a, static_cast<unsigned long long>(exponent < 0 ? -exponent : exponent));
+        return exponent < 0 ? Rational(1) / result : result;
+    }
+
+    static bool applyFunction(std::string_view name, const Rational& x, Rational& result) {
+        if (name == "abs") {
+            result = x < Rational(0) ? -x : x;
+        } else if (name == "floor" || name == "ceil") {
+            Rational truncated(x.truncate());
+            if (truncated != x) {
+                if (name == "floor" && x < Rational(0)) truncated = truncated - Rational(1);
+                if (name == "ceil" && x > Rational(0)) truncated = truncated + Rational(1);
+            }
+            result = truncated;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool applyNaryFunction(std::string_view name, const Rational* x, Rational& result) {
+        return applyOrderedFunction(name, x, result);
+    }
+
+    static std::string toString(const Rational& x) {
+        return x.toString();
+    }
+};
+
+template<unsigned Digits>
+struct NumericTraits<FixedDecimal<Digits>> {
+    typedef FixedDecimal<Digits> Value;
+
+    static Value parse(std::string_view text) {
+        return Value::parse(text);
+    }
+
+    static Value divide(const Value& a, const Value& b) { return a / b; }
+
+    static Value modulo(const Value& a, const Value& b) {
+        if (b.isZero()) throw std::runtime_error("Modulo by zero");
+        return Value::fromRaw(a.getRaw() % b.getRaw());
+    }
+
+    static Value power(const Value& a, const Value& b) {
+        BigInt quotient;
+        BigInt remainder;
+        BigInt::divMod(b.getRaw(), BigInt::pow10(Digits), quotient, remainder);
+        if (!remainder.isZero()) {
+            throw std::runtime_error("Non-integer exponent has no exact decimal result");
+        }
+        long long exponent = exactExponent(quotient);
+        Value result = powerBySquaring(a, static_cast<unsigned long long>(exponent < 0 ? -exponent : exponent));
+        return exponent < 0 ? Value(1) / result : result;
+    }
+
+    static bool applyFunction(std::string_view name, const Value& x, Value& result) {
+        if (name == "abs") {
+            result = x < Value(0) ? -x : x;
+        } else if (name == "floor" || name == "ceil") {
+            BigInt quotient;
+            BigInt remainder;
+            BigInt::divMod(x.getRaw(), BigInt::pow10(Digits), quotient, remainder);
+            if (!remainder.isZero()) {
+                if (name == "floor" && x.getRaw().isNegative()) quotient = quotient - BigInt(1);
+                if (name == "ceil" && !x.getRaw().isNegative()) quotient = quotient + BigInt(1);
+            }
+            result = Value::fromRaw(quotient * BigInt::pow10(Digits));
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static bool applyNaryFunction(std::string_view name, const Value* x, Value& result) {
+        return applyOrderedFunction(name, x, result);
+    }
+
+    static std::string toString(const Value& x) {
+        return x.toString();
+    }
+};
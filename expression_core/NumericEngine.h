@@ -0,0 +1,124 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <algorithm>
+#include "ExpressionLexer.h"
+#include "CompactToken.h"
+#include "Numeric.h"
+
+// Postfix/prefix evaluation with the number type T chosen at compile time.
+// Everything type-specific goes through NumericTraits<T>, so there is no virtual
+// dispatch and the double instantiation compiles to plain floating-point code.
+// Literals are parsed from their text by the traits, never through double, so
+// "0.1" is exactly 1/10 for Rational and FixedDecimal.
+//
+// Operators: + - * / ^ % (and div, pow, mod). Functions: whatever
+// NumericTraits<T>::applyFunction accepts, plus ExpressionLexer::UNARY_MINUS
+// (as emitted by ValueEvaluator::infixToPostfix), and the n-ary builtins (min, max, atan2,
+// hypot, clamp) that NumericTraits<T>::applyNaryFunction accepts. A builtin the
+// type cannot compute is an "Unsupported function" error.
+template<typename T>
+T evaluateNumeric(std::string_view expression, bool prefixOrder,
+                  const std::unordered_map<std::string, T>& variables = std::unordered_map<std::string, T>()) {
+    typedef NumericTraits<T> Traits;
+
+    std::vector<std::string_view> tokens;
+    ExpressionLexer::forEachToken(expression, [&](std::string_view token) {
+        tokens.push_back(token);
+    });
+
+    std::vector<T> operands;
+    operands.reserve(tokens.size());
+
+    for (size_t step = 0; step < tokens.size(); ++step) {
+        // Prefix is evaluated right to left, so its left operand ends up on top
+        std::string_view token = prefixOrder ? tokens[tokens.size() - 1 - step] : tokens[step];
+
+        if (ExpressionLexer::isNumber(token)) {
+            operands.push_back(Traits::parse(token));
+            continue;
+        }
+
+        OpCode op = binaryOpCode(token);
+        if (op != OpCode::INVALID) {
+            if (operands.size() < 2) {
+                throw std::invalid_argument("Insufficient operands for operator: " + std::string(token));
+            }
+
+            T top = std::move(operands.back());
+            operands.pop_back();
+            T& below = operands.back();
+            const T& left = prefixOrder ? top : below;
+            const T& right = prefixOrder ? below : top;
+
+            switch (op) {
+                case OpCode::ADD: below = left + right; break;
+                case OpCode::SUBTRACT: below = left - right; break;
+                case OpCode::MULTIPLY: below = left * right; break;
+                case OpCode::DIVIDE: below = Traits::divide(left, right); break;
+                case OpCode::POWER: below = Traits::power(left, right); break;
+                case OpCode::MODULO: below = Traits::modulo(left, right); break;
+                default: break;
+            }
+            continue;
+        }
+
+        if (token == ExpressionLexer::UNARY_MINUS) {
+            if (operands.empty()) {
+                throw std::invalid_argument("Insufficient operands for unary minus");
+            }
+            operands.back() = -operands.back();
+            continue;
+        }
+
+        if (!ExpressionLexer::isIdentifier(token)) {
+            throw std::invalid_argument("Unknown token: " + std::string(token));
+        }
+
+        std::string name(token);
+        auto it = variables.find(name);
+        if (it != variables.end()) {
+            operands.push_back(it->second);
+            continue;
+        }
+
+        size_t arity = naryBuiltinArity(token);
+        if (arity != 0) {
+            if (operands.size() < arity) {
+                throw std::invalid_argument("Insufficient operands for function: " + name);
+            }
+            // Arguments are the top arity operands, first argument on top for prefix
+            T* arguments = operands.data() + (operands.size() - arity);
+            if (prefixOrder) {
+                std::reverse(arguments, arguments + arity);
+            }
+            T result;
+            if (!Traits::applyNaryFunction(token, arguments, result)) {
+                throw std::invalid_argument("Unsupported function for this number type: " + name);
+            }
+            operands.erase(operands.end() - (arity - 1), operands.end());
+            operands.back() = std::move(result);
+            continue;
+        }
+
+        if (operands.empty()) {
+            throw std::invalid_argument("Unknown variable or missing operand: " + name);
+        }
+
+        T& argument = operands.back();
+        T result;
+        if (!Traits::applyFunction(token, argument, result)) {
+            throw std::invalid_argument("Undefined variable or unsupported function: " + name);
+        }
+        argument = std::move(result);
+    }
+
+    if (operands.size() != 1) {
+        throw std::invalid_argument(prefixOrder ? "Invalid prefix expression" : "Invalid postfix expression");
+    }
+
+    return std::move(operands.back());
+}
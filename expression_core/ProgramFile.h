@@ -0,0 +1,227 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "CompactToken.h"
+#include "MappedFile.h"
+
+// Versioned binary image of compiled programs (CompactToken streams).
+//
+// Layout, every field in the producer's byte order (recorded in the header):
+//   header   ProgramFileHeader, 48 bytes
+//   index    programCount + 1 uint64 token offsets; program i is [index[i], index[i + 1])
+//   tokens   tokenCount records laid out exactly like CompactToken, 16 bytes each
+//   names    symbolCount entries of uint32 length + bytes; token symbol ids
+//            are file-local indexes into this list
+//
+// Loading maps the file and reads only the header and the names; tokens are
+// executed straight from the mapping, so a program's pages are first touched
+// when it runs.
+struct ProgramFileHeader {
+    char magic[8];          // "EXPRPROG"
+    uint32_t version;
+    uint32_t byteOrder;     // 0x01020304 as stored by the producer
+    uint32_t flags;         // Bit 0: prefix order
+    uint32_t symbolCount;
+    uint64_t programCount;
+    uint64_t tokenCount;
+    uint64_t namesOffset;
+};
+
+static_assert(sizeof(ProgramFileHeader) == 48, "ProgramFileHeader layout is part of the file format");
+static_assert(std::is_trivially_copyable<CompactToken>::value && std::is_standard_layout<CompactToken>::value,
+              "CompactToken records are read straight from the mapped file");
+
+class ProgramFile {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    // Write programs (all prefix or all postfix) compiled against symbols
+    static void write(const std::string& filename, const std::vector<std::vector<CompactToken>>& programs,
+                      const SymbolTable& symbols, bool prefixOrder) {
+        // File-local ids in order of first use
+        std::unordered_map<uint32_t, uint32_t> localIds;
+        std::vector<std::string> names;
+        uint64_t tokenCount = 0;
+        for (const auto& program : programs) {
+            for (const CompactToken& token : program) {
+                if (isNamed(token) &&
+                    localIds.emplace(token.symbol, static_cast<uint32_t>(names.size())).second) {
+                    names.push_back(symbols.getName(token.symbol));
+                }
+            }
+            tokenCount += program.size();
+        }
+
+        ProgramFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.flags = prefixOrder ? PREFIX_FLAG : 0;
+        header.symbolCount = static_cast<uint32_t>(names.size());
+        header.programCount = programs.size();
+        header.tokenCount = tokenCount;
+        header.namesOffset = sizeof(header) + (programs.size() + 1) * sizeof(uint64_t) + tokenCount * sizeof(CompactToken);
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create file: " + filename);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        uint64_t offset = 0;
+        for (const auto& program : programs) {
+            out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            offset += program.size();
+        }
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+
+        for (const auto& program : programs) {
+            for (const CompactToken& token : program) {
+                // Field by field into a zeroed record, so padding bytes are deterministic
+                unsigned char record[sizeof(CompactToken)] = {};
+                uint32_t symbol = isNamed(token) ? localIds[token.symbol] : token.symbol;  // Jump distance otherwise
+                std::memcpy(record + offsetof(CompactToken, number), &token.number, sizeof(token.number));
+                std::memcpy(record + offsetof(CompactToken, symbol), &symbol, sizeof(symbol));
+                std::memcpy(record + offsetof(CompactToken, op), &token.op, sizeof(token.op));
+                std::memcpy(record + offsetof(CompactToken, arity), &token.arity, sizeof(token.arity));
+                out.write(reinterpret_cast<const char*>(record), sizeof(record));
+            }
+        }
+
+        for (const std::string& name : names) {
+            uint32_t length = static_cast<uint32_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+        }
+
+        if (!out) {
+            throw std::runtime_error("Cannot write file: " + filename);
+        }
+    }
+
+    // Map and validate a file written by write(); tokens are not read yet
+    explicit ProgramFile(const std::string& filename) : file(filename), index(nullptr), tokens(nullptr) {
+        const char* data = file.data();
+        size_t size = file.size();
+
+        if (size < sizeof(ProgramFileHeader)) {
+            throw std::runtime_error("Not a program file: " + filename);
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Not a program file: " + filename);
+        }
+        if (header.byteOrder != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Program file was written with a different byte order: " + filename);
+        }
+        if (header.version != VERSION) {
+            throw std::runtime_error("Unsupported program file version " + std::to_string(header.version) + ": " + filename);
+        }
+
+        uint64_t tokensOffset = sizeof(ProgramFileHeader) + (header.programCount + 1) * sizeof(uint64_t);
+        if (header.programCount > size / sizeof(uint64_t) || header.tokenCount > size / sizeof(CompactToken) ||
+            tokensOffset + header.tokenCount * sizeof(CompactToken) != header.namesOffset || header.namesOffset > size) {
+            throw std::runtime_error("Corrupt program file: " + filename);
+        }
+
+        index = reinterpret_cast<const uint64_t*>(data + sizeof(ProgramFileHeader));
+        tokens = reinterpret_cast<const CompactToken*>(data + tokensOffset);
+
+        size_t pos = static_cast<size_t>(header.namesOffset);
+        names.reserve(header.symbolCount);
+        for (uint32_t i = 0; i < header.symbolCount; ++i) {
+            uint32_t length = 0;
+            if (size - pos < sizeof(length)) {
+                throw std::runtime_error("Corrupt program file: " + filename);
+            }
+            std::memcpy(&length, data + pos, sizeof(length));
+            pos += sizeof(length);
+            if (size - pos < length) {
+                throw std::runtime_error("Corrupt program file: " + filename);
+            }
+            names.emplace_back(data + pos, length);
+            pos += length;
+        }
+    }
+
+    // Intern the file's names into symbols; evaluate() must then be given
+    // symbols or a copy of it
+    void bind(SymbolTable& symbols) {
+        symbolMap.clear();
+        symbolMap.reserve(names.size());
+        for (const std::string& name : names) {
+            symbolMap.push_back(symbols.intern(name));
+        }
+        bound = true;
+    }
+
+    double evaluate(size_t program, const SymbolTable& symbols) const {
+        if (!bound) {
+            throw std::logic_error("ProgramFile::bind must be called before evaluate");
+        }
+
+        const CompactToken* first = nullptr;
+        const CompactToken* last = nullptr;
+        getProgram(program, first, last);
+        if (isPrefixOrder()) {
+            // Prefix programs run right to left, like PrefixReader::evaluateCompiled
+            return evaluateCompactProgram(std::reverse_iterator<const CompactToken*>(last),
+                                          std::reverse_iterator<const CompactToken*>(first), symbols, true,
+                                          "Invalid prefix expression", symbolMap.data(), symbolMap.size());
+        }
+        return evaluateCompactProgram(first, last, symbols, false, "Invalid postfix expression",
+                                      symbolMap.data(), symbolMap.size());
+    }
+
+    // Token range of one program, straight from the mapping (ids are file-local)
+    void getProgram(size_t program, const CompactToken*& first, const CompactToken*& last) const {
+        if (program >= header.programCount) {
+            throw std::out_of_range("Program index out of range");
+        }
+        uint64_t begin = index[program];
+        uint64_t end = index[program + 1];
+        if (begin > end || end > header.tokenCount) {
+            throw std::runtime_error("Corrupt program file index");
+        }
+        first = tokens + begin;
+        last = tokens + end;
+    }
+
+    size_t getProgramCount() const {
+        return static_cast<size_t>(header.programCount);
+    }
+
+    bool isPrefixOrder() const {
+        return (header.flags & PREFIX_FLAG) != 0;
+    }
+
+    const std::vector<std::string>& getSymbolNames() const {
+        return names;
+    }
+
+private:
+    static constexpr const char* MAGIC = "EXPRPROG";
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    static constexpr uint32_t PREFIX_FLAG = 1u;
+
+    static bool isNamed(const CompactToken& token) {
+        return token.op == OpCode::VARIABLE || token.op == OpCode::FUNCTION || token.op == OpCode::CALL;
+    }
+
+    MappedFile file;
+    ProgramFileHeader header;
+    const uint64_t* index;
+    const CompactToken* tokens;
+    std::vector<std::string> names;
+    std::vector<uint32_t> symbolMap;    // File-local id -> SymbolTable id
+    bool bound = false;
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+#include "AllocationTracker.h"
+
+// Contiguous stack that keeps its first InlineCapacity elements inside the object
+// and only touches the heap once it grows past that. Evaluators use it as a
+// scratch operand stack, so typical expressions never allocate.
+template<typename T, size_t InlineCapacity = 32>
+class SmallStack {
+private:
+    T inlineData[InlineCapacity];
+    T* data;
+    size_t capacity;
+    size_t count;
+
+    void grow() {
+        size_t newCapacity = capacity * 2;
+        T* newData = new T[newCapacity];
+        TRACK_ALLOCATION("SmallStack spill", newData, newCapacity * sizeof(T));
+
+        for (size_t i = 0; i < count; ++i) {
+            newData[i] = std::move(data[i]);
+        }
+
+        if (data != inlineData) {
+            TRACK_DEALLOCATION("SmallStack spill", data, capacity * sizeof(T));
+            delete[] data;
+        }
+        data = newData;
+        capacity = newCapacity;
+    }
+
+public:
+    SmallStack() : data(inlineData), capacity(InlineCapacity), count(0) {}
+
+    SmallStack(const SmallStack&) = delete;
+    SmallStack& operator=(const SmallStack&) = delete;
+
+    ~SmallStack() {
+        if (data != inlineData) {
+            TRACK_DEALLOCATION("SmallStack spill", data, capacity * sizeof(T));
+            delete[] data;
+        }
+    }
+
+    void push(const T& value) {
+        if (count == capacity) {
+            grow();
+        }
+        data[count++] = value;
+    }
+
+    void push(T&& value) {
+        if (count == capacity) {
+            grow();
+        }
+        data[count++] = std::move(value);
+    }
+
+    T pop() {
+        if (count == 0) {
+            throw std::runtime_error("Cannot pop from empty stack");
+        }
+        return std::move(data[--count]);
+    }
+
+    T& top() {
+        if (count == 0) {
+            throw std::runtime_error("Cannot access top of empty stack");
+        }
+        return data[count - 1];
+    }
+
+    const T& top() const {
+        if (count == 0) {
+            throw std::runtime_error("Cannot access top of empty stack");
+        }
+        return data[count - 1];
+    }
+
+    // Element i positions below the top (0 = top); no bounds check
+    T& peek(size_t i) {
+        return data[count - 1 - i];
+    }
+
+    // Drop n elements from the top; no bounds check
+    void drop(size_t n) {
+        count -= n;
+    }
+
+    bool isEmpty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    void reserve(size_t newCapacity) {
+        while (capacity < newCapacity) {
+            grow();
+        }
+    }
+};
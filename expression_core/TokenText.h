@@ -0,0 +1,126 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+
+// Text of a reader token (Token, PrefixToken). Numbers, operators and most
+// names fit in the inline buffer, so making a token does not allocate; only
+// text longer than INLINE_CAPACITY goes to the heap. Reads as a string_view.
+class TokenText {
+public:
+    static constexpr size_t INLINE_CAPACITY = 24;
+
+    TokenText() noexcept : length(0) {}
+
+    TokenText(std::string_view text) : length(0) {
+        assign(text);
+    }
+
+    TokenText(const std::string& text) : TokenText(std::string_view(text)) {}
+    TokenText(const char* text) : TokenText(std::string_view(text)) {}
+
+    TokenText(const TokenText& other) : length(0) {
+        assign(other.view());
+    }
+
+    TokenText(TokenText&& other) noexcept : length(other.length) {
+        if (isInline()) {
+            std::memcpy(storage.local, other.storage.local, length);
+        } else {
+            storage.heap = other.storage.heap;
+            other.length = 0;
+        }
+    }
+
+    TokenText& operator=(const TokenText& other) {
+        if (this != &other) {
+            TokenText copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    TokenText& operator=(TokenText&& other) noexcept {
+        if (this != &other) {
+            release();
+            length = other.length;
+            if (isInline()) {
+                std::memcpy(storage.local, other.storage.local, length);
+            } else {
+                storage.heap = other.storage.heap;
+                other.length = 0;
+            }
+        }
+        return *this;
+    }
+
+    ~TokenText() {
+        release();
+    }
+
+    std::string_view view() const noexcept {
+        return std::string_view(isInline() ? storage.local : storage.heap, length);
+    }
+
+    operator std::string_view() const noexcept {
+        return view();
+    }
+
+    std::string str() const {
+        return std::string(view());
+    }
+
+    size_t size() const noexcept { return length; }
+    bool empty() const noexcept { return length == 0; }
+
+    friend bool operator==(const TokenText& a, std::string_view b) noexcept { return a.view() == b; }
+    friend bool operator!=(const TokenText& a, std::string_view b) noexcept { return a.view() != b; }
+
+    friend std::string operator+(std::string a, const TokenText& b) {
+        return a.append(b.view());
+    }
+
+    friend std::string operator+(const TokenText& a, const std::string& b) {
+        return a.str() + b;
+    }
+
+    friend std::string& operator+=(std::string& a, const TokenText& b) {
+        return a.append(b.view());
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const TokenText& text) {
+        return out << text.view();
+    }
+
+private:
+    size_t length;
+    union {
+        char local[INLINE_CAPACITY];
+        char* heap;
+    } storage;
+
+    bool isInline() const noexcept {
+        return length <= INLINE_CAPACITY;
+    }
+
+    void assign(std::string_view text) {
+        if (text.empty()) {
+            // Nothing to copy (data() may be null)
+        } else if (text.size() <= INLINE_CAPACITY) {
+            std::memcpy(storage.local, text.data(), text.size());
+        } else {
+            storage.heap = new char[text.size()];
+            std::memcpy(storage.heap, text.data(), text.size());
+        }
+        length = text.size();
+    }
+
+    void release() noexcept {
+        if (!isInline()) {
+            delete[] storage.heap;
+        }
+        length = 0;
+    }
+};
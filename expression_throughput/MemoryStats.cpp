@@ -0,0 +1,38 @@
+#include "MemoryStats.h"
+#include <new>
+#include <cstdlib>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+static size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+size_t allocationCount() {
+    return allocations;
+}
+
+long peakResidentKilobytes() {
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return usage.ru_maxrss;     // Kilobytes on Linux
+    }
+#endif
+    return 0;
+}
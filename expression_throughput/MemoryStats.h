@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+
+// Process-wide memory figures for the throughput benchmark. Linking
+// MemoryStats.cpp replaces the global operator new/delete with counting
+// versions; the counters are not synchronized, so count from one thread.
+size_t allocationCount();
+
+// Peak resident set size of the process in kilobytes, 0 where it cannot be read
+long peakResidentKilobytes();
@@ -0,0 +1,309 @@
+// Throughput of every expression engine over a generated corpus.
+// Build: g++ -std=c++17 -O2 main.cpp MemoryStats.cpp ../prefix_reader/PrefixReader.cpp ../postfix_reader/PostfixReader.cpp
+//        ../postfix_linkedStack/LinkedStack.cpp ../postfix_arrayStack/ArrayStack.cpp ../prefix_arrayStack/PrefixArrayStack.cpp
+//        ../value_eval/ValueEvaluator.cpp
+// Run:   ./main [scale]    (scale multiplies the repetitions, default 1)
+//
+// For each corpus and engine it prints expressions per second, nanoseconds per
+// token (operands and operators), heap allocations per evaluation and the
+// peak resident set size of the process so far. Built with -DTRACK_ALLOCATIONS
+// it also breaks each corpus's allocations down by container.
+#include "../prefix_reader/PrefixReader.h"
+#include "../postfix_reader/PostfixReader.h"
+#include "../postfix_linkedStack/LinkedStack.h"
+#include "../postfix_arrayStack/ArrayStack.h"
+#include "../prefix_arrayStack/PrefixArrayStack.h"
+#include "../value_eval/ValueEvaluator.h"
+#include "MemoryStats.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <cstdlib>
+#include <cmath>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+
+// One generated expression in the three notations the engines read
+struct CorpusExpression {
+    std::string infix;
+    std::string postfix;
+    std::string prefix;
+    double value;
+    size_t tokens;      // Operands and operators
+};
+
+struct Corpus {
+    std::string name;
+    std::vector<CorpusExpression> expressions;
+    size_t tokens = 0;
+    bool hasVariables = false;
+};
+
+const std::unordered_map<std::string, double> corpusVariables = {
+    {"x", 1.5}, {"y", 2.0}, {"z", 0.75}, {"w", 3.0}, {"u", 1.25}, {"v", 4.0}
+};
+
+// Random expression trees with + - * /, positive leaves and division only by
+// a leaf, so every expression evaluates without errors
+class ExpressionGenerator {
+public:
+    explicit ExpressionGenerator(unsigned seed) : random(seed) {}
+
+    // deep: every operator has a leaf on one side, so nesting depth equals
+    // the operator count; otherwise operators are split at random
+    CorpusExpression generate(size_t operators, bool deep, double variableShare) {
+        CorpusExpression expression;
+        expression.tokens = 2 * operators + 1;
+        expression.value = build(operators, deep, variableShare, expression.infix, expression.postfix, expression.prefix);
+        return expression;
+    }
+
+private:
+    std::mt19937 random;
+
+    size_t pick(size_t count) {
+        return std::uniform_int_distribution<size_t>(0, count - 1)(random);
+    }
+
+    double leaf(double variableShare, std::string& text) {
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(random) < variableShare) {
+            auto it = corpusVariables.begin();
+            std::advance(it, pick(corpusVariables.size()));
+            text = it->first;
+            return it->second;
+        }
+        static const char* const numbers[] = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "0.5", "1.25", "2.75"};
+        static const double values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0.5, 1.25, 2.75};
+        size_t index = pick(sizeof(values) / sizeof(values[0]));
+        text = numbers[index];
+        return values[index];
+    }
+
+    double build(size_t operators, bool deep, double variableShare,
+                 std::string& infix, std::string& postfix, std::string& prefix) {
+        if (operators == 0) {
+            double value = leaf(variableShare, infix);
+            postfix = infix;
+            prefix = infix;
+            return value;
+        }
+
+        size_t leftOperators = deep ? (pick(2) == 0 ? operators - 1 : 0) : pick(operators);
+        std::string leftInfix, leftPostfix, leftPrefix, rightInfix, rightPostfix, rightPrefix;
+        double left = build(leftOperators, deep, variableShare, leftInfix, leftPostfix, leftPrefix);
+        double right = build(operators - 1 - leftOperators, deep, variableShare, rightInfix, rightPostfix, rightPrefix);
+
+        // Mostly + and -, so long chains stay finite
+        static const char symbols[] = {'+', '-', '+', '-', '*', '/'};
+        char op = symbols[pick(sizeof(symbols))];
+        if (op == '/' && operators - 1 - leftOperators != 0) {
+            op = '*';
+        }
+
+        double value = 0.0;
+        switch (op) {
+            case '+': value = left + right; break;
+            case '-': value = left - right; break;
+            case '*': value = left * right; break;
+            default:  value = left / right; break;
+        }
+
+        infix = "(" + leftInfix + " " + op + " " + rightInfix + ")";
+        postfix = leftPostfix + " " + rightPostfix + " " + op;
+        prefix = std::string(1, op) + " " + leftPrefix + " " + rightPrefix;
+        return value;
+    }
+};
+
+Corpus makeCorpus(ExpressionGenerator& generator, const std::string& name, size_t count,
+                  size_t minOperators, size_t maxOperators, bool deep, double variableShare) {
+    Corpus corpus;
+    corpus.name = name;
+    corpus.hasVariables = variableShare > 0.0;
+    std::mt19937 sizes(static_cast<unsigned>(count * 31 + minOperators));
+    for (size_t i = 0; i < count; ++i) {
+        size_t operators = std::uniform_int_distribution<size_t>(minOperators, maxOperators)(sizes);
+        corpus.expressions.push_back(generator.generate(operators, deep, variableShare));
+        corpus.tokens += corpus.expressions.back().tokens;
+    }
+    return corpus;
+}
+
+// An engine evaluates expression i of the corpus it was prepared for
+struct Engine {
+    std::string name;
+    bool needsNumbersOnly;
+    // Prepare per-corpus state (compiled programs, ...) and return the evaluator
+    std::function<std::function<double(size_t)>(const Corpus&)> prepare;
+};
+
+std::vector<Engine> makeEngines(PostfixReader& postfixReader, PrefixReader& prefixReader) {
+    std::vector<Engine> engines;
+
+    engines.push_back({"ValueEvaluator (infix)", false, [](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus](size_t i) {
+            return ValueEvaluator::evaluate(corpus.expressions[i].infix, corpusVariables);
+        });
+    }});
+
+    engines.push_back({"PostfixLinkedEvaluator", false, [](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus](size_t i) {
+            return PostfixLinkedEvaluator::evaluate(corpus.expressions[i].postfix, corpusVariables);
+        });
+    }});
+
+    engines.push_back({"PostfixArrayEvaluator", true, [](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus](size_t i) {
+            return PostfixArrayEvaluator::evaluate(corpus.expressions[i].postfix);
+        });
+    }});
+
+    engines.push_back({"PrefixArrayEvaluator", false, [](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus](size_t i) {
+            return PrefixArrayEvaluator::evaluate(corpus.expressions[i].prefix, corpusVariables);
+        });
+    }});
+
+    engines.push_back({"PostfixReader (text)", false, [&postfixReader](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus, &postfixReader](size_t i) {
+            return postfixReader.evaluatePostfix(corpus.expressions[i].postfix);
+        });
+    }});
+
+    engines.push_back({"PostfixReader (compiled)", false, [&postfixReader](const Corpus& corpus) {
+        auto programs = std::make_shared<std::vector<std::vector<CompactToken>>>();
+        for (const CorpusExpression& expression : corpus.expressions) {
+            programs->push_back(postfixReader.compile(expression.postfix));
+        }
+        return std::function<double(size_t)>([programs, &postfixReader](size_t i) {
+            return postfixReader.evaluateCompiled((*programs)[i]);
+        });
+    }});
+
+    engines.push_back({"PrefixReader (text)", false, [&prefixReader](const Corpus& corpus) {
+        return std::function<double(size_t)>([&corpus, &prefixReader](size_t i) {
+            return prefixReader.evaluatePrefix(corpus.expressions[i].prefix);
+        });
+    }});
+
+    engines.push_back({"PrefixReader (compiled)", false, [&prefixReader](const Corpus& corpus) {
+        auto programs = std::make_shared<std::vector<std::vector<CompactToken>>>();
+        for (const CorpusExpression& expression : corpus.expressions) {
+            programs->push_back(prefixReader.compile(expression.prefix));
+        }
+        return std::function<double(size_t)>([programs, &prefixReader](size_t i) {
+            return prefixReader.evaluateCompiled((*programs)[i]);
+        });
+    }});
+
+    return engines;
+}
+
+bool sameValue(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return a == b || std::fabs(a - b) <= 1e-9 * std::max(std::fabs(a), std::fabs(b));
+}
+
+void runCorpus(const Corpus& corpus, const std::vector<Engine>& engines, double scale) {
+    std::cout << "\n=== " << corpus.name << ": " << corpus.expressions.size() << " expressions, "
+              << std::fixed << std::setprecision(1)
+              << static_cast<double>(corpus.tokens) / corpus.expressions.size() << " tokens each ===" << std::endl;
+    std::cout << std::left << std::setw(26) << "engine" << std::right
+              << std::setw(14) << "expr/s"
+              << std::setw(12) << "ns/token"
+              << std::setw(14) << "allocs/eval"
+              << std::setw(14) << "peak RSS KB" << std::endl;
+
+    // About two million tokens per engine and corpus at scale 1
+    size_t passes = std::max<size_t>(1, static_cast<size_t>(scale * 2000000.0 / corpus.tokens));
+
+    for (const Engine& engine : engines) {
+        if (engine.needsNumbersOnly && corpus.hasVariables) {
+            std::cout << std::left << std::setw(26) << engine.name << std::right << std::setw(14) << "n/a" << std::endl;
+            continue;
+        }
+
+        // Also a warm-up: anything an engine prints on first use comes before its row
+        std::function<double(size_t)> evaluate = engine.prepare(corpus);
+        size_t count = corpus.expressions.size();
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (!sameValue(evaluate(i), corpus.expressions[i].value)) {
+                ++mismatches;
+            }
+        }
+
+        double sink = 0.0;
+        size_t allocationsBefore = allocationCount();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass) {
+            for (size_t i = 0; i < count; ++i) {
+                sink += evaluate(i);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        size_t allocations = allocationCount() - allocationsBefore;
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << std::left << std::setw(26) << engine.name << std::right;
+        double evaluations = static_cast<double>(passes * count);
+        std::cout << std::setprecision(0) << std::setw(14) << evaluations / seconds
+                  << std::setprecision(2) << std::setw(12) << seconds * 1e9 / (static_cast<double>(passes) * corpus.tokens)
+                  << std::setw(14) << allocations / evaluations
+                  << std::setw(14) << peakResidentKilobytes();
+        if (mismatches != 0) {
+            std::cout << "  (" << mismatches << " wrong results)";
+        }
+        if (std::isnan(sink)) {
+            std::cout << "  (NaN)";
+        }
+        std::cout << std::endl;
+    }
+
+    if (AllocationTracker::enabled) {
+        std::cout << std::endl;
+        AllocationTracker::report(std::cout);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    double scale = argc > 1 ? std::atof(argv[1]) : 1.0;
+    if (!(scale > 0.0)) {
+        std::cerr << "Usage: " << argv[0] << " [scale]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "=== Expression Engine Throughput ===" << std::endl;
+
+    PostfixReader postfixReader;
+    PrefixReader prefixReader;
+    postfixReader.setVariables(corpusVariables);
+    prefixReader.setVariables(corpusVariables);
+
+    ExpressionGenerator generator(20240601u);
+    std::vector<Corpus> corpora;
+    corpora.push_back(makeCorpus(generator, "Short", 2000, 1, 6, false, 0.0));
+    corpora.push_back(makeCorpus(generator, "Long, flat", 100, 150, 250, false, 0.0));
+    corpora.push_back(makeCorpus(generator, "Long, deep", 100, 100, 150, true, 0.0));
+    corpora.push_back(makeCorpus(generator, "Variable-heavy", 1000, 10, 40, false, 0.8));
+
+    std::vector<Engine> engines = makeEngines(postfixReader, prefixReader);
+    for (const Corpus& corpus : corpora) {
+        AllocationTracker::reset();
+        runCorpus(corpus, engines, scale);
+    }
+    if (!AllocationTracker::enabled) {
+        std::cout << std::endl;
+        AllocationTracker::report(std::cout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "ArrayStack.h"
+#include "../expression_core/ExpressionLexer.h"
+#include <cctype>
+#include <cmath>
+
+double PostfixArrayEvaluator::evaluate(const std::string& postfix) {
+    EvalResult result = tryEvaluate(postfix);
+    if (!result) {
+        if (result.error == EvalError::DIVISION_BY_ZERO || result.error == EvalError::MODULO_BY_ZERO) {
+            throw std::runtime_error(evalErrorName(result.error));
+        }
+        throw std::invalid_argument(result.describe(postfix));
+    }
+    return result.value;
+}
+
+EvalResult PostfixArrayEvaluator::tryEvaluate(std::string_view postfix) {
+    // One operand stack per thread, reused by every call
+    static thread_local ArrayStack<double> operandStack(64);
+    operandStack.clear();
+
+    const char* begin = postfix.data();
+    const char* p = begin;
+    const char* end = p + postfix.size();
+
+    while (true) {
+        while (p < end && ExpressionLexer::isSpace(*p)) {
+            ++p;
+        }
+        if (p == end) {
+            break;
+        }
+
+        const char* tokenEnd = p;
+        while (tokenEnd < end && !ExpressionLexer::isSpace(*tokenEnd)) {
+            ++tokenEnd;
+        }
+        size_t offset = static_cast<size_t>(p - begin);
+
+        if (tokenEnd - p == 1 && isOperator(*p)) {
+            if (operandStack.size() < 2) {
+                return EvalResult::failure(EvalError::MISSING_OPERAND, offset);
+            }
+
+            double b = operandStack.pop();
+            double& a = operandStack.top();
+            if (b == 0 && (*p == '/' || *p == '%')) {
+                return EvalResult::failure(*p == '/' ? EvalError::DIVISION_BY_ZERO : EvalError::MODULO_BY_ZERO, offset);
+            }
+            a = performOperation(a, b, *p);
+        } else {
+            // Parse the number straight out of the input, no token string; the
+            // shared lexer rules, so every evaluator accepts the same numbers
+            std::string_view token(p, static_cast<size_t>(tokenEnd - p));
+            double value = 0.0;
+
+            if (!ExpressionLexer::isNumber(token)) {
+                return EvalResult::failure(EvalError::UNKNOWN_TOKEN, offset);
+            }
+            if (!ExpressionLexer::parseNumber(token, value)) {
+                return EvalResult::failure(EvalError::MALFORMED_NUMBER, offset);
+            }
+            operandStack.push(value);
+        }
+
+        p = tokenEnd;
+    }
+
+    if (operandStack.isEmpty()) {
+        return EvalResult::failure(EvalError::EMPTY_EXPRESSION, 0);
+    }
+    if (operandStack.size() != 1) {
+        return EvalResult::failure(EvalError::MISSING_OPERATOR, postfix.size());
+    }
+
+    return EvalResult::success(operandStack.top());
+}
+
+bool PostfixArrayEvaluator::isOperator(char c) {
+    switch (c) {
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '^':
+        case '%':
+            return true;
+        default:
+            return false;
+    }
+}
+
+double PostfixArrayEvaluator::performOperation(double a, double b, char op) {
+    switch (op) {
+        case '+': return a + b;
+        case '-': return a - b;
+        case '*': return a * b;
+        case '/':
+            if (b == 0) throw std::runtime_error("Division by zero");
+            return a / b;
+        case '^': return std::pow(a, b);
+        case '%':
+            if (b == 0) throw std::runtime_error("Modulo by zero");
+            return std::fmod(a, b);
+        default:
+            throw std::invalid_argument("Unknown operator: " + std::string(1, op));
+    }
+}
+
+std::string PostfixArrayEvaluator::infixToPostfix(const std::string& infix) {
+    static thread_local ArrayStack<char> operatorStack(32);
+    operatorStack.clear();
+
+    std::string result;
+    result.reserve(infix.size() * 2);
+
+    for (size_t i = 0; i < infix.length(); ++i) {
+        char c = infix[i];
+
+        if (ExpressionLexer::isSpace(c)) {
+            continue;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            // Add number to result
+            while (i < infix.length() && (std::isdigit(static_cast<unsigned char>(infix[i])) || infix[i] == '.')) {
+                result += infix[i];
+                ++i;
+            }
+            result += ' ';
+            --i; // Adjust for loop increment
+        } else if (std::isalpha(static_cast<unsigned char>(c))) {
+            // Add variable name to result
+            while (i < infix.length() && (std::isalnum(static_cast<unsigned char>(infix[i])) || infix[i] == '_')) {
+                result += infix[i];
+                ++i;
+            }
+            result += ' ';
+            --i; // Adjust for loop increment
+        } else if (c == '(') {
+            operatorStack.push(c);
+        } else if (c == ')') {
+            while (!operatorStack.isEmpty() && operatorStack.top() != '(') {
+                result += operatorStack.pop();
+                result += ' ';
+            }
+            if (!operatorStack.isEmpty()) {
+                operatorStack.pop(); // Remove '('
+            }
+        } else if (isOperator(c)) {
+            while (!operatorStack.isEmpty() &&
+                   operatorStack.top() != '(' &&
+                   ((isLeftAssociative(c) && getPrecedence(operatorStack.top()) >= getPrecedence(c)) ||
+                    (!isLeftAssociative(c) && getPrecedence(operatorStack.top()) > getPrecedence(c)))) {
+                result += operatorStack.pop();
+                result += ' ';
+            }
+            operatorStack.push(c);
+        }
+    }
+
+    while (!operatorStack.isEmpty()) {
+        result += operatorStack.pop();
+        result += ' ';
+    }
+
+    // Remove trailing space
+    if (!result.empty() && result.back() == ' ') {
+        result.pop_back();
+    }
+
+    return result;
+}
+
+int PostfixArrayEvaluator::getPrecedence(char op) {
+    switch (op) {
+        case '+':
+        case '-':
+            return 1;
+        case '*':
+        case '/':
+        case '%':
+            return 2;
+        case '^':
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+bool PostfixArrayEvaluator::isLeftAssociative(char op) {
+    return op != '^'; // Only exponentiation is right associative
+}
@@ -1,8 +1,13 @@
 #pragma once
 #include <stdexcept>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include "../expression_core/EvalResult.h"
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/LifecycleTrace.h"
 
-template<typename T>
+template<typename T, typename Trace = NoTrace>
 class ArrayStack {
 private:
     T* data;
@@ -12,11 +17,13 @@ private:
     void resize() {
         int new_capacity = capacity * 2;
         T* new_data = new T[new_capacity];
+        TRACK_ALLOCATION("ArrayStack buffer", new_data, static_cast<size_t>(new_capacity) * sizeof(T));
         
         for (int i = 0; i <= top_index; ++i) {
             new_data[i] = std::move(data[i]);
         }
         
+        TRACK_DEALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         delete[] data;
         data = new_data;
         capacity = new_capacity;
@@ -27,17 +34,19 @@ public:
     explicit ArrayStack(int initial_capacity = 10) 
         : capacity(initial_capacity), top_index(-1) {
         data = new T[capacity];
-        std::cout << "ArrayStack constructor called with capacity " << capacity << std::endl;
+        TRACK_ALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
+        Trace::record("ArrayStack", LifecycleEvent::CONSTRUCT);
     }
     
     // Copy constructor
     ArrayStack(const ArrayStack& other) 
         : capacity(other.capacity), top_index(other.top_index) {
         data = new T[capacity];
+        TRACK_ALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         for (int i = 0; i <= top_index; ++i) {
             data[i] = other.data[i];
         }
-        std::cout << "ArrayStack copy constructor called" << std::endl;
+        Trace::record("ArrayStack", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
@@ -46,29 +55,32 @@ public:
         other.data = nullptr;
         other.capacity = 0;
         other.top_index = -1;
-        std::cout << "ArrayStack move constructor called" << std::endl;
+        Trace::record("ArrayStack", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
     ArrayStack& operator=(const ArrayStack& other) {
         if (this != &other) {
+            TRACK_DEALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             delete[] data;
             
             capacity = other.capacity;
             top_index = other.top_index;
             data = new T[capacity];
+            TRACK_ALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             
             for (int i = 0; i <= top_index; ++i) {
                 data[i] = other.data[i];
             }
         }
-        std::cout << "ArrayStack copy assignment called" << std::endl;
+        Trace::record("ArrayStack", LifecycleEvent::COPY_ASSIGN);
         return *this;
     }
     
     // Move assignment
     ArrayStack& operator=(ArrayStack&& other) noexcept {
         if (this != &other) {
+            TRACK_DEALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             delete[] data;
             
             data = other.data;
@@ -79,14 +91,15 @@ public:
             other.capacity = 0;
             other.top_index = -1;
         }
-        std::cout << "ArrayStack move assignment called" << std::endl;
+        Trace::record("ArrayStack", LifecycleEvent::MOVE_ASSIGN);
         return *this;
     }
     
     // Destructor
     ~ArrayStack() {
+        TRACK_DEALLOCATION("ArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         delete[] data;
-        std::cout << "ArrayStack destructor called" << std::endl;
+        Trace::record("ArrayStack", LifecycleEvent::DESTRUCT);
     }
     
     // Stack operations
@@ -129,6 +142,11 @@ public:
         return top_index == -1;
     }
     
+    // Forget all elements but keep the storage for reuse
+    void clear() {
+        top_index = -1;
+    }
+    
     int size() const {
         return top_index + 1;
     }
@@ -146,10 +164,16 @@ public:
     }
 };
 
-// PostfixEvaluator using ArrayStack
+// PostfixEvaluator using ArrayStack.
+// Numeric expressions only (numbers and + - * / ^ %); tokens are parsed in place
+// and operands live in a per-thread ArrayStack that is reused across calls.
 class PostfixArrayEvaluator {
 public:
     static double evaluate(const std::string& postfix);
+    
+    // Same, without exceptions: an error code and the byte offset of the bad token
+    static EvalResult tryEvaluate(std::string_view postfix);
+    
     static bool isOperator(char c);
     static double performOperation(double a, double b, char op);
     static std::string infixToPostfix(const std::string& infix);
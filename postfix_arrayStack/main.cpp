@@ -0,0 +1,53 @@
+#include "ArrayStack.h"
+#include <iostream>
+#include <vector>
+#include <string>
+
+void testEvaluation() {
+    std::cout << "\n=== Postfix Evaluation (ArrayStack) ===" << std::endl;
+    
+    std::vector<std::string> expressions = {
+        "3 4 +",
+        "5 1 2 + 4 * + 3 -",
+        "2 3 ^ 1 -",
+        "-2.5 4 *",
+        "10 0 /",
+        "1 +",
+        "1 2",
+        "1 x +"
+    };
+    
+    for (const std::string& expr : expressions) {
+        std::cout << expr << " = ";
+        try {
+            std::cout << PostfixArrayEvaluator::evaluate(expr) << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+        }
+    }
+}
+
+void testInfixToPostfix() {
+    std::cout << "\n=== Infix to Postfix ===" << std::endl;
+    
+    std::vector<std::string> expressions = {
+        "3 + 4 * 2",
+        "(1 + 2) * (3 - 4)",
+        "2 ^ 3 ^ 2",
+        "10 / 2 - 3"
+    };
+    
+    for (const std::string& expr : expressions) {
+        std::string postfix = PostfixArrayEvaluator::infixToPostfix(expr);
+        std::cout << expr << " -> " << postfix << " = " << PostfixArrayEvaluator::evaluate(postfix) << std::endl;
+    }
+}
+
+int main() {
+    std::cout << "=== Postfix ArrayStack Evaluator ===" << std::endl;
+    
+    testEvaluation();
+    testInfixToPostfix();
+    
+    return 0;
+}
@@ -32,57 +32,64 @@ double PostfixLinkedEvaluator::evaluate(const std::string& postfix, const std::u
 double PostfixLinkedEvaluator::evaluateAdvanced(const std::string& postfix, 
                                               const std::unordered_map<std::string, double>& variables,
                                               const std::unordered_map<std::string, std::function<double(double)>>& functions) {
-    if (!isValidPostfix(postfix)) {
-        throw std::invalid_argument("Invalid postfix expression");
-    }
-    
-    LinkedStack<double> operandStack;
-    std::vector<std::string> tokens = tokenize(postfix);
+    // Validation is folded into evaluation: each check below is what
+    // validateWithDetails would report, so the input is scanned only once.
+    SmallStack<double> operandStack;
+    ExpressionLexer lexer(postfix);
+    std::string_view tokenView;
+    size_t position = 0;
     
-    for (const std::string& token : tokens) {
-        if (isNumber(token)) {
-            operandStack.push(std::stod(token));
-        } else if (isVariable(token)) {
-            auto it = variables.find(token);
-            if (it != variables.end()) {
-                operandStack.push(it->second);
-            } else {
-                throw std::runtime_error("Undefined variable: " + token);
-            }
-        } else if (isFunction(token)) {
-            if (operandStack.isEmpty()) {
-                throw std::runtime_error("Insufficient operands for function: " + token);
-            }
-            
-            double arg = operandStack.pop();
-            
-            auto funcIt = functions.find(token);
-            if (funcIt != functions.end()) {
-                double result = funcIt->second(arg);
-                operandStack.push(result);
-            } else {
-                throw std::runtime_error("Unknown function: " + token);
-            }
-        } else if (isOperator(token)) {
+    while (lexer.next(tokenView)) {
+        ++position;
+        
+        double number = 0.0;
+        if (isNumber(tokenView) && ExpressionLexer::parseNumber(tokenView, number)) {
+            operandStack.push(number);
+            continue;
+        }
+        
+        if (isOperator(tokenView)) {
             if (operandStack.size() < 2) {
-                throw std::runtime_error("Insufficient operands for operator: " + token);
+                throw std::invalid_argument("Insufficient operands for operator '" + std::string(tokenView) +
+                                            "' at position " + std::to_string(position));
             }
             
             double b = operandStack.pop();
-            double a = operandStack.pop();
+            double& a = operandStack.top();
+            a = performOperation(a, b, tokenView);
+            continue;
+        }
+        
+        std::string token(tokenView);
+        auto funcIt = functions.find(token);
+        if (funcIt != functions.end()) {
+            if (operandStack.isEmpty()) {
+                throw std::invalid_argument("Insufficient operands for function '" + token +
+                                            "' at position " + std::to_string(position));
+            }
             
-            double result = performOperation(a, b, token);
-            operandStack.push(result);
+            double& arg = operandStack.top();
+            arg = funcIt->second(arg);
+        } else if (isVariable(token)) {
+            auto it = variables.find(token);
+            if (it == variables.end()) {
+                throw std::runtime_error("Undefined variable: " + token + " at position " + std::to_string(position));
+            }
+            operandStack.push(it->second);
         } else {
-            throw std::invalid_argument("Unknown token: " + token);
+            throw std::invalid_argument("Invalid token '" + token + "' at position " + std::to_string(position));
         }
     }
     
+    if (position == 0) {
+        throw std::invalid_argument("Empty expression");
+    }
     if (operandStack.size() != 1) {
-        throw std::runtime_error("Invalid postfix expression: incorrect number of operands");
+        throw std::invalid_argument("Expression has " + std::to_string(operandStack.size()) +
+                                    " unprocessed operands (should be exactly 1)");
     }
     
-    return operandStack.pop();
+    return operandStack.top();
 }
 
 std::string PostfixLinkedEvaluator::infixToPostfix(const std::string& infix) {
@@ -150,38 +157,39 @@ bool PostfixLinkedEvaluator::isValidPostfix(const std::string& postfix) {
 }
 
 bool PostfixLinkedEvaluator::validateWithDetails(const std::string& postfix, std::string& errorMessage) {
-    std::vector<std::string> tokens = tokenize(postfix);
-    
-    if (tokens.empty()) {
-        errorMessage = "Empty expression";
-        return false;
-    }
-    
+    ExpressionLexer lexer(postfix);
+    std::string_view token;
+    size_t position = 0;
     int operandCount = 0;
     
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        const std::string& token = tokens[i];
+    while (lexer.next(token)) {
+        ++position;
         
         if (isNumber(token) || isVariable(token)) {
             operandCount++;
         } else if (isFunction(token)) {
             if (operandCount < 1) {
-                errorMessage = "Insufficient operands for function '" + token + "' at position " + std::to_string(i + 1);
+                errorMessage = "Insufficient operands for function '" + std::string(token) + "' at position " + std::to_string(position);
                 return false;
             }
             // Function doesn't change operand count (1 in, 1 out)
         } else if (isOperator(token)) {
             if (operandCount < 2) {
-                errorMessage = "Insufficient operands for operator '" + token + "' at position " + std::to_string(i + 1);
+                errorMessage = "Insufficient operands for operator '" + std::string(token) + "' at position " + std::to_string(position);
                 return false;
             }
             operandCount--; // Two operands become one result
         } else {
-            errorMessage = "Invalid token '" + token + "' at position " + std::to_string(i + 1);
+            errorMessage = "Invalid token '" + std::string(token) + "' at position " + std::to_string(position);
             return false;
         }
     }
     
+    if (position == 0) {
+        errorMessage = "Empty expression";
+        return false;
+    }
+    
     if (operandCount != 1) {
         if (operandCount == 0) {
             errorMessage = "Expression evaluates to no result";
@@ -200,49 +208,21 @@ bool PostfixLinkedEvaluator::isOperator(char c) {
     return c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%';
 }
 
-bool PostfixLinkedEvaluator::isOperator(const std::string& token) {
+bool PostfixLinkedEvaluator::isOperator(std::string_view token) {
     return token == "+" || token == "-" || token == "*" || token == "/" || 
            token == "^" || token == "%" || token == "mod" || token == "div" || token == "pow";
 }
 
-bool PostfixLinkedEvaluator::isFunction(const std::string& token) {
-    return builtInFunctions.find(token) != builtInFunctions.end();
+bool PostfixLinkedEvaluator::isFunction(std::string_view token) {
+    return builtInFunctions.find(std::string(token)) != builtInFunctions.end();
 }
 
-bool PostfixLinkedEvaluator::isNumber(const std::string& token) {
-    if (token.empty()) return false;
-    
-    size_t start = 0;
-    if (token[0] == '-' || token[0] == '+') {
-        start = 1;
-        if (token.length() == 1) return false;
-    }
-    
-    bool hasDecimal = false;
-    for (size_t i = start; i < token.length(); ++i) {
-        if (token[i] == '.') {
-            if (hasDecimal) return false;
-            hasDecimal = true;
-        } else if (!std::isdigit(token[i])) {
-            return false;
-        }
-    }
-    
-    return true;
+bool PostfixLinkedEvaluator::isNumber(std::string_view token) {
+    return ExpressionLexer::isNumber(token);
 }
 
-bool PostfixLinkedEvaluator::isVariable(const std::string& token) {
-    if (token.empty() || !std::isalpha(token[0])) {
-        return false;
-    }
-    
-    for (char c : token) {
-        if (!std::isalnum(c) && c != '_') {
-            return false;
-        }
-    }
-    
-    return !isFunction(token) && !isOperator(token);
+bool PostfixLinkedEvaluator::isVariable(std::string_view token) {
+    return ExpressionLexer::isIdentifier(token) && !isFunction(token) && !isOperator(token);
 }
 
 int PostfixLinkedEvaluator::getPrecedence(char op) {
@@ -265,7 +245,7 @@ bool PostfixLinkedEvaluator::isLeftAssociative(char op) {
     return op != '^'; // Only exponentiation is right associative
 }
 
-double PostfixLinkedEvaluator::performOperation(double a, double b, const std::string& op) {
+double PostfixLinkedEvaluator::performOperation(double a, double b, std::string_view op) {
     if (op == "+") return a + b;
     if (op == "-") return a - b;
     if (op == "*") return a * b;
@@ -279,7 +259,7 @@ double PostfixLinkedEvaluator::performOperation(double a, double b, const std::s
         return std::fmod(a, b);
     }
     
-    throw std::invalid_argument("Unknown operator: " + op);
+    throw std::invalid_argument("Unknown operator: " + std::string(op));
 }
 
 double PostfixLinkedEvaluator::performFunction(const std::string& func, double arg) {
@@ -290,18 +270,6 @@ double PostfixLinkedEvaluator::performFunction(const std::string& func, double a
     throw std::invalid_argument("Unknown function: " + func);
 }
 
-std::vector<std::string> PostfixLinkedEvaluator::tokenize(const std::string& expression) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(expression);
-    std::string token;
-    
-    while (iss >> token) {
-        tokens.push_back(token);
-    }
-    
-    return tokens;
-}
-
 std::string PostfixLinkedEvaluator::removeSpaces(const std::string& str) {
     std::string result;
     for (char c : str) {
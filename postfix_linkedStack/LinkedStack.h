@@ -6,13 +6,19 @@
 #include <cmath>
 #include <unordered_map>
 #include <functional>
+#include <string_view>
+#include "../expression_core/ExpressionLexer.h"
+#include "../expression_core/SmallStack.h"
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/LifecycleTrace.h"
+#include "../expression_core/NodePool.h"
 
 // Node class for linked list with proper copy/move semantics
-template<typename T>
+template<typename T, typename Trace = NoTrace>
 class Node {
 public:
     T data;
-    Node<T>* next;
+    Node* next;
     
     // Constructors
     Node() : data{}, next(nullptr) {}
@@ -21,20 +27,20 @@ public:
     
     // Copy constructor
     Node(const Node& other) : data(other.data), next(nullptr) {
-        std::cout << "Node copy constructor called" << std::endl;
+        Trace::record("Node", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
     Node(Node&& other) noexcept : data(std::move(other.data)), next(other.next) {
         other.next = nullptr;
-        std::cout << "Node move constructor called" << std::endl;
+        Trace::record("Node", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
     Node& operator=(const Node& other) {
         if (this != &other) {
             data = other.data;
-            std::cout << "Node copy assignment called" << std::endl;
+            Trace::record("Node", LifecycleEvent::COPY_ASSIGN);
         }
         return *this;
     }
@@ -44,7 +50,7 @@ public:
         if (this != &other) {
             data = std::move(other.data);
             other.next = nullptr;
-            std::cout << "Node move assignment called" << std::endl;
+            Trace::record("Node", LifecycleEvent::MOVE_ASSIGN);
         }
         return *this;
     }
@@ -53,12 +59,15 @@ public:
     ~Node() = default;
 };
 
-// Linked Stack implementation with copy/move semantics
-template<typename T>
+// Linked Stack implementation with copy/move semantics.
+// Nodes come from a NodePool by default, so steady-state push/pop does not
+// allocate; pass HeapNodes to get each node from new/delete.
+template<typename T, typename Trace = NoTrace, template<typename> class NodeAllocator = NodePool>
 class LinkedStack {
 private:
-    Node<T>* top_;
+    Node<T, Trace>* top_;
     size_t size_;
+    NodeAllocator<Node<T, Trace>> nodes_;
     
     void copyFrom(const LinkedStack& other) {
         if (other.top_ == nullptr) {
@@ -67,12 +76,12 @@ private:
             return;
         }
         
-        top_ = new Node<T>(other.top_->data);
-        Node<T>* current = top_;
-        Node<T>* otherCurrent = other.top_->next;
+        top_ = nodes_.create(other.top_->data);
+        Node<T, Trace>* current = top_;
+        Node<T, Trace>* otherCurrent = other.top_->next;
         
         while (otherCurrent != nullptr) {
-            current->next = new Node<T>(otherCurrent->data);
+            current->next = nodes_.create(otherCurrent->data);
             current = current->next;
             otherCurrent = otherCurrent->next;
         }
@@ -82,9 +91,9 @@ private:
     
     void clear() {
         while (top_ != nullptr) {
-            Node<T>* temp = top_;
+            Node<T, Trace>* temp = top_;
             top_ = top_->next;
-            delete temp;
+            nodes_.destroy(temp);
         }
         size_ = 0;
     }
@@ -92,21 +101,21 @@ private:
 public:
     // Default constructor
     LinkedStack() : top_(nullptr), size_(0) {
-        std::cout << "LinkedStack default constructor called" << std::endl;
+        Trace::record("LinkedStack", LifecycleEvent::CONSTRUCT);
     }
     
     // Copy constructor
     LinkedStack(const LinkedStack& other) : top_(nullptr), size_(0) {
         copyFrom(other);
-        std::cout << "LinkedStack copy constructor called" << std::endl;
+        Trace::record("LinkedStack", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
     LinkedStack(LinkedStack&& other) noexcept 
-        : top_(other.top_), size_(other.size_) {
+        : top_(other.top_), size_(other.size_), nodes_(std::move(other.nodes_)) {
         other.top_ = nullptr;
         other.size_ = 0;
-        std::cout << "LinkedStack move constructor called" << std::endl;
+        Trace::record("LinkedStack", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
@@ -114,7 +123,7 @@ public:
         if (this != &other) {
             clear();
             copyFrom(other);
-            std::cout << "LinkedStack copy assignment called" << std::endl;
+            Trace::record("LinkedStack", LifecycleEvent::COPY_ASSIGN);
         }
         return *this;
     }
@@ -125,9 +134,10 @@ public:
             clear();
             top_ = other.top_;
             size_ = other.size_;
+            nodes_ = std::move(other.nodes_);
             other.top_ = nullptr;
             other.size_ = 0;
-            std::cout << "LinkedStack move assignment called" << std::endl;
+            Trace::record("LinkedStack", LifecycleEvent::MOVE_ASSIGN);
         }
         return *this;
     }
@@ -135,19 +145,19 @@ public:
     // Destructor
     ~LinkedStack() {
         clear();
-        std::cout << "LinkedStack destructor called" << std::endl;
+        Trace::record("LinkedStack", LifecycleEvent::DESTRUCT);
     }
     
     // Stack operations
     void push(const T& value) {
-        Node<T>* newNode = new Node<T>(value);
+        Node<T, Trace>* newNode = nodes_.create(value);
         newNode->next = top_;
         top_ = newNode;
         ++size_;
     }
     
     void push(T&& value) {
-        Node<T>* newNode = new Node<T>(std::move(value));
+        Node<T, Trace>* newNode = nodes_.create(std::move(value));
         newNode->next = top_;
         top_ = newNode;
         ++size_;
@@ -158,10 +168,10 @@ public:
             throw std::runtime_error("Cannot pop from empty stack");
         }
         
-        Node<T>* temp = top_;
+        Node<T, Trace>* temp = top_;
         T value = std::move(top_->data);
         top_ = top_->next;
-        delete temp;
+        nodes_.destroy(temp);
         --size_;
         
         return value;
@@ -191,7 +201,7 @@ public:
     
     void display() const {
         std::cout << "Stack (top to bottom): ";
-        Node<T>* current = top_;
+        Node<T, Trace>* current = top_;
         while (current != nullptr) {
             std::cout << current->data << " ";
             current = current->next;
@@ -209,7 +219,9 @@ public:
     // Evaluate with variables
     static double evaluate(const std::string& postfix, const std::unordered_map<std::string, double>& variables);
     
-    // Evaluate with functions and variables
+    // Evaluate with functions and variables.
+    // Single pass: validates while evaluating on a contiguous stack and throws
+    // with the 1-based token position of the first error.
     static double evaluateAdvanced(const std::string& postfix, 
                                  const std::unordered_map<std::string, double>& variables,
                                  const std::unordered_map<std::string, std::function<double(double)>>& functions);
@@ -226,18 +238,17 @@ public:
 private:
     // Helper functions
     static bool isOperator(char c);
-    static bool isOperator(const std::string& token);
-    static bool isFunction(const std::string& token);
-    static bool isNumber(const std::string& token);
-    static bool isVariable(const std::string& token);
+    static bool isOperator(std::string_view token);
+    static bool isFunction(std::string_view token);
+    static bool isNumber(std::string_view token);
+    static bool isVariable(std::string_view token);
     
     static int getPrecedence(char op);
     static bool isLeftAssociative(char op);
     
-    static double performOperation(double a, double b, const std::string& op);
+    static double performOperation(double a, double b, std::string_view op);
     static double performFunction(const std::string& func, double arg);
     
-    static std::vector<std::string> tokenize(const std::string& expression);
     static std::string removeSpaces(const std::string& str);
     
     // Built-in functions
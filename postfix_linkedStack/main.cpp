@@ -8,7 +8,7 @@ void testCopyMoveSemantics() {
     std::cout << "\n=== Testing Copy/Move Semantics ===" << std::endl;
     
     std::cout << "\n1. Creating original stack:" << std::endl;
-    LinkedStack<int> original;
+    LinkedStack<int, PrintTrace> original;
     original.push(1);
     original.push(2);
     original.push(3);
@@ -16,25 +16,25 @@ void testCopyMoveSemantics() {
     original.display();
     
     std::cout << "\n2. Copy constructor:" << std::endl;
-    LinkedStack<int> copied(original);
+    LinkedStack<int, PrintTrace> copied(original);
     std::cout << "Copied: ";
     copied.display();
     
     std::cout << "\n3. Move constructor:" << std::endl;
-    LinkedStack<int> moved(std::move(copied));
+    LinkedStack<int, PrintTrace> moved(std::move(copied));
     std::cout << "Moved: ";
     moved.display();
     std::cout << "Copied after move: ";
     copied.display();
     
     std::cout << "\n4. Copy assignment:" << std::endl;
-    LinkedStack<int> assigned;
+    LinkedStack<int, PrintTrace> assigned;
     assigned = original;
     std::cout << "Assigned: ";
     assigned.display();
     
     std::cout << "\n5. Move assignment:" << std::endl;
-    LinkedStack<int> moveAssigned;
+    LinkedStack<int, PrintTrace> moveAssigned;
     moveAssigned = std::move(assigned);
     std::cout << "Move assigned: ";
     moveAssigned.display();
@@ -42,6 +42,33 @@ void testCopyMoveSemantics() {
     assigned.display();
 }
 
+void testCountedCopies() {
+    std::cout << "\n=== Counting Copies and Moves ===" << std::endl;
+
+    // Counted separately: each element type has its own CountTrace
+    using IntTrace = CountTrace<int>;
+    using DoubleTrace = CountTrace<double>;
+    IntTrace::reset();
+    DoubleTrace::reset();
+
+    LinkedStack<int, IntTrace> ints;
+    ints.push(1);
+    ints.push(2);
+    ints.push(3);
+    LinkedStack<int, IntTrace> intCopy(ints);
+    LinkedStack<int, IntTrace> intMoved(std::move(intCopy));
+
+    LinkedStack<double, DoubleTrace> doubles;
+    doubles.push(1.5);
+    LinkedStack<double, DoubleTrace> doubleCopy;
+    doubleCopy = doubles;
+
+    std::cout << "int stacks:    " << IntTrace::count(LifecycleEvent::CONSTRUCT) << " constructed, "
+              << IntTrace::copies() << " copies, " << IntTrace::moves() << " moves" << std::endl;
+    std::cout << "double stacks: " << DoubleTrace::count(LifecycleEvent::CONSTRUCT) << " constructed, "
+              << DoubleTrace::copies() << " copies, " << DoubleTrace::moves() << " moves" << std::endl;
+}
+
 void testBasicStackOperations() {
     std::cout << "\n=== Testing Basic Stack Operations ===" << std::endl;
     
@@ -293,6 +320,7 @@ int main() {
     
     try {
         testCopyMoveSemantics();
+        testCountedCopies();
         testBasicStackOperations();
         testPostfixEvaluation();
         testVariablesAndFunctions();
@@ -1,4 +1,5 @@
 #include "PostfixReader.h"
+#include "../expression_core/MappedFile.h"
 #include <iostream>
 #include <algorithm>
 #include <cctype>
@@ -12,20 +13,19 @@ PostfixReader::PostfixReader() {
     initializeBuiltInFunctions();
 }
 
-std::vector<Token> PostfixReader::readFromString(const std::string& expression) {
+std::vector<Token> PostfixReader::readFromString(std::string_view expression) {
     std::vector<Token> tokens;
-    std::vector<std::string> tokenStrings = splitIntoTokens(expression);
-    
-    for (const std::string& tokenStr : tokenStrings) {
-        if (!tokenStr.empty()) {
-            Token token = parseToken(tokenStr);
-            tokens.push_back(token);
-        }
-    }
-    
+    readFromString(expression, tokens);
     return tokens;
 }
 
+void PostfixReader::readFromString(std::string_view expression, std::vector<Token>& tokens) {
+    tokens.clear();
+    ExpressionLexer::forEachToken(expression, [&](std::string_view tokenStr) {
+        TRACK_PUSH_BACK("PostfixReader tokens", tokens, makeToken(tokenStr));
+    });
+}
+
 std::vector<Token> PostfixReader::readFromFile(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -46,22 +46,41 @@ std::vector<Token> PostfixReader::readFromFile(const std::string& filename) {
 
 std::vector<std::vector<Token>> PostfixReader::readMultipleFromFile(const std::string& filename) {
     std::vector<std::vector<Token>> allExpressions;
-    std::vector<std::string> lines = readLinesFromFile(filename);
+    forEachExpressionInFile(filename, [&](const std::vector<Token>& tokens, size_t) {
+        allExpressions.push_back(tokens);
+    });
     
-    for (const std::string& line : lines) {
-        std::string trimmedLine = trim(line);
-        if (!trimmedLine.empty() && trimmedLine[0] != '#') { // Skip empty lines and comments
-            std::vector<Token> tokens = readFromString(trimmedLine);
-            if (!tokens.empty()) {
-                allExpressions.push_back(tokens);
-            }
+    return allExpressions;
+}
+
+size_t PostfixReader::forEachExpressionInFile(const std::string& filename,
+                                       const std::function<void(const std::vector<Token>& tokens, size_t lineNumber)>& callback) {
+    MappedFile file(filename);
+    LineScanner scanner(file.view());
+    
+    std::vector<Token> tokens;
+    std::string_view line;
+    size_t lineNumber = 0;
+    size_t expressionCount = 0;
+    
+    while (scanner.next(line)) {
+        ++lineNumber;
+        std::string_view trimmedLine = ExpressionLexer::trim(line);
+        if (trimmedLine.empty() || trimmedLine[0] == '#') { // Skip empty lines and comments
+            continue;
+        }
+        
+        readFromString(trimmedLine, tokens);
+        if (!tokens.empty()) {
+            callback(tokens, lineNumber);
+            ++expressionCount;
         }
     }
     
-    return allExpressions;
+    return expressionCount;
 }
 
-bool PostfixReader::validatePostfixExpression(const std::vector<Token>& tokens) {
+bool PostfixReader::validatePostfixExpression(const std::vector<Token>& tokens) const {
     if (tokens.empty()) {
         return false;
     }
@@ -82,12 +101,14 @@ bool PostfixReader::validatePostfixExpression(const std::vector<Token>& tokens)
                 operandCount--; // Two operands become one result
                 break;
                 
-            case TokenType::FUNCTION:
-                if (operandCount < 1) {
+            case TokenType::FUNCTION: {
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity == 0 || operandCount < arity) {
                     return false; // Not enough operands for function
                 }
-                // Function takes one operand and produces one result (no change in count)
+                operandCount -= arity - 1; // Its arguments become one result
                 break;
+            }
                 
             case TokenType::INVALID:
                 return false;
@@ -97,7 +118,7 @@ bool PostfixReader::validatePostfixExpression(const std::vector<Token>& tokens)
     return operandCount == 1; // Should have exactly one result
 }
 
-std::string PostfixReader::tokensToString(const std::vector<Token>& tokens) {
+std::string PostfixReader::tokensToString(const std::vector<Token>& tokens) const {
     std::string result;
     for (size_t i = 0; i < tokens.size(); ++i) {
         result += tokens[i].value;
@@ -109,27 +130,10 @@ std::string PostfixReader::tokensToString(const std::vector<Token>& tokens) {
 }
 
 Token PostfixReader::parseToken(const std::string& tokenStr) {
-    std::string cleanToken = trim(tokenStr);
-    
-    if (cleanToken.empty()) {
-        return Token(TokenType::INVALID, cleanToken);
-    }
-    
-    TokenType type = determineTokenType(cleanToken);
-    
-    if (type == TokenType::NUMBER) {
-        try {
-            double value = std::stod(cleanToken);
-            return Token(type, cleanToken, value);
-        } catch (const std::exception&) {
-            return Token(TokenType::INVALID, cleanToken);
-        }
-    }
-    
-    return Token(type, cleanToken);
+    return makeToken(ExpressionLexer::trim(tokenStr));
 }
 
-std::string PostfixReader::getTokenTypeString(TokenType type) {
+std::string PostfixReader::getTokenTypeString(TokenType type) const {
     switch (type) {
         case TokenType::NUMBER: return "NUMBER";
         case TokenType::OPERATOR: return "OPERATOR";
@@ -141,33 +145,41 @@ std::string PostfixReader::getTokenTypeString(TokenType type) {
 }
 
 void PostfixReader::setVariable(const std::string& name, double value) {
-    variables[name] = value;
+    symbols.setVariable(name, value);
 }
 
 void PostfixReader::setVariables(const std::unordered_map<std::string, double>& vars) {
     for (const auto& pair : vars) {
-        variables[pair.first] = pair.second;
+        symbols.setVariable(pair.first, pair.second);
     }
 }
 
 void PostfixReader::setFunction(const std::string& name, std::function<double(double)> func) {
-    functions[name] = func;
+    symbols.setFunction(name, std::move(func));
 }
 
-double PostfixReader::getVariable(const std::string& name) const {
-    auto it = variables.find(name);
-    if (it != variables.end()) {
-        return it->second;
+void PostfixReader::setFunction(const std::string& name, NaryFunction func, size_t arity) {
+    symbols.setFunction(name, func, arity);
+}
+
+void PostfixReader::defineFunction(const std::string& name, const std::vector<std::string>& parameters, std::string_view body) {
+    defineInlineFunction(symbols, name, parameters, body, false);
+}
+
+double PostfixReader::getVariable(std::string_view name) const {
+    double value = 0.0;
+    if (symbols.findVariable(name, value)) {
+        return value;
     }
-    throw std::runtime_error("Undefined variable: " + name);
+    throw std::runtime_error("Undefined variable: " + std::string(name));
 }
 
-bool PostfixReader::isValidOperator(const std::string& token) const {
+bool PostfixReader::isValidOperator(std::string_view token) const {
     return std::find(validOperators.begin(), validOperators.end(), token) != validOperators.end();
 }
 
 bool PostfixReader::isValidFunction(const std::string& token) const {
-    return functions.find(token) != functions.end();
+    return symbols.getCallArity(token) != 0;
 }
 
 bool PostfixReader::isValidVariable(const std::string& token) const {
@@ -235,13 +247,21 @@ bool PostfixReader::validateWithDetails(const std::vector<Token>& tokens, std::s
                 operandCount--;
                 break;
                 
-            case TokenType::FUNCTION:
-                if (operandCount < 1) {
+            case TokenType::FUNCTION: {
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity == 0) {
+                    errorMessage = "Unknown function '" + token.value + 
+                                 "' at position " + std::to_string(i + 1);
+                    return false;
+                }
+                if (operandCount < arity) {
                     errorMessage = "Insufficient operands for function '" + token.value + 
                                  "' at position " + std::to_string(i + 1);
                     return false;
                 }
+                operandCount -= arity - 1;
                 break;
+            }
                 
             case TokenType::INVALID:
                 errorMessage = "Invalid token '" + token.value + "' at position " + std::to_string(i + 1);
@@ -285,9 +305,14 @@ std::pair<int, int> PostfixReader::countOperandsAndOperators(const std::vector<T
             case TokenType::OPERATOR:
                 operators++;
                 break;
-            case TokenType::FUNCTION:
-                // Functions don't change the operand/operator balance
+            case TokenType::FUNCTION: {
+                // A function of n arguments joins n operands, like n - 1 binary operators
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity > 1) {
+                    operators += arity - 1;
+                }
                 break;
+            }
             case TokenType::INVALID:
                 break;
         }
@@ -296,66 +321,139 @@ std::pair<int, int> PostfixReader::countOperandsAndOperators(const std::vector<T
     return std::make_pair(operands, operators);
 }
 
-// Private helper functions
-void PostfixReader::initializeBuiltInFunctions() {
-    functions["sin"] = [](double x) { return std::sin(x); };
-    functions["cos"] = [](double x) { return std::cos(x); };
-    functions["tan"] = [](double x) { return std::tan(x); };
-    functions["log"] = [](double x) { return std::log(x); };
-    functions["ln"] = [](double x) { return std::log(x); };
-    functions["log10"] = [](double x) { return std::log10(x); };
-    functions["sqrt"] = [](double x) { return std::sqrt(x); };
-    functions["abs"] = [](double x) { return std::abs(x); };
-    functions["floor"] = [](double x) { return std::floor(x); };
-    functions["ceil"] = [](double x) { return std::ceil(x); };
-    functions["exp"] = [](double x) { return std::exp(x); };
-    functions["asin"] = [](double x) { return std::asin(x); };
-    functions["acos"] = [](double x) { return std::acos(x); };
-    functions["atan"] = [](double x) { return std::atan(x); };
-}
-
-bool PostfixReader::isNumber(const std::string& str) const {
-    if (str.empty()) return false;
-    
-    size_t start = 0;
-    if (str[0] == '-' || str[0] == '+') {
-        start = 1;
-        if (str.length() == 1) return false;
+double PostfixReader::evaluatePostfix(const std::vector<Token>& tokens) {
+    if (!validatePostfixExpression(tokens)) {
+        throw std::invalid_argument("Invalid postfix expression");
     }
     
-    bool hasDecimal = false;
-    for (size_t i = start; i < str.length(); ++i) {
-        if (str[i] == '.') {
-            if (hasDecimal) return false;
-            hasDecimal = true;
-        } else if (!std::isdigit(str[i])) {
-            return false;
+    std::vector<double> operands;
+    operands.reserve(tokens.size());
+    
+    for (const Token& token : tokens) {
+        switch (token.type) {
+            case TokenType::NUMBER:
+                operands.push_back(token.numericValue);
+                break;
+                
+            case TokenType::VARIABLE:
+                operands.push_back(getVariable(token.value));
+                break;
+                
+            case TokenType::FUNCTION: {
+                uint32_t id = 0;
+                size_t arity = symbols.find(token.value, id) ? symbols.getCallArity(id) : 0;
+                if (arity == 0) {
+                    throw std::runtime_error("Unknown function: " + token.value);
+                }
+                double arguments[MAX_FUNCTION_ARITY];
+                std::copy(operands.end() - arity, operands.end(), arguments);
+                operands.resize(operands.size() - arity + 1);
+                operands.back() = callAnyFunction(symbols, id, arguments, false);
+                break;
+            }
+            
+            case TokenType::OPERATOR: {
+                double right = operands.back();
+                operands.pop_back();
+                operands.back() = applyOperator(token.value, operands.back(), right);
+                break;
+            }
+            
+            case TokenType::INVALID:
+                throw std::runtime_error("Invalid token: " + token.value);
         }
     }
     
-    return true;
+    return operands.back();
 }
 
-bool PostfixReader::isValidIdentifier(const std::string& str) const {
-    if (str.empty() || !std::isalpha(str[0])) {
-        return false;
-    }
-    
-    for (char c : str) {
-        if (!std::isalnum(c) && c != '_') {
-            return false;
-        }
+double PostfixReader::evaluatePostfix(const std::string& postfix) {
+    // Names are looked up, not interned: one-off text must not grow the symbol table
+    std::vector<CompactToken> program;
+    std::vector<std::string_view> unknownNames;
+    compileCompactProgramReadOnly(postfix, symbols, false, program, unknownNames);
+    lowerConditionals(program, false);
+    return evaluateCompactProgram(program.begin(), program.end(), symbols, false, "Invalid postfix expression",
+                                  nullptr, 0, &unknownNames);
+}
+
+std::vector<CompactToken> PostfixReader::compile(std::string_view expression) {
+    std::vector<CompactToken> program;
+    compile(expression, program);
+    return program;
+}
+
+void PostfixReader::compile(std::string_view expression, std::vector<CompactToken>& program) {
+    compileCompactProgram(expression, symbols, false, program);
+    lowerConditionals(program, false);
+}
+
+double PostfixReader::evaluateCompiled(const std::vector<CompactToken>& program) const {
+    return evaluateCompactProgram(program.begin(), program.end(), symbols, false, "Invalid postfix expression");
+}
+
+EvalResult PostfixReader::tryEvaluatePostfix(std::string_view postfix) const {
+    return tryEvaluateSymbolic(postfix, symbols, false);
+}
+
+void PostfixReader::saveCompiled(const std::string& filename, const std::vector<std::vector<CompactToken>>& programs) const {
+    ProgramFile::write(filename, programs, symbols, false);
+}
+
+ProgramFile PostfixReader::loadCompiled(const std::string& filename) {
+    ProgramFile file(filename);
+    if (file.isPrefixOrder()) {
+        throw std::invalid_argument("Not a postfix program file: " + filename);
     }
-    
-    return true;
+    file.bind(symbols);
+    return file;
 }
 
-TokenType PostfixReader::determineTokenType(const std::string& token) {
+double PostfixReader::evaluateCompiled(const ProgramFile& file, size_t program) const {
+    return file.evaluate(program, symbols);
+}
+
+const SymbolTable& PostfixReader::getSymbols() const {
+    return symbols;
+}
+
+// Private helper functions
+void PostfixReader::initializeBuiltInFunctions() {
+    symbols.setFunction("sin", [](const double* x) { return std::sin(x[0]); }, 1);
+    symbols.setFunction("cos", [](const double* x) { return std::cos(x[0]); }, 1);
+    symbols.setFunction("tan", [](const double* x) { return std::tan(x[0]); }, 1);
+    symbols.setFunction("log", [](const double* x) { return std::log(x[0]); }, 1);
+    symbols.setFunction("ln", [](const double* x) { return std::log(x[0]); }, 1);
+    symbols.setFunction("log10", [](const double* x) { return std::log10(x[0]); }, 1);
+    symbols.setFunction("sqrt", [](const double* x) { return std::sqrt(x[0]); }, 1);
+    symbols.setFunction("abs", [](const double* x) { return std::abs(x[0]); }, 1);
+    symbols.setFunction("floor", [](const double* x) { return std::floor(x[0]); }, 1);
+    symbols.setFunction("ceil", [](const double* x) { return std::ceil(x[0]); }, 1);
+    symbols.setFunction("exp", [](const double* x) { return std::exp(x[0]); }, 1);
+    symbols.setFunction("asin", [](const double* x) { return std::asin(x[0]); }, 1);
+    symbols.setFunction("acos", [](const double* x) { return std::acos(x[0]); }, 1);
+    symbols.setFunction("atan", [](const double* x) { return std::atan(x[0]); }, 1);
+    symbols.setFunction("min", [](const double* x) { return std::min(x[0], x[1]); }, 2);
+    symbols.setFunction("max", [](const double* x) { return std::max(x[0], x[1]); }, 2);
+    symbols.setFunction("atan2", [](const double* x) { return std::atan2(x[0], x[1]); }, 2);
+    symbols.setFunction("hypot", [](const double* x) { return std::hypot(x[0], x[1]); }, 2);
+    symbols.setFunction("clamp", [](const double* x) { return std::min(std::max(x[0], x[1]), x[2]); }, 3);
+}
+
+bool PostfixReader::isNumber(std::string_view str) const {
+    return ExpressionLexer::isNumber(str);
+}
+
+bool PostfixReader::isValidIdentifier(std::string_view str) const {
+    return ExpressionLexer::isIdentifier(str);
+}
+
+TokenType PostfixReader::determineTokenType(std::string_view token) {
     if (isNumber(token)) {
         return TokenType::NUMBER;
     } else if (isValidOperator(token)) {
         return TokenType::OPERATOR;
-    } else if (isValidFunction(token)) {
+    } else if (isValidFunction(std::string(token))) {
         return TokenType::FUNCTION;
     } else if (isValidIdentifier(token)) {
         return TokenType::VARIABLE;
@@ -364,41 +462,37 @@ TokenType PostfixReader::determineTokenType(const std::string& token) {
     }
 }
 
-std::vector<std::string> PostfixReader::splitIntoTokens(const std::string& expression) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(expression);
-    std::string token;
-    
-    while (iss >> token) {
-        tokens.push_back(token);
+double PostfixReader::applyOperator(std::string_view op, double left, double right) const {
+    if (op == "+") return left + right;
+    if (op == "-") return left - right;
+    if (op == "*") return left * right;
+    if (op == "/" || op == "div") {
+        if (right == 0) throw std::runtime_error("Division by zero");
+        return left / right;
     }
-    
-    return tokens;
-}
-
-std::string PostfixReader::trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) {
-        return "";
+    if (op == "^" || op == "pow") return std::pow(left, right);
+    if (op == "%" || op == "mod") {
+        if (right == 0) throw std::runtime_error("Modulo by zero");
+        return std::fmod(left, right);
     }
     
-    size_t end = str.find_last_not_of(" \t\n\r");
-    return str.substr(start, end - start + 1);
+    throw std::runtime_error("Unknown operator: " + std::string(op));
 }
 
-std::vector<std::string> PostfixReader::readLinesFromFile(const std::string& filename) {
-    std::vector<std::string> lines;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filename);
+Token PostfixReader::makeToken(std::string_view tokenStr) {
+    if (tokenStr.empty()) {
+        return Token(TokenType::INVALID, std::string());
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+    TokenType type = determineTokenType(tokenStr);
+    
+    if (type == TokenType::NUMBER) {
+        double value = 0.0;
+        if (!ExpressionLexer::parseNumber(tokenStr, value)) {
+            return Token(TokenType::INVALID, std::string(tokenStr));
+        }
+        return Token(type, std::string(tokenStr), value);
     }
     
-    file.close();
-    return lines;
+    return Token(type, std::string(tokenStr));
 }
\ No newline at end of file
@@ -5,6 +5,13 @@
 #include <sstream>
 #include <unordered_map>
 #include <functional>
+#include <string_view>
+#include <stdexcept>
+#include "../expression_core/ExpressionLexer.h"
+#include "../expression_core/TokenText.h"
+#include "../expression_core/CompactToken.h"
+#include "../expression_core/ProgramFile.h"
+#include "../expression_core/NumericEngine.h"
 
 // Token types for postfix expressions
 enum class TokenType {
@@ -18,16 +25,16 @@ enum class TokenType {
 // Token structure
 struct Token {
     TokenType type;
-    std::string value;
+    TokenText value;
     double numericValue;
     
-    Token() : type(TokenType::INVALID), value(""), numericValue(0.0) {}
-    Token(TokenType t, const std::string& v) : type(t), value(v), numericValue(0.0) {
-        if (t == TokenType::NUMBER) {
-            numericValue = std::stod(v);
+    Token() : type(TokenType::INVALID), numericValue(0.0) {}
+    Token(TokenType t, std::string_view v) : type(t), value(v), numericValue(0.0) {
+        if (t == TokenType::NUMBER && !ExpressionLexer::parseNumber(v, numericValue)) {
+            throw std::invalid_argument("Invalid number: " + std::string(v));
         }
     }
-    Token(TokenType t, const std::string& v, double num) : type(t), value(v), numericValue(num) {}
+    Token(TokenType t, std::string_view v, double num) : type(t), value(v), numericValue(num) {}
 };
 
 class PostfixReader {
@@ -36,7 +43,10 @@ public:
     PostfixReader();
     
     // Read postfix expression from string
-    std::vector<Token> readFromString(const std::string& expression);
+    std::vector<Token> readFromString(std::string_view expression);
+    
+    // Read into an existing vector (cleared first) so callers can reuse its storage
+    void readFromString(std::string_view expression, std::vector<Token>& tokens);
     
     // Read postfix expression from file
     std::vector<Token> readFromFile(const std::string& filename);
@@ -44,17 +54,23 @@ public:
     // Read multiple expressions from file (one per line)
     std::vector<std::vector<Token>> readMultipleFromFile(const std::string& filename);
     
+    // Stream expressions from a memory-mapped file (one per line) without loading them all.
+    // The token vector handed to the callback is reused for the next line.
+    // Returns the number of expressions delivered.
+    size_t forEachExpressionInFile(const std::string& filename,
+                                   const std::function<void(const std::vector<Token>& tokens, size_t lineNumber)>& callback);
+    
     // Validate postfix expression
-    bool validatePostfixExpression(const std::vector<Token>& tokens);
+    bool validatePostfixExpression(const std::vector<Token>& tokens) const;
     
     // Convert tokens back to string
-    std::string tokensToString(const std::vector<Token>& tokens);
+    std::string tokensToString(const std::vector<Token>& tokens) const;
     
     // Parse and validate individual token
     Token parseToken(const std::string& tokenStr);
     
     // Get token type as string
-    std::string getTokenTypeString(TokenType type);
+    std::string getTokenTypeString(TokenType type) const;
     
     // Set custom variables
     void setVariable(const std::string& name, double value);
@@ -63,11 +79,21 @@ public:
     // Set custom functions
     void setFunction(const std::string& name, std::function<double(double)> func);
     
+    // Function of arity arguments (1 to MAX_FUNCTION_ARITY) as a plain pointer,
+    // called directly with its arguments in order: "a b min" is min(a, b)
+    void setFunction(const std::string& name, NaryFunction func, size_t arity);
+    
+    // Function written as a postfix expression over its parameters, e.g.
+    // defineFunction("lerp", {"a", "b", "t"}, "a b a - t * +"). Programs compiled
+    // afterwards contain its body in place of each call; the token-vector APIs
+    // (evaluatePostfix(tokens), validation) run the body instead.
+    void defineFunction(const std::string& name, const std::vector<std::string>& parameters, std::string_view body);
+    
     // Get variable value
-    double getVariable(const std::string& name) const;
+    double getVariable(std::string_view name) const;
     
     // Check if token is valid operator
-    bool isValidOperator(const std::string& token) const;
+    bool isValidOperator(std::string_view token) const;
     
     // Check if token is valid function
     bool isValidFunction(const std::string& token) const;
@@ -89,11 +115,47 @@ public:
     
     // Count operands and operators
     std::pair<int, int> countOperandsAndOperators(const std::vector<Token>& tokens);
+    
+    // Evaluate postfix expression using the reader's variables and functions.
+    // Text is compiled for this call only, with names looked up but never
+    // added to the symbol table; use compile() for programs that are kept.
+    double evaluatePostfix(const std::vector<Token>& tokens);
+    double evaluatePostfix(const std::string& postfix);
+    
+    // Same, without exceptions: an error code and the byte offset of the bad token
+    EvalResult tryEvaluatePostfix(std::string_view postfix) const;
+    
+    // Evaluate with the number type chosen at compile time (see expression_core/Numeric.h).
+    // Uses the given variables and the type's builtins, not the reader's double-valued ones.
+    template<typename T>
+    T evaluatePostfixAs(const std::string& postfix,
+                        const std::unordered_map<std::string, T>& vars = std::unordered_map<std::string, T>()) const {
+        return evaluateNumeric<T>(postfix, false, vars);
+    }
+    
+    // Compile to 16-byte tokens whose names are resolved to symbol ids once,
+    // so evaluateCompiled indexes arrays instead of hashing strings.
+    // Comparisons (< <= > >= == !=), && and || and the conditional ? (condition,
+    // then, else: "x 0 > x y / 0 ?") compile to jumps, so the operand not needed
+    // is never evaluated and cannot fail.
+    std::vector<CompactToken> compile(std::string_view expression);
+    void compile(std::string_view expression, std::vector<CompactToken>& program);
+    double evaluateCompiled(const std::vector<CompactToken>& program) const;
+    
+    // Binary program catalogs (see expression_core/ProgramFile.h): save compiled
+    // programs once, then map the file at startup instead of parsing text again.
+    // loadCompiled binds the file's names to this reader's symbols; evaluate its
+    // programs with this reader or a copy of it.
+    void saveCompiled(const std::string& filename, const std::vector<std::vector<CompactToken>>& programs) const;
+    ProgramFile loadCompiled(const std::string& filename);
+    double evaluateCompiled(const ProgramFile& file, size_t program) const;
+    
+    // Names, variable values and functions, indexed by symbol id
+    const SymbolTable& getSymbols() const;
 
 private:
-    // Internal variables and functions storage
-    std::unordered_map<std::string, double> variables;
-    std::unordered_map<std::string, std::function<double(double)>> functions;
+    // Variables and functions, stored by symbol id
+    SymbolTable symbols;
     
     // Valid operators
     std::vector<std::string> validOperators;
@@ -102,14 +164,11 @@ private:
     void initializeBuiltInFunctions();
     
     // Helper functions
-    bool isNumber(const std::string& str) const;
-    bool isValidIdentifier(const std::string& str) const;
-    TokenType determineTokenType(const std::string& token);
+    bool isNumber(std::string_view str) const;
+    bool isValidIdentifier(std::string_view str) const;
+    TokenType determineTokenType(std::string_view token);
+    double applyOperator(std::string_view op, double left, double right) const;
     
     // Tokenization helpers
-    std::vector<std::string> splitIntoTokens(const std::string& expression);
-    std::string trim(const std::string& str);
-    
-    // File reading helpers
-    std::vector<std::string> readLinesFromFile(const std::string& filename);
+    Token makeToken(std::string_view tokenStr);
 };
\ No newline at end of file
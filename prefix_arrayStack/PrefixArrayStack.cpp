@@ -0,0 +1,345 @@
+#include "PrefixArrayStack.h"
+#include "../expression_core/ExpressionLexer.h"
+
+// Static member initialization
+const std::unordered_map<std::string, std::function<double(double)>> PrefixArrayEvaluator::builtInFunctions = {
+    {"sin", [](double x) { return std::sin(x); }},
+    {"cos", [](double x) { return std::cos(x); }},
+    {"tan", [](double x) { return std::tan(x); }},
+    {"log", [](double x) { return std::log(x); }},
+    {"ln", [](double x) { return std::log(x); }},
+    {"log10", [](double x) { return std::log10(x); }},
+    {"sqrt", [](double x) { return std::sqrt(x); }},
+    {"abs", [](double x) { return std::abs(x); }},
+    {"floor", [](double x) { return std::floor(x); }},
+    {"ceil", [](double x) { return std::ceil(x); }},
+    {"exp", [](double x) { return std::exp(x); }},
+    {"asin", [](double x) { return std::asin(x); }},
+    {"acos", [](double x) { return std::acos(x); }},
+    {"atan", [](double x) { return std::atan(x); }}
+};
+
+namespace {
+
+// Call func for each whitespace-separated token, last token first,
+// until it returns false
+template<typename Func>
+void forEachTokenFromRight(std::string_view expression, Func func) {
+    const char* begin = expression.data();
+    const char* p = begin + expression.size();
+
+    while (true) {
+        while (p > begin && ExpressionLexer::isSpace(p[-1])) {
+            --p;
+        }
+        if (p == begin) {
+            return;
+        }
+
+        const char* tokenEnd = p;
+        while (p > begin && !ExpressionLexer::isSpace(p[-1])) {
+            --p;
+        }
+        if (!func(std::string_view(p, static_cast<size_t>(tokenEnd - p)))) {
+            return;
+        }
+    }
+}
+
+// Operator or function still waiting for operands during a left-to-right conversion
+struct PendingOperator {
+    std::string_view token;
+    int remaining;
+    bool parenthesized;     // prefixToInfix: a ')' is owed when this operator completes
+};
+
+} // namespace
+
+double PrefixArrayEvaluator::evaluate(const std::string& prefix) {
+    static const std::unordered_map<std::string, double> noVariables;
+    return evaluate(prefix, noVariables);
+}
+
+double PrefixArrayEvaluator::evaluate(const std::string& prefix, const std::unordered_map<std::string, double>& variables) {
+    EvalResult result = tryEvaluate(prefix, variables);
+    if (!result) {
+        if (result.error == EvalError::DIVISION_BY_ZERO || result.error == EvalError::MODULO_BY_ZERO) {
+            throw std::runtime_error(evalErrorName(result.error));
+        }
+        throw std::invalid_argument(result.describe(prefix));
+    }
+    return result.value;
+}
+
+EvalResult PrefixArrayEvaluator::tryEvaluate(std::string_view prefix) {
+    static const std::unordered_map<std::string, double> noVariables;
+    return tryEvaluate(prefix, noVariables);
+}
+
+EvalResult PrefixArrayEvaluator::tryEvaluate(std::string_view prefix, const std::unordered_map<std::string, double>& variables) {
+    // One operand stack per thread, reused by every call
+    static thread_local PrefixArrayStack<double> operandStack(64);
+    operandStack.clear();
+
+    EvalResult failure = EvalResult::success(0.0);
+    size_t firstOffset = 0;
+    forEachTokenFromRight(prefix, [&](std::string_view token) {
+        size_t offset = static_cast<size_t>(token.data() - prefix.data());
+        firstOffset = offset;
+
+        char op = operatorSymbol(token);
+        if (op != 0) {
+            if (operandStack.size() < 2) {
+                failure = EvalResult::failure(EvalError::MISSING_OPERAND, offset);
+                return false;
+            }
+
+            // Right to left, so the left operand is on top
+            double a = operandStack.pop();
+            double& b = operandStack.top();
+            if (b == 0 && (op == '/' || op == '%')) {
+                failure = EvalResult::failure(op == '/' ? EvalError::DIVISION_BY_ZERO : EvalError::MODULO_BY_ZERO, offset);
+                return false;
+            }
+            b = performOperation(a, b, op);
+            return true;
+        }
+
+        if (isNumber(token)) {
+            double number = 0.0;
+            if (!ExpressionLexer::parseNumber(token, number)) {
+                failure = EvalResult::failure(EvalError::MALFORMED_NUMBER, offset);
+                return false;
+            }
+            operandStack.push(number);
+            return true;
+        }
+
+        std::string name(token);
+        auto funcIt = builtInFunctions.find(name);
+        if (funcIt != builtInFunctions.end()) {
+            if (operandStack.isEmpty()) {
+                failure = EvalResult::failure(EvalError::MISSING_OPERAND, offset);
+                return false;
+            }
+
+            double& arg = operandStack.top();
+            arg = funcIt->second(arg);
+        } else if (isVariable(token)) {
+            auto it = variables.find(name);
+            if (it == variables.end()) {
+                failure = EvalResult::failure(EvalError::UNDEFINED_VARIABLE, offset);
+                return false;
+            }
+            operandStack.push(it->second);
+        } else {
+            failure = EvalResult::failure(EvalError::UNKNOWN_TOKEN, offset);
+            return false;
+        }
+        return true;
+    });
+
+    if (!failure) {
+        return failure;
+    }
+    if (operandStack.isEmpty()) {
+        return EvalResult::failure(EvalError::EMPTY_EXPRESSION, 0);
+    }
+    if (operandStack.size() != 1) {
+        return EvalResult::failure(EvalError::MISSING_OPERATOR, firstOffset);
+    }
+
+    return EvalResult::success(operandStack.top());
+}
+
+std::string PrefixArrayEvaluator::prefixToPostfix(const std::string& prefix) {
+    // Left to right: operators wait on the stack until all their operands have been written
+    static thread_local PrefixArrayStack<PendingOperator> pending(32);
+    pending.clear();
+
+    std::string result;
+    result.reserve(prefix.size());
+    bool complete = false;
+
+    for (std::string_view token : tokenize(prefix)) {
+        if (complete) {
+            throw std::invalid_argument("Invalid prefix expression");
+        }
+
+        if (isOperator(token) || isFunction(token)) {
+            pending.push(PendingOperator{token, isOperator(token) ? 2 : 1, false});
+            continue;
+        }
+
+        if (!result.empty()) result += ' ';
+        result += token;
+
+        // An operand may finish one or more enclosing operators
+        while (true) {
+            if (pending.isEmpty()) {
+                complete = true;
+                break;
+            }
+            if (--pending.top().remaining > 0) {
+                break;
+            }
+            result += ' ';
+            result += pending.pop().token;
+        }
+    }
+
+    if (!complete) {
+        throw std::invalid_argument("Invalid prefix expression");
+    }
+
+    return result;
+}
+
+std::string PrefixArrayEvaluator::prefixToInfix(const std::string& prefix) {
+    // Same walk as prefixToPostfix; every operator opens a parenthesis that its
+    // last operand closes, except directly inside a function call's own parentheses
+    static thread_local PrefixArrayStack<PendingOperator> pending(32);
+    pending.clear();
+
+    std::string result;
+    result.reserve(prefix.size() * 2);
+    bool complete = false;
+
+    for (std::string_view token : tokenize(prefix)) {
+        if (complete) {
+            throw std::invalid_argument("Invalid prefix expression");
+        }
+
+        if (isOperator(token)) {
+            bool parenthesized = pending.isEmpty() || pending.top().remaining != 1 || isOperator(pending.top().token);
+            if (parenthesized) result += '(';
+            pending.push(PendingOperator{token, 2, parenthesized});
+            continue;
+        }
+        if (isFunction(token)) {
+            result += token;
+            result += '(';
+            pending.push(PendingOperator{token, 1, true});
+            continue;
+        }
+
+        result += token;
+
+        while (true) {
+            if (pending.isEmpty()) {
+                complete = true;
+                break;
+            }
+            PendingOperator& top = pending.top();
+            if (--top.remaining > 0) {
+                result += ' ';
+                result += top.token;
+                result += ' ';
+                break;
+            }
+            if (top.parenthesized) result += ')';
+            pending.pop();
+        }
+    }
+
+    if (!complete) {
+        throw std::invalid_argument("Invalid prefix expression");
+    }
+
+    return result;
+}
+
+bool PrefixArrayEvaluator::isValidPrefix(const std::string& prefix) {
+    int operandCount = 0;
+    bool valid = true;
+    size_t tokenCount = 0;
+
+    forEachTokenFromRight(prefix, [&](std::string_view token) {
+        ++tokenCount;
+
+        if (isOperator(token)) {
+            valid = operandCount >= 2;
+            operandCount--; // Two operands become one result
+        } else if (isFunction(token)) {
+            valid = operandCount >= 1;
+        } else if (isNumber(token) || isVariable(token)) {
+            operandCount++;
+        } else {
+            valid = false;
+        }
+        return valid;
+    });
+
+    return valid && tokenCount > 0 && operandCount == 1;
+}
+
+// Helper function implementations
+char PrefixArrayEvaluator::operatorSymbol(std::string_view token) {
+    if (token.size() == 1) {
+        switch (token[0]) {
+            case '+':
+            case '-':
+            case '*':
+            case '/':
+            case '^':
+            case '%':
+                return token[0];
+            default:
+                return 0;
+        }
+    }
+
+    if (token == "mod") return '%';
+    if (token == "div") return '/';
+    if (token == "pow") return '^';
+    return 0;
+}
+
+bool PrefixArrayEvaluator::isOperator(std::string_view token) {
+    return operatorSymbol(token) != 0;
+}
+
+bool PrefixArrayEvaluator::isFunction(std::string_view token) {
+    return builtInFunctions.find(std::string(token)) != builtInFunctions.end();
+}
+
+bool PrefixArrayEvaluator::isNumber(std::string_view token) {
+    return ExpressionLexer::isNumber(token);
+}
+
+bool PrefixArrayEvaluator::isVariable(std::string_view token) {
+    return ExpressionLexer::isIdentifier(token) && !isFunction(token) && !isOperator(token);
+}
+
+double PrefixArrayEvaluator::performOperation(double a, double b, char op) {
+    switch (op) {
+        case '+': return a + b;
+        case '-': return a - b;
+        case '*': return a * b;
+        case '/':
+            if (b == 0) throw std::runtime_error("Division by zero");
+            return a / b;
+        case '^': return std::pow(a, b);
+        case '%':
+            if (b == 0) throw std::runtime_error("Modulo by zero");
+            return std::fmod(a, b);
+        default:
+            throw std::invalid_argument("Unknown operator: " + std::string(1, op));
+    }
+}
+
+double PrefixArrayEvaluator::performFunction(const std::string& func, double arg) {
+    auto it = builtInFunctions.find(func);
+    if (it != builtInFunctions.end()) {
+        return it->second(arg);
+    }
+    throw std::invalid_argument("Unknown function: " + func);
+}
+
+std::vector<std::string_view> PrefixArrayEvaluator::tokenize(std::string_view expression) {
+    std::vector<std::string_view> tokens;
+    ExpressionLexer::forEachToken(expression, [&](std::string_view token) {
+        tokens.push_back(token);
+    });
+    return tokens;
+}
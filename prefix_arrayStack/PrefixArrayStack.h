@@ -7,8 +7,12 @@
 #include <cmath>
 #include <unordered_map>
 #include <functional>
+#include <string_view>
+#include "../expression_core/EvalResult.h"
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/LifecycleTrace.h"
 
-template<typename T>
+template<typename T, typename Trace = NoTrace>
 class PrefixArrayStack {
 private:
     T* data;
@@ -18,11 +22,13 @@ private:
     void resize() {
         int new_capacity = capacity * 2;
         T* new_data = new T[new_capacity];
+        TRACK_ALLOCATION("PrefixArrayStack buffer", new_data, static_cast<size_t>(new_capacity) * sizeof(T));
         
         for (int i = 0; i <= top_index; ++i) {
             new_data[i] = std::move(data[i]);
         }
         
+        TRACK_DEALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         delete[] data;
         data = new_data;
         capacity = new_capacity;
@@ -33,17 +39,19 @@ public:
     explicit PrefixArrayStack(int initial_capacity = 10) 
         : capacity(initial_capacity), top_index(-1) {
         data = new T[capacity];
-        std::cout << "PrefixArrayStack constructor called with capacity " << capacity << std::endl;
+        TRACK_ALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
+        Trace::record("PrefixArrayStack", LifecycleEvent::CONSTRUCT);
     }
     
     // Copy constructor
     PrefixArrayStack(const PrefixArrayStack& other) 
         : capacity(other.capacity), top_index(other.top_index) {
         data = new T[capacity];
+        TRACK_ALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         for (int i = 0; i <= top_index; ++i) {
             data[i] = other.data[i];
         }
-        std::cout << "PrefixArrayStack copy constructor called" << std::endl;
+        Trace::record("PrefixArrayStack", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
@@ -52,29 +60,32 @@ public:
         other.data = nullptr;
         other.capacity = 0;
         other.top_index = -1;
-        std::cout << "PrefixArrayStack move constructor called" << std::endl;
+        Trace::record("PrefixArrayStack", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
     PrefixArrayStack& operator=(const PrefixArrayStack& other) {
         if (this != &other) {
+            TRACK_DEALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             delete[] data;
             
             capacity = other.capacity;
             top_index = other.top_index;
             data = new T[capacity];
+            TRACK_ALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             
             for (int i = 0; i <= top_index; ++i) {
                 data[i] = other.data[i];
             }
         }
-        std::cout << "PrefixArrayStack copy assignment called" << std::endl;
+        Trace::record("PrefixArrayStack", LifecycleEvent::COPY_ASSIGN);
         return *this;
     }
     
     // Move assignment
     PrefixArrayStack& operator=(PrefixArrayStack&& other) noexcept {
         if (this != &other) {
+            TRACK_DEALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
             delete[] data;
             
             data = other.data;
@@ -85,14 +96,15 @@ public:
             other.capacity = 0;
             other.top_index = -1;
         }
-        std::cout << "PrefixArrayStack move assignment called" << std::endl;
+        Trace::record("PrefixArrayStack", LifecycleEvent::MOVE_ASSIGN);
         return *this;
     }
     
     // Destructor
     ~PrefixArrayStack() {
+        TRACK_DEALLOCATION("PrefixArrayStack buffer", data, static_cast<size_t>(capacity) * sizeof(T));
         delete[] data;
-        std::cout << "PrefixArrayStack destructor called" << std::endl;
+        Trace::record("PrefixArrayStack", LifecycleEvent::DESTRUCT);
     }
     
     // Stack operations
@@ -135,6 +147,11 @@ public:
         return top_index == -1;
     }
     
+    // Forget all elements but keep the storage for reuse
+    void clear() {
+        top_index = -1;
+    }
+    
     int size() const {
         return top_index + 1;
     }
@@ -152,23 +169,31 @@ public:
     }
 };
 
-// Prefix Evaluator using Array Stack
+// Prefix Evaluator using Array Stack.
+// Tokens are scanned in place from the right, operators dispatch on a single
+// character, and operands live in a per-thread PrefixArrayStack reused across calls.
 class PrefixArrayEvaluator {
 public:
     static double evaluate(const std::string& prefix);
     static double evaluate(const std::string& prefix, const std::unordered_map<std::string, double>& variables);
+    
+    // Same, without exceptions: an error code and the byte offset of the bad token
+    static EvalResult tryEvaluate(std::string_view prefix);
+    static EvalResult tryEvaluate(std::string_view prefix, const std::unordered_map<std::string, double>& variables);
+    
     static std::string prefixToPostfix(const std::string& prefix);
-    static std::string prefixToInfix(const std::string& prefix);
+    static std::string prefixToInfix(const std::string& prefix);   // Fully parenthesized
     static bool isValidPrefix(const std::string& prefix);
     
 private:
-    static bool isOperator(const std::string& token);
-    static bool isFunction(const std::string& token);
-    static bool isNumber(const std::string& token);
-    static bool isVariable(const std::string& token);
-    static double performOperation(double a, double b, const std::string& op);
+    static char operatorSymbol(std::string_view token);            // '+', '-', '*', '/', '^', '%' or 0
+    static bool isOperator(std::string_view token);
+    static bool isFunction(std::string_view token);
+    static bool isNumber(std::string_view token);
+    static bool isVariable(std::string_view token);
+    static double performOperation(double a, double b, char op);
     static double performFunction(const std::string& func, double arg);
-    static std::vector<std::string> tokenize(const std::string& expression);
+    static std::vector<std::string_view> tokenize(std::string_view expression);
     
     static const std::unordered_map<std::string, std::function<double(double)>> builtInFunctions;
 };
\ No newline at end of file
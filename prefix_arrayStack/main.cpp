@@ -0,0 +1,59 @@
+#include "PrefixArrayStack.h"
+#include <iostream>
+#include <vector>
+#include <string>
+
+void testEvaluation() {
+    std::cout << "\n=== Prefix Evaluation (PrefixArrayStack) ===" << std::endl;
+    
+    std::unordered_map<std::string, double> variables = {{"x", 2.0}, {"y", 5.0}};
+    std::vector<std::string> expressions = {
+        "+ 3 4",
+        "- * 2 x y",
+        "^ 2 ^ 3 2",
+        "sqrt + 9 16",
+        "mod 17 y",
+        "/ 1 0",
+        "+ 1",
+        "+ z 1"
+    };
+    
+    for (const std::string& expr : expressions) {
+        std::cout << expr << " = ";
+        try {
+            std::cout << PrefixArrayEvaluator::evaluate(expr, variables) << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "Error: " << e.what() << std::endl;
+        }
+    }
+}
+
+void testConversions() {
+    std::cout << "\n=== Prefix Conversions ===" << std::endl;
+    
+    std::vector<std::string> expressions = {
+        "+ 3 4",
+        "* + a b - c d",
+        "sin / x 2",
+        "+ 1 2 3"
+    };
+    
+    for (const std::string& expr : expressions) {
+        std::cout << expr << " (valid: " << (PrefixArrayEvaluator::isValidPrefix(expr) ? "yes" : "no") << ")" << std::endl;
+        try {
+            std::cout << "  postfix: " << PrefixArrayEvaluator::prefixToPostfix(expr) << std::endl;
+            std::cout << "  infix:   " << PrefixArrayEvaluator::prefixToInfix(expr) << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "  Error: " << e.what() << std::endl;
+        }
+    }
+}
+
+int main() {
+    std::cout << "=== Prefix ArrayStack Evaluator ===" << std::endl;
+    
+    testEvaluation();
+    testConversions();
+    
+    return 0;
+}
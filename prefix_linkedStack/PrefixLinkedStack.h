@@ -7,13 +7,15 @@
 #include <unordered_map>
 #include <functional>
 #include <vector>
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/LifecycleTrace.h"
 
 // Node class for linked list with proper copy/move semantics
-template<typename T>
+template<typename T, typename Trace = NoTrace>
 class PrefixNode {
 public:
     T data;
-    PrefixNode<T>* next;
+    PrefixNode* next;
     
     // Constructors
     PrefixNode() : data{}, next(nullptr) {}
@@ -22,20 +24,20 @@ public:
     
     // Copy constructor
     PrefixNode(const PrefixNode& other) : data(other.data), next(nullptr) {
-        std::cout << "PrefixNode copy constructor called" << std::endl;
+        Trace::record("PrefixNode", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
     PrefixNode(PrefixNode&& other) noexcept : data(std::move(other.data)), next(other.next) {
         other.next = nullptr;
-        std::cout << "PrefixNode move constructor called" << std::endl;
+        Trace::record("PrefixNode", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
     PrefixNode& operator=(const PrefixNode& other) {
         if (this != &other) {
             data = other.data;
-            std::cout << "PrefixNode copy assignment called" << std::endl;
+            Trace::record("PrefixNode", LifecycleEvent::COPY_ASSIGN);
         }
         return *this;
     }
@@ -45,7 +47,7 @@ public:
         if (this != &other) {
             data = std::move(other.data);
             other.next = nullptr;
-            std::cout << "PrefixNode move assignment called" << std::endl;
+            Trace::record("PrefixNode", LifecycleEvent::MOVE_ASSIGN);
         }
         return *this;
     }
@@ -55,10 +57,10 @@ public:
 };
 
 // Linked Stack implementation for prefix evaluation
-template<typename T>
+template<typename T, typename Trace = NoTrace>
 class PrefixLinkedStack {
 private:
-    PrefixNode<T>* top_;
+    PrefixNode<T, Trace>* top_;
     size_t size_;
     
     void copyFrom(const PrefixLinkedStack& other) {
@@ -68,12 +70,14 @@ private:
             return;
         }
         
-        top_ = new PrefixNode<T>(other.top_->data);
-        PrefixNode<T>* current = top_;
-        PrefixNode<T>* otherCurrent = other.top_->next;
+        top_ = new PrefixNode<T, Trace>(other.top_->data);
+        TRACK_ALLOCATION("PrefixLinkedStack node", top_, sizeof(PrefixNode<T, Trace>));
+        PrefixNode<T, Trace>* current = top_;
+        PrefixNode<T, Trace>* otherCurrent = other.top_->next;
         
         while (otherCurrent != nullptr) {
-            current->next = new PrefixNode<T>(otherCurrent->data);
+            current->next = new PrefixNode<T, Trace>(otherCurrent->data);
+            TRACK_ALLOCATION("PrefixLinkedStack node", current->next, sizeof(PrefixNode<T, Trace>));
             current = current->next;
             otherCurrent = otherCurrent->next;
         }
@@ -83,8 +87,9 @@ private:
     
     void clear() {
         while (top_ != nullptr) {
-            PrefixNode<T>* temp = top_;
+            PrefixNode<T, Trace>* temp = top_;
             top_ = top_->next;
+            TRACK_DEALLOCATION("PrefixLinkedStack node", temp, sizeof(PrefixNode<T, Trace>));
             delete temp;
         }
         size_ = 0;
@@ -93,13 +98,13 @@ private:
 public:
     // Default constructor
     PrefixLinkedStack() : top_(nullptr), size_(0) {
-        std::cout << "PrefixLinkedStack default constructor called" << std::endl;
+        Trace::record("PrefixLinkedStack", LifecycleEvent::CONSTRUCT);
     }
     
     // Copy constructor
     PrefixLinkedStack(const PrefixLinkedStack& other) : top_(nullptr), size_(0) {
         copyFrom(other);
-        std::cout << "PrefixLinkedStack copy constructor called" << std::endl;
+        Trace::record("PrefixLinkedStack", LifecycleEvent::COPY_CONSTRUCT);
     }
     
     // Move constructor
@@ -107,7 +112,7 @@ public:
         : top_(other.top_), size_(other.size_) {
         other.top_ = nullptr;
         other.size_ = 0;
-        std::cout << "PrefixLinkedStack move constructor called" << std::endl;
+        Trace::record("PrefixLinkedStack", LifecycleEvent::MOVE_CONSTRUCT);
     }
     
     // Copy assignment
@@ -115,7 +120,7 @@ public:
         if (this != &other) {
             clear();
             copyFrom(other);
-            std::cout << "PrefixLinkedStack copy assignment called" << std::endl;
+            Trace::record("PrefixLinkedStack", LifecycleEvent::COPY_ASSIGN);
         }
         return *this;
     }
@@ -128,7 +133,7 @@ public:
             size_ = other.size_;
             other.top_ = nullptr;
             other.size_ = 0;
-            std::cout << "PrefixLinkedStack move assignment called" << std::endl;
+            Trace::record("PrefixLinkedStack", LifecycleEvent::MOVE_ASSIGN);
         }
         return *this;
     }
@@ -136,19 +141,21 @@ public:
     // Destructor
     ~PrefixLinkedStack() {
         clear();
-        std::cout << "PrefixLinkedStack destructor called" << std::endl;
+        Trace::record("PrefixLinkedStack", LifecycleEvent::DESTRUCT);
     }
     
     // Stack operations
     void push(const T& value) {
-        PrefixNode<T>* newNode = new PrefixNode<T>(value);
+        PrefixNode<T, Trace>* newNode = new PrefixNode<T, Trace>(value);
+        TRACK_ALLOCATION("PrefixLinkedStack node", newNode, sizeof(PrefixNode<T, Trace>));
         newNode->next = top_;
         top_ = newNode;
         ++size_;
     }
     
     void push(T&& value) {
-        PrefixNode<T>* newNode = new PrefixNode<T>(std::move(value));
+        PrefixNode<T, Trace>* newNode = new PrefixNode<T, Trace>(std::move(value));
+        TRACK_ALLOCATION("PrefixLinkedStack node", newNode, sizeof(PrefixNode<T, Trace>));
         newNode->next = top_;
         top_ = newNode;
         ++size_;
@@ -159,9 +166,10 @@ public:
             throw std::runtime_error("Cannot pop from empty stack");
         }
         
-        PrefixNode<T>* temp = top_;
+        PrefixNode<T, Trace>* temp = top_;
         T value = std::move(top_->data);
         top_ = top_->next;
+        TRACK_DEALLOCATION("PrefixLinkedStack node", temp, sizeof(PrefixNode<T, Trace>));
         delete temp;
         --size_;
         
@@ -192,7 +200,7 @@ public:
     
     void display() const {
         std::cout << "Stack (top to bottom): ";
-        PrefixNode<T>* current = top_;
+        PrefixNode<T, Trace>* current = top_;
         while (current != nullptr) {
             std::cout << current->data << " ";
             current = current->next;
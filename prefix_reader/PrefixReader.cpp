@@ -1,6 +1,7 @@
 #include "PrefixReader.h"
+#include "../expression_core/MappedFile.h"
 #include <iostream>
-#include <stack>
+#include <algorithm>
 #include <cctype>
 #include <cmath>
 
@@ -12,20 +13,19 @@ PrefixReader::PrefixReader() {
     initializeBuiltInFunctions();
 }
 
-std::vector<PrefixToken> PrefixReader::readFromString(const std::string& expression) {
+std::vector<PrefixToken> PrefixReader::readFromString(std::string_view expression) {
     std::vector<PrefixToken> tokens;
-    std::vector<std::string> tokenStrings = splitIntoTokens(expression);
-    
-    for (const std::string& tokenStr : tokenStrings) {
-        if (!tokenStr.empty()) {
-            PrefixToken token = parseToken(tokenStr);
-            tokens.push_back(token);
-        }
-    }
-    
+    readFromString(expression, tokens);
     return tokens;
 }
 
+void PrefixReader::readFromString(std::string_view expression, std::vector<PrefixToken>& tokens) {
+    tokens.clear();
+    ExpressionLexer::forEachToken(expression, [&](std::string_view tokenStr) {
+        TRACK_PUSH_BACK("PrefixReader tokens", tokens, makeToken(tokenStr));
+    });
+}
+
 std::vector<PrefixToken> PrefixReader::readFromFile(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -46,22 +46,41 @@ std::vector<PrefixToken> PrefixReader::readFromFile(const std::string& filename)
 
 std::vector<std::vector<PrefixToken>> PrefixReader::readMultipleFromFile(const std::string& filename) {
     std::vector<std::vector<PrefixToken>> allExpressions;
-    std::vector<std::string> lines = readLinesFromFile(filename);
-    
-    for (const std::string& line : lines) {
-        std::string trimmedLine = trim(line);
-        if (!trimmedLine.empty() && trimmedLine[0] != '#') { // Skip empty lines and comments
-            std::vector<PrefixToken> tokens = readFromString(trimmedLine);
-            if (!tokens.empty()) {
-                allExpressions.push_back(tokens);
-            }
+    forEachExpressionInFile(filename, [&](const std::vector<PrefixToken>& tokens, size_t) {
+        allExpressions.push_back(tokens);
+    });
+    
+    return allExpressions;
+}
+
+size_t PrefixReader::forEachExpressionInFile(const std::string& filename,
+                                       const std::function<void(const std::vector<PrefixToken>& tokens, size_t lineNumber)>& callback) {
+    MappedFile file(filename);
+    LineScanner scanner(file.view());
+    
+    std::vector<PrefixToken> tokens;
+    std::string_view line;
+    size_t lineNumber = 0;
+    size_t expressionCount = 0;
+    
+    while (scanner.next(line)) {
+        ++lineNumber;
+        std::string_view trimmedLine = ExpressionLexer::trim(line);
+        if (trimmedLine.empty() || trimmedLine[0] == '#') { // Skip empty lines and comments
+            continue;
+        }
+        
+        readFromString(trimmedLine, tokens);
+        if (!tokens.empty()) {
+            callback(tokens, lineNumber);
+            ++expressionCount;
         }
     }
     
-    return allExpressions;
+    return expressionCount;
 }
 
-bool PrefixReader::validatePrefixExpression(const std::vector<PrefixToken>& tokens) {
+bool PrefixReader::validatePrefixExpression(const std::vector<PrefixToken>& tokens) const {
     if (tokens.empty()) {
         return false;
     }
@@ -80,12 +99,14 @@ bool PrefixReader::validatePrefixExpression(const std::vector<PrefixToken>& toke
                 operandCount++;
                 break;
                 
-            case PrefixTokenType::FUNCTION:
-                if (operandCount < 1) {
+            case PrefixTokenType::FUNCTION: {
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity == 0 || operandCount < arity) {
                     return false; // Not enough operands for function
                 }
-                // Function consumes one operand and produces one result (no change in count)
+                operandCount -= arity - 1; // Its arguments become one result
                 break;
+            }
                 
             case PrefixTokenType::OPERATOR:
                 if (operandCount < 2) {
@@ -102,7 +123,7 @@ bool PrefixReader::validatePrefixExpression(const std::vector<PrefixToken>& toke
     return operandCount == 1; // Should have exactly one result
 }
 
-std::string PrefixReader::tokensToString(const std::vector<PrefixToken>& tokens) {
+std::string PrefixReader::tokensToString(const std::vector<PrefixToken>& tokens) const {
     std::string result;
     for (size_t i = 0; i < tokens.size(); ++i) {
         result += tokens[i].value;
@@ -114,27 +135,10 @@ std::string PrefixReader::tokensToString(const std::vector<PrefixToken>& tokens)
 }
 
 PrefixToken PrefixReader::parseToken(const std::string& tokenStr) {
-    std::string cleanToken = trim(tokenStr);
-    
-    if (cleanToken.empty()) {
-        return PrefixToken(PrefixTokenType::INVALID, cleanToken);
-    }
-    
-    PrefixTokenType type = determineTokenType(cleanToken);
-    
-    if (type == PrefixTokenType::NUMBER) {
-        try {
-            double value = std::stod(cleanToken);
-            return PrefixToken(type, cleanToken, value);
-        } catch (const std::exception&) {
-            return PrefixToken(PrefixTokenType::INVALID, cleanToken);
-        }
-    }
-    
-    return PrefixToken(type, cleanToken);
+    return makeToken(ExpressionLexer::trim(tokenStr));
 }
 
-std::string PrefixReader::getTokenTypeString(PrefixTokenType type) {
+std::string PrefixReader::getTokenTypeString(PrefixTokenType type) const {
     switch (type) {
         case PrefixTokenType::NUMBER: return "NUMBER";
         case PrefixTokenType::OPERATOR: return "OPERATOR";
@@ -146,182 +150,356 @@ std::string PrefixReader::getTokenTypeString(PrefixTokenType type) {
 }
 
 std::string PrefixReader::infixToPrefix(const std::string& infix) {
-    // Algorithm: Reverse infix, swap parentheses, convert to postfix, then reverse result
-    
-    // Step 1: Reverse the infix expression and swap parentheses
-    std::string reversedInfix;
-    for (int i = static_cast<int>(infix.length()) - 1; i >= 0; --i) {
-        char c = infix[i];
-        if (c == '(') {
-            reversedInfix += ')';
-        } else if (c == ')') {
-            reversedInfix += '(';
-        } else {
-            reversedInfix += c;
-        }
-    }
+    // Shunting-yard to postfix order, then the same linear rewrite as postfixToPrefix.
+    // Tokens stay views into infix, so nothing is copied until the final output.
+    std::vector<std::string_view> postfix;
+    postfix.reserve(infix.size() / 2 + 1);
+    SmallStack<std::string_view> operators;
+    std::string_view text(infix);
     
-    // Step 2: Convert the reversed infix to postfix
-    std::string postfix;
-    std::stack<char> operators;
+    // Pop operators that bind at least as tightly (strictly tighter for right-associative ones)
+    auto pushOperator = [&](std::string_view op) {
+        int precedence = getOperatorPrecedence(op);
+        while (!operators.isEmpty() && operators.top() != "(") {
+            int topPrecedence = getOperatorPrecedence(operators.top());
+            if (topPrecedence < precedence || (topPrecedence == precedence && isRightAssociative(op))) {
+                break;
+            }
+            postfix.push_back(operators.pop());
+        }
+        operators.push(op);
+    };
     
-    for (size_t i = 0; i < reversedInfix.length(); ++i) {
-        char c = reversedInfix[i];
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
         
-        if (std::isspace(c)) {
-            continue;
-        } else if (std::isdigit(c) || c == '.') {
-            // Add number to result
-            while (i < reversedInfix.length() && 
-                   (std::isdigit(reversedInfix[i]) || reversedInfix[i] == '.')) {
-                postfix += reversedInfix[i];
+        if (ExpressionLexer::isSpace(c)) {
+            ++i;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            size_t start = i;
+            while (i < text.size() && (std::isdigit(static_cast<unsigned char>(text[i])) || text[i] == '.')) {
                 ++i;
             }
-            postfix += ' ';
-            --i; // Adjust for loop increment
-        } else if (std::isalpha(c)) {
-            // Add variable/function name to result
-            while (i < reversedInfix.length() && 
-                   (std::isalnum(reversedInfix[i]) || reversedInfix[i] == '_')) {
-                postfix += reversedInfix[i];
+            postfix.push_back(text.substr(start, i - start));
+        } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = i;
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
                 ++i;
             }
-            postfix += ' ';
-            --i; // Adjust for loop increment
+            std::string_view word = text.substr(start, i - start);
+            
+            size_t next = i;
+            while (next < text.size() && ExpressionLexer::isSpace(text[next])) {
+                ++next;
+            }
+            
+            if (isValidOperator(word)) {
+                pushOperator(word); // mod, div, pow
+            } else if (next < text.size() && text[next] == '(' && isValidFunction(std::string(word))) {
+                operators.push(word); // Emitted when its closing parenthesis is reached
+            } else {
+                postfix.push_back(word);
+            }
         } else if (c == '(') {
-            operators.push(c);
+            operators.push(text.substr(i, 1));
+            ++i;
         } else if (c == ')') {
-            while (!operators.empty() && operators.top() != '(') {
-                postfix += operators.top();
-                postfix += ' ';
-                operators.pop();
+            while (!operators.isEmpty() && operators.top() != "(") {
+                postfix.push_back(operators.pop());
             }
-            if (!operators.empty()) {
-                operators.pop(); // Remove '('
+            if (operators.isEmpty()) {
+                throw std::runtime_error("Invalid infix expression");
             }
-        } else if (isValidOperator(std::string(1, c))) {
-            // For prefix conversion, we need to handle right associativity differently
-            while (!operators.empty() && 
-                   operators.top() != '(' &&
-                   getOperatorPrecedence(std::string(1, operators.top())) > getOperatorPrecedence(std::string(1, c))) {
-                postfix += operators.top();
-                postfix += ' ';
-                operators.pop();
+            operators.pop(); // Remove '('
+            if (!operators.isEmpty() && operators.top() != "(" && !isValidOperator(operators.top())) {
+                postfix.push_back(operators.pop()); // The function this parenthesis closes
             }
-            operators.push(c);
+            ++i;
+        } else if (c == ',') {
+            // Ends a function argument: flush it up to the call's parenthesis
+            while (!operators.isEmpty() && operators.top() != "(") {
+                postfix.push_back(operators.pop());
+            }
+            if (operators.isEmpty()) {
+                throw std::runtime_error("Invalid infix expression");
+            }
+            ++i;
+        } else if (isValidOperator(text.substr(i, 1))) {
+            pushOperator(text.substr(i, 1));
+            ++i;
+        } else {
+            throw std::runtime_error("Invalid infix expression");
         }
     }
     
-    while (!operators.empty()) {
-        postfix += operators.top();
-        postfix += ' ';
-        operators.pop();
+    while (!operators.isEmpty()) {
+        if (operators.top() == "(") {
+            throw std::runtime_error("Invalid infix expression");
+        }
+        postfix.push_back(operators.pop());
     }
     
-    // Step 3: Reverse the postfix expression to get prefix
-    std::vector<std::string> tokens = splitIntoTokens(postfix);
-    std::reverse(tokens.begin(), tokens.end());
+    if (postfix.empty()) {
+        return std::string();
+    }
     
-    std::string prefix;
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        prefix += tokens[i];
-        if (i < tokens.size() - 1) {
-            prefix += " ";
+    return postfixTokensToPrefix(postfix, infix.size(), "Invalid infix expression");
+}
+
+std::string PrefixReader::postfixToPrefix(const std::string& postfix) {
+    std::vector<std::string_view> tokens = splitIntoTokens(postfix);
+    return postfixTokensToPrefix(tokens, postfix.size(), "Invalid postfix expression");
+}
+
+std::string PrefixReader::postfixTokensToPrefix(const std::vector<std::string_view>& postfix, size_t textSize,
+                                                const char* errorMessage) const {
+    // Link every operator to the token indices of its operands (arity[i] of them
+    // in operands, from firstOperand[i]), then write the tree out in preorder.
+    // Each token is copied once, straight into the result.
+    std::vector<size_t> firstOperand(postfix.size());
+    std::vector<uint8_t> arity(postfix.size());
+    std::vector<size_t> operands;
+    operands.reserve(postfix.size());
+    SmallStack<size_t> roots;
+    
+    for (size_t i = 0; i < postfix.size(); ++i) {
+        size_t count = static_cast<size_t>(operatorArity(postfix[i]));
+        if (roots.size() < count) {
+            throw std::runtime_error(errorMessage);
         }
+        firstOperand[i] = operands.size();
+        arity[i] = static_cast<uint8_t>(count);
+        operands.resize(operands.size() + count);
+        for (size_t k = count; k-- > 0;) {
+            operands[firstOperand[i] + k] = roots.pop();
+        }
+        roots.push(i);
+    }
+    
+    if (roots.size() != 1) {
+        throw std::runtime_error(errorMessage);
     }
     
-    return prefix;
+    std::string result;
+    result.reserve(textSize + postfix.size());
+    
+    SmallStack<size_t> pending;
+    pending.push(roots.top());
+    while (!pending.isEmpty()) {
+        size_t index = pending.pop();
+        if (!result.empty()) result += ' ';
+        result += postfix[index];
+        
+        for (size_t k = arity[index]; k-- > 0;) {
+            pending.push(operands[firstOperand[index] + k]);
+        }
+    }
+    
+    return result;
 }
 
-std::string PrefixReader::postfixToPrefix(const std::string& postfix) {
-    std::vector<std::string> tokens = splitIntoTokens(postfix);
-    std::stack<std::string> stack;
+std::string PrefixReader::prefixToPostfix(const std::string& prefix) {
+    // Left to right: operators wait on a stack until all their operands have been written
+    std::vector<std::string_view> tokens = splitIntoTokens(prefix);
+    std::string result;
+    result.reserve(prefix.size());
+    
+    struct PendingOperator {
+        size_t token;
+        int remaining;
+    };
+    SmallStack<PendingOperator> pending;
+    bool complete = false;
     
-    for (const std::string& token : tokens) {
-        if (isValidOperator(token)) {
-            if (stack.size() < 2) {
-                throw std::runtime_error("Invalid postfix expression");
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (complete) {
+            throw std::runtime_error("Invalid prefix expression");
+        }
+        
+        int arity = operatorArity(tokens[i]);
+        if (arity > 0) {
+            pending.push(PendingOperator{i, arity});
+            continue;
+        }
+        
+        if (!result.empty()) result += ' ';
+        result += tokens[i];
+        
+        // An operand may finish one or more enclosing operators
+        while (true) {
+            if (pending.isEmpty()) {
+                complete = true;
+                break;
             }
-            
-            std::string operand2 = stack.top(); stack.pop();
-            std::string operand1 = stack.top(); stack.pop();
-            
-            std::string prefixExpr = token + " " + operand1 + " " + operand2;
-            stack.push(prefixExpr);
-        } else if (isValidFunction(token)) {
-            if (stack.empty()) {
-                throw std::runtime_error("Invalid postfix expression");
+            PendingOperator& top = pending.top();
+            if (--top.remaining > 0) {
+                break;
             }
-            
-            std::string operand = stack.top(); stack.pop();
-            std::string prefixExpr = token + " " + operand;
-            stack.push(prefixExpr);
-        } else {
-            stack.push(token);
+            result += ' ';
+            result += tokens[top.token];
+            pending.pop();
         }
     }
     
-    if (stack.size() != 1) {
-        throw std::runtime_error("Invalid postfix expression");
+    if (!complete) {
+        throw std::runtime_error("Invalid prefix expression");
     }
     
-    return stack.top();
+    return result;
 }
 
-std::string PrefixReader::prefixToPostfix(const std::string& prefix) {
-    std::vector<std::string> tokens = splitIntoTokens(prefix);
-    std::stack<std::string> stack;
+std::string PrefixReader::prefixToInfix(const std::string& prefix) {
+    // Left to right, emitting text as soon as it is known. Each open operator
+    // remembers whether it opened a parenthesis and how many operands are left.
+    std::vector<std::string_view> tokens = splitIntoTokens(prefix);
+    std::string result;
+    result.reserve(prefix.size() * 2);
     
-    // Process tokens from right to left
-    for (int i = static_cast<int>(tokens.size()) - 1; i >= 0; --i) {
-        const std::string& token = tokens[i];
+    struct OpenNode {
+        size_t token;
+        int remaining;
+        int precedence;
+        bool isFunction;
+        bool parenthesized;
+    };
+    SmallStack<OpenNode> open;
+    bool complete = false;
+    
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (complete) {
+            throw std::runtime_error("Invalid prefix expression");
+        }
+        std::string_view token = tokens[i];
         
-        if (isValidOperator(token)) {
-            if (stack.size() < 2) {
-                throw std::runtime_error("Invalid prefix expression");
+        // Precedence required by the slot this token fills (same rule as treeToInfix)
+        int contextPrec = -1;
+        if (!open.isEmpty() && !open.top().isFunction) {
+            const OpenNode& parent = open.top();
+            bool isLeftOperand = parent.remaining == 2;
+            bool rightAssoc = isRightAssociative(tokens[parent.token]);
+            contextPrec = parent.precedence + ((isLeftOperand == rightAssoc) ? 1 : 0);
+        }
+        
+        int arity = operatorArity(token);
+        if (arity > 0 && !isValidOperator(token)) {
+            result += token;
+            result += '(';
+            open.push(OpenNode{i, arity, -1, true, false});
+            continue;
+        }
+        if (arity == 2) {
+            int precedence = getOperatorPrecedence(token);
+            bool parenthesized = precedence < contextPrec;
+            if (parenthesized) result += '(';
+            open.push(OpenNode{i, 2, precedence, false, parenthesized});
+            continue;
+        }
+        
+        result += token;
+        
+        // Close every node this operand completes
+        while (true) {
+            if (open.isEmpty()) {
+                complete = true;
+                break;
             }
-            
-            std::string operand1 = stack.top(); stack.pop();
-            std::string operand2 = stack.top(); stack.pop();
-            
-            std::string postfixExpr = operand1 + " " + operand2 + " " + token;
-            stack.push(postfixExpr);
-        } else if (isValidFunction(token)) {
-            if (stack.empty()) {
-                throw std::runtime_error("Invalid prefix expression");
+            OpenNode& node = open.top();
+            if (--node.remaining > 0) {
+                if (node.isFunction) {
+                    result += ", ";
+                } else {
+                    result += ' ';
+                    result += tokens[node.token];
+                    result += ' ';
+                }
+                break;
             }
-            
-            std::string operand = stack.top(); stack.pop();
-            std::string postfixExpr = operand + " " + token;
-            stack.push(postfixExpr);
-        } else {
-            stack.push(token);
+            if (node.isFunction || node.parenthesized) {
+                result += ')';
+            }
+            open.pop();
         }
     }
     
-    if (stack.size() != 1) {
+    if (!complete) {
         throw std::runtime_error("Invalid prefix expression");
     }
     
-    return stack.top();
+    return result;
 }
 
-std::string PrefixReader::prefixToInfix(const std::string& prefix) {
+std::string PrefixReader::prefixToInfixRecursive(const std::string& prefix) {
     std::vector<PrefixToken> tokens = readFromString(prefix);
-    int index = 0;
-    ExprNode* tree = buildExpressionTree(tokens, index);
+    Arena arena;
+    StringInterner names(arena);
+    ExprNode* tree = buildExpressionTree(tokens, arena, names);
     
     if (tree == nullptr) {
         throw std::runtime_error("Failed to build expression tree");
     }
     
-    std::string result = treeToInfix(tree);
-    delete tree;
-    
-    return result;
+    return treeToInfix(tree); // The arena releases every node on return
 }
 
 double PrefixReader::evaluatePrefix(const std::vector<PrefixToken>& tokens) {
+    if (tokens.empty()) {
+        throw std::invalid_argument("Invalid prefix expression");
+    }
+    
+    // Right to left: operands are pushed, each operator combines the two on top
+    SmallStack<double> operands;
+    
+    for (size_t i = tokens.size(); i-- > 0;) {
+        const PrefixToken& token = tokens[i];
+        
+        switch (token.type) {
+            case PrefixTokenType::NUMBER:
+                operands.push(token.numericValue);
+                break;
+                
+            case PrefixTokenType::VARIABLE:
+                operands.push(getVariable(token.value));
+                break;
+                
+            case PrefixTokenType::FUNCTION: {
+                uint32_t id = 0;
+                size_t arity = symbols.find(token.value, id) ? symbols.getCallArity(id) : 0;
+                if (arity == 0) {
+                    throw std::runtime_error("Unknown function: " + token.value);
+                }
+                if (operands.size() < arity) {
+                    throw std::invalid_argument("Invalid prefix expression");
+                }
+                double arguments[MAX_FUNCTION_ARITY];
+                popCallArguments(operands, arity, true, arguments);
+                operands.push(callAnyFunction(symbols, id, arguments, true));
+                break;
+            }
+            
+            case PrefixTokenType::OPERATOR: {
+                if (operands.size() < 2) {
+                    throw std::invalid_argument("Invalid prefix expression");
+                }
+                double left = operands.pop();
+                double& right = operands.top();
+                right = applyOperator(token.value, left, right);
+                break;
+            }
+            
+            case PrefixTokenType::INVALID:
+                throw std::invalid_argument("Invalid prefix expression");
+        }
+    }
+    
+    if (operands.size() != 1) {
+        throw std::invalid_argument("Invalid prefix expression");
+    }
+    
+    return operands.top();
+}
+
+double PrefixReader::evaluatePrefixRecursive(const std::vector<PrefixToken>& tokens) {
     if (!validatePrefixExpression(tokens)) {
         throw std::invalid_argument("Invalid prefix expression");
     }
@@ -330,54 +508,197 @@ double PrefixReader::evaluatePrefix(const std::vector<PrefixToken>& tokens) {
     return evaluatePrefixRecursive(tokens, index);
 }
 
+
 double PrefixReader::evaluatePrefix(const std::string& prefix) {
-    std::vector<PrefixToken> tokens = readFromString(prefix);
-    return evaluatePrefix(tokens);
+    // Names are looked up, not interned: one-off text must not grow the symbol table
+    std::vector<std::string_view> unknownNames;
+    if (!programCache) {
+        std::vector<CompactToken> program;
+        compileCompactProgramReadOnly(prefix, symbols, true, program, unknownNames);
+        lowerConditionals(program, true);
+        return evaluateCompactProgram(program.rbegin(), program.rend(), symbols, true, "Invalid prefix expression",
+                                      nullptr, 0, &unknownNames);
+    }
+    
+    std::string key = ExpressionCache<double>::normalize(prefix);
+    
+    double result = 0.0;
+    if (resultCache->lookup(key, result)) {
+        return result;
+    }
+    
+    std::shared_ptr<const CompiledPrefix> compiled;
+    if (!programCache->lookup(key, compiled)) {
+        auto fresh = std::make_shared<CompiledPrefix>();
+        compileCompactProgramReadOnly(key, symbols, true, fresh->program, unknownNames);
+        lowerConditionals(fresh->program, true);
+        if (!unknownNames.empty()) {
+            // Not cached: those names would keep their placeholder ids after being defined
+            return evaluateCompactProgram(fresh->program.rbegin(), fresh->program.rend(), symbols, true,
+                                          "Invalid prefix expression", nullptr, 0, &unknownNames);
+        }
+        fresh->hasVariables = std::any_of(fresh->program.begin(), fresh->program.end(), [](const CompactToken& token) {
+            return token.op == OpCode::VARIABLE;
+        });
+        compiled = fresh;
+        programCache->insert(key, compiled);
+    }
+    
+    result = evaluateCompiled(compiled->program);
+    if (!compiled->hasVariables) {
+        resultCache->insert(key, result);
+    }
+    
+    return result;
+}
+
+std::vector<CompactToken> PrefixReader::compile(std::string_view expression) {
+    std::vector<CompactToken> program;
+    compile(expression, program);
+    return program;
+}
+
+void PrefixReader::compile(std::string_view expression, std::vector<CompactToken>& program) {
+    compileCompactProgram(expression, symbols, true, program);
+    lowerConditionals(program, true);
+}
+
+double PrefixReader::evaluateCompiled(const std::vector<CompactToken>& program) const {
+    return evaluateCompactProgram(program.rbegin(), program.rend(), symbols, true, "Invalid prefix expression");
+}
+
+EvalResult PrefixReader::tryEvaluatePrefix(std::string_view prefix) const {
+    return tryEvaluateSymbolic(prefix, symbols, true);
+}
+
+void PrefixReader::saveCompiled(const std::string& filename, const std::vector<std::vector<CompactToken>>& programs) const {
+    ProgramFile::write(filename, programs, symbols, true);
+}
+
+ProgramFile PrefixReader::loadCompiled(const std::string& filename) {
+    ProgramFile file(filename);
+    if (!file.isPrefixOrder()) {
+        throw std::invalid_argument("Not a prefix program file: " + filename);
+    }
+    file.bind(symbols);
+    return file;
+}
+
+double PrefixReader::evaluateCompiled(const ProgramFile& file, size_t program) const {
+    return file.evaluate(program, symbols);
+}
+
+const SymbolTable& PrefixReader::getSymbols() const {
+    return symbols;
+}
+
+size_t PrefixReader::addFormula(std::string_view prefix) {
+    return formulas.add(prefix, symbols, true);
+}
+
+std::vector<double> PrefixReader::evaluateFormulas() {
+    std::vector<double> results;
+    evaluateFormulas(results);
+    return results;
+}
+
+size_t PrefixReader::evaluateFormulas(std::vector<double>& results, std::vector<std::string>* errors) {
+    return formulas.evaluate(symbols, results, errors);
+}
+
+const ExpressionDag& PrefixReader::getFormulas() const {
+    return formulas;
+}
+
+void PrefixReader::clearFormulas() {
+    formulas.clear();
+}
+
+void PrefixReader::enableCache(size_t capacity, EvictionPolicy policy) {
+    programCache.create(capacity, policy);
+    resultCache.create(capacity, policy);
+}
+
+void PrefixReader::disableCache() {
+    programCache.reset();
+    resultCache.reset();
+}
+
+CacheStats PrefixReader::getProgramCacheStats() const {
+    return programCache ? programCache->getStats() : CacheStats();
+}
+
+CacheStats PrefixReader::getResultCacheStats() const {
+    return resultCache ? resultCache->getStats() : CacheStats();
 }
 
 // Helper function implementations
 void PrefixReader::setVariable(const std::string& name, double value) {
-    variables[name] = value;
+    symbols.setVariable(name, value);
 }
 
 void PrefixReader::setVariables(const std::unordered_map<std::string, double>& vars) {
     for (const auto& pair : vars) {
-        variables[pair.first] = pair.second;
+        symbols.setVariable(pair.first, pair.second);
     }
 }
 
 void PrefixReader::setFunction(const std::string& name, std::function<double(double)> func) {
-    functions[name] = func;
+    symbols.setFunction(name, std::move(func));
+    
+    // Cached tokens were classified (and results computed) with the old function set
+    if (programCache) {
+        programCache->clear();
+        resultCache->clear();
+    }
 }
 
-double PrefixReader::getVariable(const std::string& name) const {
-    auto it = variables.find(name);
-    if (it != variables.end()) {
-        return it->second;
+void PrefixReader::setFunction(const std::string& name, NaryFunction func, size_t arity) {
+    symbols.setFunction(name, func, arity);
+    
+    if (programCache) {
+        programCache->clear();
+        resultCache->clear();
     }
-    throw std::runtime_error("Undefined variable: " + name);
 }
 
-bool PrefixReader::isValidOperator(const std::string& token) const {
+void PrefixReader::defineFunction(const std::string& name, const std::vector<std::string>& parameters, std::string_view body) {
+    defineInlineFunction(symbols, name, parameters, body, true);
+    
+    if (programCache) {
+        programCache->clear();
+        resultCache->clear();
+    }
+}
+
+double PrefixReader::getVariable(std::string_view name) const {
+    double value = 0.0;
+    if (symbols.findVariable(name, value)) {
+        return value;
+    }
+    throw std::runtime_error("Undefined variable: " + std::string(name));
+}
+
+bool PrefixReader::isValidOperator(std::string_view token) const {
     return std::find(validOperators.begin(), validOperators.end(), token) != validOperators.end();
 }
 
 bool PrefixReader::isValidFunction(const std::string& token) const {
-    return functions.find(token) != functions.end();
+    return symbols.getCallArity(token) != 0;
 }
 
 bool PrefixReader::isValidVariable(const std::string& token) const {
     return isValidIdentifier(token) && !isValidFunction(token) && !isValidOperator(token);
 }
 
-int PrefixReader::getOperatorPrecedence(const std::string& op) const {
+int PrefixReader::getOperatorPrecedence(std::string_view op) const {
     if (op == "+" || op == "-") return 1;
     if (op == "*" || op == "/" || op == "%" || op == "mod" || op == "div") return 2;
     if (op == "^" || op == "pow") return 3;
     return 0;
 }
 
-bool PrefixReader::isRightAssociative(const std::string& op) const {
+bool PrefixReader::isRightAssociative(std::string_view op) const {
     return op == "^" || op == "pow";
 }
 
@@ -409,66 +730,138 @@ void PrefixReader::displayTokens(const std::vector<PrefixToken>& tokens) const {
     std::cout << "Valid prefix: " << (validatePrefixExpression(tokens) ? "YES" : "NO") << std::endl;
 }
 
-// Continue with remaining implementations...
-void PrefixReader::initializeBuiltInFunctions() {
-    functions["sin"] = [](double x) { return std::sin(x); };
-    functions["cos"] = [](double x) { return std::cos(x); };
-    functions["tan"] = [](double x) { return std::tan(x); };
-    functions["log"] = [](double x) { return std::log(x); };
-    functions["ln"] = [](double x) { return std::log(x); };
-    functions["log10"] = [](double x) { return std::log10(x); };
-    functions["sqrt"] = [](double x) { return std::sqrt(x); };
-    functions["abs"] = [](double x) { return std::abs(x); };
-    functions["floor"] = [](double x) { return std::floor(x); };
-    functions["ceil"] = [](double x) { return std::ceil(x); };
-    functions["exp"] = [](double x) { return std::exp(x); };
-    functions["asin"] = [](double x) { return std::asin(x); };
-    functions["acos"] = [](double x) { return std::acos(x); };
-    functions["atan"] = [](double x) { return std::atan(x); };
-}
-
-bool PrefixReader::isNumber(const std::string& str) const {
-    if (str.empty()) return false;
-    
-    size_t start = 0;
-    if (str[0] == '-' || str[0] == '+') {
-        start = 1;
-        if (str.length() == 1) return false;
-    }
-    
-    bool hasDecimal = false;
-    for (size_t i = start; i < str.length(); ++i) {
-        if (str[i] == '.') {
-            if (hasDecimal) return false;
-            hasDecimal = true;
-        } else if (!std::isdigit(str[i])) {
-            return false;
+bool PrefixReader::validateWithDetails(const std::vector<PrefixToken>& tokens, std::string& errorMessage) {
+    if (tokens.empty()) {
+        errorMessage = "Empty expression";
+        return false;
+    }
+    
+    int operandCount = 0;
+    
+    // Process tokens from right to left
+    for (int i = static_cast<int>(tokens.size()) - 1; i >= 0; --i) {
+        const PrefixToken& token = tokens[i];
+        
+        switch (token.type) {
+            case PrefixTokenType::NUMBER:
+            case PrefixTokenType::VARIABLE:
+                operandCount++;
+                break;
+                
+            case PrefixTokenType::FUNCTION: {
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity == 0) {
+                    errorMessage = "Unknown function '" + token.value + 
+                                 "' at position " + std::to_string(i + 1);
+                    return false;
+                }
+                if (operandCount < arity) {
+                    errorMessage = "Insufficient operands for function '" + token.value + 
+                                 "' at position " + std::to_string(i + 1);
+                    return false;
+                }
+                operandCount -= arity - 1;
+                break;
+            }
+                
+            case PrefixTokenType::OPERATOR:
+                if (operandCount < 2) {
+                    errorMessage = "Insufficient operands for operator '" + token.value + 
+                                 "' at position " + std::to_string(i + 1);
+                    return false;
+                }
+                operandCount--;
+                break;
+                
+            case PrefixTokenType::INVALID:
+                errorMessage = "Invalid token '" + token.value + "' at position " + std::to_string(i + 1);
+                return false;
         }
     }
     
+    if (operandCount != 1) {
+        errorMessage = "Expression has " + std::to_string(operandCount) + 
+                     " unprocessed operands (should be exactly 1)";
+        return false;
+    }
+    
+    errorMessage = "Valid prefix expression";
     return true;
 }
 
-bool PrefixReader::isValidIdentifier(const std::string& str) const {
-    if (str.empty() || !std::isalpha(str[0])) {
-        return false;
-    }
+bool PrefixReader::hasCorrectPrefixStructure(const std::vector<PrefixToken>& tokens) {
+    auto counts = countOperandsAndOperators(tokens);
     
-    for (char c : str) {
-        if (!std::isalnum(c) && c != '_') {
-            return false;
+    // For a valid prefix expression: operands = operators + 1
+    return counts.first == counts.second + 1;
+}
+
+std::pair<int, int> PrefixReader::countOperandsAndOperators(const std::vector<PrefixToken>& tokens) {
+    int operands = 0;
+    int operators = 0;
+    
+    for (const PrefixToken& token : tokens) {
+        switch (token.type) {
+            case PrefixTokenType::NUMBER:
+            case PrefixTokenType::VARIABLE:
+                operands++;
+                break;
+            case PrefixTokenType::OPERATOR:
+                operators++;
+                break;
+            case PrefixTokenType::FUNCTION: {
+                // A function of n arguments joins n operands, like n - 1 binary operators
+                int arity = static_cast<int>(symbols.getCallArity(token.value));
+                if (arity > 1) {
+                    operators += arity - 1;
+                }
+                break;
+            }
+            case PrefixTokenType::INVALID:
+                break;
         }
     }
     
-    return true;
+    return std::make_pair(operands, operators);
+}
+
+// Continue with remaining implementations...
+void PrefixReader::initializeBuiltInFunctions() {
+    symbols.setFunction("sin", [](const double* x) { return std::sin(x[0]); }, 1);
+    symbols.setFunction("cos", [](const double* x) { return std::cos(x[0]); }, 1);
+    symbols.setFunction("tan", [](const double* x) { return std::tan(x[0]); }, 1);
+    symbols.setFunction("log", [](const double* x) { return std::log(x[0]); }, 1);
+    symbols.setFunction("ln", [](const double* x) { return std::log(x[0]); }, 1);
+    symbols.setFunction("log10", [](const double* x) { return std::log10(x[0]); }, 1);
+    symbols.setFunction("sqrt", [](const double* x) { return std::sqrt(x[0]); }, 1);
+    symbols.setFunction("abs", [](const double* x) { return std::abs(x[0]); }, 1);
+    symbols.setFunction("floor", [](const double* x) { return std::floor(x[0]); }, 1);
+    symbols.setFunction("ceil", [](const double* x) { return std::ceil(x[0]); }, 1);
+    symbols.setFunction("exp", [](const double* x) { return std::exp(x[0]); }, 1);
+    symbols.setFunction("asin", [](const double* x) { return std::asin(x[0]); }, 1);
+    symbols.setFunction("acos", [](const double* x) { return std::acos(x[0]); }, 1);
+    symbols.setFunction("atan", [](const double* x) { return std::atan(x[0]); }, 1);
+    symbols.setFunction("min", [](const double* x) { return std::min(x[0], x[1]); }, 2);
+    symbols.setFunction("max", [](const double* x) { return std::max(x[0], x[1]); }, 2);
+    symbols.setFunction("atan2", [](const double* x) { return std::atan2(x[0], x[1]); }, 2);
+    symbols.setFunction("hypot", [](const double* x) { return std::hypot(x[0], x[1]); }, 2);
+    symbols.setFunction("clamp", [](const double* x) { return std::min(std::max(x[0], x[1]), x[2]); }, 3);
 }
 
-PrefixTokenType PrefixReader::determineTokenType(const std::string& token) {
+bool PrefixReader::isNumber(std::string_view str) const {
+    return ExpressionLexer::isNumber(str);
+}
+
+bool PrefixReader::isValidIdentifier(std::string_view str) const {
+    return ExpressionLexer::isIdentifier(str);
+}
+
+PrefixTokenType PrefixReader::determineTokenType(std::string_view token) {
     if (isNumber(token)) {
         return PrefixTokenType::NUMBER;
     } else if (isValidOperator(token)) {
         return PrefixTokenType::OPERATOR;
-    } else if (isValidFunction(token)) {
+    } else if (isValidFunction(std::string(token))) {
         return PrefixTokenType::FUNCTION;
     } else if (isValidIdentifier(token)) {
         return PrefixTokenType::VARIABLE;
@@ -477,43 +870,53 @@ PrefixTokenType PrefixReader::determineTokenType(const std::string& token) {
     }
 }
 
-std::vector<std::string> PrefixReader::splitIntoTokens(const std::string& expression) {
-    std::vector<std::string> tokens;
-    std::istringstream iss(expression);
-    std::string token;
-    
-    while (iss >> token) {
-        tokens.push_back(token);
+double PrefixReader::applyOperator(std::string_view op, double left, double right) const {
+    if (op == "+") return left + right;
+    if (op == "-") return left - right;
+    if (op == "*") return left * right;
+    if (op == "/" || op == "div") {
+        if (right == 0) throw std::runtime_error("Division by zero");
+        return left / right;
+    }
+    if (op == "^" || op == "pow") return std::pow(left, right);
+    if (op == "%" || op == "mod") {
+        if (right == 0) throw std::runtime_error("Modulo by zero");
+        return std::fmod(left, right);
     }
     
-    return tokens;
+    throw std::runtime_error("Unknown operator: " + std::string(op));
 }
 
-std::string PrefixReader::trim(const std::string& str) {
-    size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) {
-        return "";
-    }
-    
-    size_t end = str.find_last_not_of(" \t\n\r");
-    return str.substr(start, end - start + 1);
+int PrefixReader::operatorArity(std::string_view token) const {
+    if (isValidOperator(token)) return 2;
+    return static_cast<int>(symbols.getCallArity(token));
 }
 
-std::vector<std::string> PrefixReader::readLinesFromFile(const std::string& filename) {
-    std::vector<std::string> lines;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + filename);
+PrefixToken PrefixReader::makeToken(std::string_view tokenStr) {
+    if (tokenStr.empty()) {
+        return PrefixToken(PrefixTokenType::INVALID, std::string());
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        lines.push_back(line);
+    PrefixTokenType type = determineTokenType(tokenStr);
+    
+    if (type == PrefixTokenType::NUMBER) {
+        double value = 0.0;
+        if (!ExpressionLexer::parseNumber(tokenStr, value)) {
+            return PrefixToken(PrefixTokenType::INVALID, std::string(tokenStr));
+        }
+        return PrefixToken(type, std::string(tokenStr), value);
     }
     
-    file.close();
-    return lines;
+    return PrefixToken(type, std::string(tokenStr));
+}
+
+std::vector<std::string_view> PrefixReader::splitIntoTokens(std::string_view expression) {
+    std::vector<std::string_view> tokens;
+    ExpressionLexer::forEachToken(expression, [&](std::string_view token) {
+        tokens.push_back(token);
+    });
+    
+    return tokens;
 }
 
 double PrefixReader::evaluatePrefixRecursive(const std::vector<PrefixToken>& tokens, int& index) {
@@ -527,43 +930,26 @@ double PrefixReader::evaluatePrefixRecursive(const std::vector<PrefixToken>& tok
         case PrefixTokenType::NUMBER:
             return token.numericValue;
             
-        case PrefixTokenType::VARIABLE: {
-            auto it = variables.find(token.value);
-            if (it != variables.end()) {
-                return it->second;
-            } else {
-                throw std::runtime_error("Undefined variable: " + token.value);
-            }
-        }
+        case PrefixTokenType::VARIABLE:
+            return getVariable(token.value);
         
         case PrefixTokenType::FUNCTION: {
-            double operand = evaluatePrefixRecursive(tokens, index);
-            auto it = functions.find(token.value);
-            if (it != functions.end()) {
-                return it->second(operand);
-            } else {
+            uint32_t id = 0;
+            size_t arity = symbols.find(token.value, id) ? symbols.getCallArity(id) : 0;
+            if (arity == 0) {
                 throw std::runtime_error("Unknown function: " + token.value);
             }
+            double arguments[MAX_FUNCTION_ARITY];
+            for (size_t k = 0; k < arity; ++k) {
+                arguments[k] = evaluatePrefixRecursive(tokens, index);
+            }
+            return callAnyFunction(symbols, id, arguments, true);
         }
         
         case PrefixTokenType::OPERATOR: {
             double left = evaluatePrefixRecursive(tokens, index);
             double right = evaluatePrefixRecursive(tokens, index);
-            
-            if (token.value == "+") return left + right;
-            if (token.value == "-") return left - right;
-            if (token.value == "*") return left * right;
-            if (token.value == "/" || token.value == "div") {
-                if (right == 0) throw std::runtime_error("Division by zero");
-                return left / right;
-            }
-            if (token.value == "^" || token.value == "pow") return std::pow(left, right);
-            if (token.value == "%" || token.value == "mod") {
-                if (right == 0) throw std::runtime_error("Modulo by zero");
-                return std::fmod(left, right);
-            }
-            
-            throw std::runtime_error("Unknown operator: " + token.value);
+            return applyOperator(token.value, left, right);
         }
         
         default:
@@ -571,25 +957,49 @@ double PrefixReader::evaluatePrefixRecursive(const std::vector<PrefixToken>& tok
     }
 }
 
-PrefixReader::ExprNode* PrefixReader::buildExpressionTree(const std::vector<PrefixToken>& tokens, int& index) {
-    if (index >= static_cast<int>(tokens.size())) {
-        return nullptr;
-    }
+PrefixReader::ExprNode* PrefixReader::buildExpressionTree(const std::vector<PrefixToken>& tokens, Arena& arena, StringInterner& names) {
+    // Right-to-left with an explicit stack: no recursion, so chain depth is not bounded by the call stack
+    SmallStack<ExprNode*> pending;
     
-    const PrefixToken& token = tokens[index++];
+    for (int i = static_cast<int>(tokens.size()) - 1; i >= 0; --i) {
+        const PrefixToken& token = tokens[i];
+        std::string_view value = names.intern(token.value);
+        
+        if (token.type == PrefixTokenType::OPERATOR) {
+            if (pending.size() < 2) {
+                throw std::runtime_error("Invalid prefix expression");
+            }
+            ExprNode* node = arena.create<ExprNode>(value, true);
+            node->left = pending.pop();
+            node->right = pending.pop();
+            pending.push(node);
+        } else if (token.type == PrefixTokenType::FUNCTION) {
+            size_t arity = symbols.getCallArity(token.value);
+            if (arity == 0 || pending.size() < arity) {
+                throw std::runtime_error("Invalid prefix expression");
+            }
+            // Arguments are on top, first one uppermost; chain them through next
+            ExprNode* node = arena.create<ExprNode>(value, true, true);
+            node->left = pending.pop();
+            ExprNode* last = node->left;
+            for (size_t k = 1; k < arity; ++k) {
+                last->next = pending.pop();
+                last = last->next;
+            }
+            pending.push(node);
+        } else {
+            pending.push(arena.create<ExprNode>(value, false));
+        }
+    }
     
-    if (token.type == PrefixTokenType::OPERATOR) {
-        ExprNode* node = new ExprNode(token.value, true);
-        node->left = buildExpressionTree(tokens, index);
-        node->right = buildExpressionTree(tokens, index);
-        return node;
-    } else if (token.type == PrefixTokenType::FUNCTION) {
-        ExprNode* node = new ExprNode(token.value, true);
-        node->left = buildExpressionTree(tokens, index);
-        return node;
-    } else {
-        return new ExprNode(token.value, false);
+    if (pending.isEmpty()) {
+        return nullptr;
+    }
+    if (pending.size() != 1) {
+        throw std::runtime_error("Invalid prefix expression");
     }
+    
+    return pending.top();
 }
 
 std::string PrefixReader::treeToInfix(ExprNode* node, int parentPrec) {
@@ -598,11 +1008,18 @@ std::string PrefixReader::treeToInfix(ExprNode* node, int parentPrec) {
     }
     
     if (!node->isOperator) {
-        return node->value;
+        return std::string(node->value);
     }
     
-    if (isValidFunction(node->value)) {
-        return node->value + "(" + treeToInfix(node->left) + ")";
+    if (node->isFunction) {
+        std::string result(node->value);
+        result += "(";
+        for (ExprNode* argument = node->left; argument != nullptr; argument = argument->next) {
+            if (argument != node->left) result += ", ";
+            result += treeToInfix(argument);
+        }
+        result += ")";
+        return result;
     }
     
     int currentPrec = getOperatorPrecedence(node->value);
@@ -612,9 +1029,14 @@ std::string PrefixReader::treeToInfix(ExprNode* node, int parentPrec) {
         result += "(";
     }
     
-    result += treeToInfix(node->left, currentPrec);
-    result += " " + node->value + " ";
-    result += treeToInfix(node->right, currentPrec);
+    // An operand with equal precedence needs parentheses on the side that
+    // associativity does not group implicitly, e.g. a - (b - c), (a ^ b) ^ c
+    bool rightAssoc = isRightAssociative(node->value);
+    result += treeToInfix(node->left, currentPrec + (rightAssoc ? 1 : 0));
+    result += " ";
+    result += node->value;
+    result += " ";
+    result += treeToInfix(node->right, currentPrec + (rightAssoc ? 0 : 1));
     
     if (currentPrec < parentPrec) {
         result += ")";
@@ -6,6 +6,18 @@
 #include <unordered_map>
 #include <functional>
 #include <algorithm>
+#include <string_view>
+#include <stdexcept>
+#include <memory>
+#include "../expression_core/ExpressionLexer.h"
+#include "../expression_core/TokenText.h"
+#include "../expression_core/ExpressionCache.h"
+#include "../expression_core/Arena.h"
+#include "../expression_core/SmallStack.h"
+#include "../expression_core/CompactToken.h"
+#include "../expression_core/ProgramFile.h"
+#include "../expression_core/NumericEngine.h"
+#include "../expression_core/ExpressionDag.h"
 
 // Token types for prefix expressions
 enum class PrefixTokenType {
@@ -19,16 +31,16 @@ enum class PrefixTokenType {
 // Token structure for prefix expressions
 struct PrefixToken {
     PrefixTokenType type;
-    std::string value;
+    TokenText value;
     double numericValue;
     
-    PrefixToken() : type(PrefixTokenType::INVALID), value(""), numericValue(0.0) {}
-    PrefixToken(PrefixTokenType t, const std::string& v) : type(t), value(v), numericValue(0.0) {
-        if (t == PrefixTokenType::NUMBER) {
-            numericValue = std::stod(v);
+    PrefixToken() : type(PrefixTokenType::INVALID), numericValue(0.0) {}
+    PrefixToken(PrefixTokenType t, std::string_view v) : type(t), value(v), numericValue(0.0) {
+        if (t == PrefixTokenType::NUMBER && !ExpressionLexer::parseNumber(v, numericValue)) {
+            throw std::invalid_argument("Invalid number: " + std::string(v));
         }
     }
-    PrefixToken(PrefixTokenType t, const std::string& v, double num) : type(t), value(v), numericValue(num) {}
+    PrefixToken(PrefixTokenType t, std::string_view v, double num) : type(t), value(v), numericValue(num) {}
 };
 
 class PrefixReader {
@@ -37,7 +49,10 @@ public:
     PrefixReader();
     
     // Read prefix expression from string
-    std::vector<PrefixToken> readFromString(const std::string& expression);
+    std::vector<PrefixToken> readFromString(std::string_view expression);
+    
+    // Read into an existing vector (cleared first) so callers can reuse its storage
+    void readFromString(std::string_view expression, std::vector<PrefixToken>& tokens);
     
     // Read prefix expression from file
     std::vector<PrefixToken> readFromFile(const std::string& filename);
@@ -45,28 +60,34 @@ public:
     // Read multiple expressions from file (one per line)
     std::vector<std::vector<PrefixToken>> readMultipleFromFile(const std::string& filename);
     
+    // Stream expressions from a memory-mapped file (one per line) without loading them all.
+    // The token vector handed to the callback is reused for the next line.
+    // Returns the number of expressions delivered.
+    size_t forEachExpressionInFile(const std::string& filename,
+                                   const std::function<void(const std::vector<PrefixToken>& tokens, size_t lineNumber)>& callback);
+    
     // Validate prefix expression
-    bool validatePrefixExpression(const std::vector<PrefixToken>& tokens);
+    bool validatePrefixExpression(const std::vector<PrefixToken>& tokens) const;
     
     // Convert tokens back to string
-    std::string tokensToString(const std::vector<PrefixToken>& tokens);
+    std::string tokensToString(const std::vector<PrefixToken>& tokens) const;
     
     // Parse and validate individual token
     PrefixToken parseToken(const std::string& tokenStr);
     
     // Get token type as string
-    std::string getTokenTypeString(PrefixTokenType type);
+    std::string getTokenTypeString(PrefixTokenType type) const;
     
-    // Convert infix to prefix
+    // Convert infix to prefix (shunting-yard, linear time)
     std::string infixToPrefix(const std::string& infix);
     
-    // Convert postfix to prefix
+    // Convert postfix to prefix (linear time)
     std::string postfixToPrefix(const std::string& postfix);
     
-    // Convert prefix to postfix
+    // Convert prefix to postfix (iterative, linear time)
     std::string prefixToPostfix(const std::string& prefix);
     
-    // Convert prefix to infix (with minimal parentheses)
+    // Convert prefix to infix with minimal parentheses (iterative, linear time)
     std::string prefixToInfix(const std::string& prefix);
     
     // Set custom variables
@@ -76,11 +97,21 @@ public:
     // Set custom functions
     void setFunction(const std::string& name, std::function<double(double)> func);
     
+    // Function of arity arguments (1 to MAX_FUNCTION_ARITY) as a plain pointer,
+    // called directly with its arguments in order: "min a b" is min(a, b)
+    void setFunction(const std::string& name, NaryFunction func, size_t arity);
+    
+    // Function written as a prefix expression over its parameters, e.g.
+    // defineFunction("lerp", {"a", "b", "t"}, "+ a * - b a t"). Programs compiled
+    // afterwards contain its body in place of each call; the token-vector APIs
+    // (evaluatePrefix(tokens), validation, conversion) run the body instead.
+    void defineFunction(const std::string& name, const std::vector<std::string>& parameters, std::string_view body);
+    
     // Get variable value
-    double getVariable(const std::string& name) const;
+    double getVariable(std::string_view name) const;
     
     // Check if token is valid operator
-    bool isValidOperator(const std::string& token) const;
+    bool isValidOperator(std::string_view token) const;
     
     // Check if token is valid function
     bool isValidFunction(const std::string& token) const;
@@ -89,10 +120,10 @@ public:
     bool isValidVariable(const std::string& token) const;
     
     // Get operator precedence
-    int getOperatorPrecedence(const std::string& op) const;
+    int getOperatorPrecedence(std::string_view op) const;
     
     // Check if operator is right associative
-    bool isRightAssociative(const std::string& op) const;
+    bool isRightAssociative(std::string_view op) const;
     
     // Display token information
     void displayTokens(const std::vector<PrefixToken>& tokens) const;
@@ -106,57 +137,157 @@ public:
     // Count operands and operators
     std::pair<int, int> countOperandsAndOperators(const std::vector<PrefixToken>& tokens);
     
-    // Evaluate prefix expression (basic evaluation)
+    // Evaluate prefix expression: one right-to-left pass over an explicit stack,
+    // so nesting depth is limited only by memory. Text is compiled for this call
+    // only, with names looked up but never added to the symbol table; use
+    // compile() for programs that are kept.
     double evaluatePrefix(const std::vector<PrefixToken>& tokens);
     double evaluatePrefix(const std::string& prefix);
+    
+    // Same, without exceptions: an error code and the byte offset of the bad token
+    EvalResult tryEvaluatePrefix(std::string_view prefix) const;
+    
+    // Evaluate with the number type chosen at compile time (see expression_core/Numeric.h).
+    // Uses the given variables and the type's builtins, not the reader's double-valued ones.
+    template<typename T>
+    T evaluatePrefixAs(const std::string& prefix,
+                       const std::unordered_map<std::string, T>& vars = std::unordered_map<std::string, T>()) const {
+        return evaluateNumeric<T>(prefix, true, vars);
+    }
+    
+    // Compile to 16-byte tokens whose names are resolved to symbol ids once,
+    // so evaluateCompiled indexes arrays instead of hashing strings.
+    // Comparisons (< <= > >= == !=), && and || and the conditional ? (condition,
+    // then, else: "? > x 0 / x y 0") compile to jumps, so the operand not needed
+    // is never evaluated and cannot fail.
+    std::vector<CompactToken> compile(std::string_view expression);
+    void compile(std::string_view expression, std::vector<CompactToken>& program);
+    double evaluateCompiled(const std::vector<CompactToken>& program) const;
+    
+    // Binary program catalogs (see expression_core/ProgramFile.h): save compiled
+    // programs once, then map the file at startup instead of parsing text again.
+    // loadCompiled binds the file's names to this reader's symbols; evaluate its
+    // programs with this reader or a copy of it.
+    void saveCompiled(const std::string& filename, const std::vector<std::vector<CompactToken>>& programs) const;
+    ProgramFile loadCompiled(const std::string& filename);
+    double evaluateCompiled(const ProgramFile& file, size_t program) const;
+    
+    // Names, variable values and functions, indexed by symbol id
+    const SymbolTable& getSymbols() const;
+    
+    // Shared formula store: identical subexpressions across all added formulas
+    // are stored once and evaluated once per evaluateFormulas() call, with the
+    // reader's current variables. Names are classified as functions or
+    // variables when the formula is added.
+    size_t addFormula(std::string_view prefix);
+    // A formula that fails gets NaN (and its message in errors) without
+    // stopping the others; returns the number of failed formulas
+    std::vector<double> evaluateFormulas();
+    size_t evaluateFormulas(std::vector<double>& results, std::vector<std::string>* errors = nullptr);
+    const ExpressionDag& getFormulas() const;
+    void clearFormulas();
+    
+    // Recursive reference implementations (one call per operator), kept for
+    // comparison and benchmarking; deep inputs can exhaust the call stack
+    double evaluatePrefixRecursive(const std::vector<PrefixToken>& tokens);
+    std::string prefixToInfixRecursive(const std::string& prefix);
+    
+    // Optional memoization for evaluatePrefix(const std::string&): compiled programs
+    // are cached for every expression, results only for variable-free ones.
+    // A copy of a reader starts with empty caches of the same size and policy, since
+    // it has its own function table; setFunction() clears them.
+    void enableCache(size_t capacity = 4096, EvictionPolicy policy = EvictionPolicy::LRU);
+    void disableCache();
+    CacheStats getProgramCacheStats() const;
+    CacheStats getResultCacheStats() const;
 
 private:
-    // Internal variables and functions storage
-    std::unordered_map<std::string, double> variables;
-    std::unordered_map<std::string, std::function<double(double)>> functions;
+    // Variables and functions, stored by symbol id
+    SymbolTable symbols;
+    
+    // Formulas added with addFormula
+    ExpressionDag formulas;
     
     // Valid operators
     std::vector<std::string> validOperators;
     
+    // One reader's cache (null while caching is disabled). Copying it makes a new,
+    // empty cache with the same capacity and policy instead of sharing entries.
+    template<typename Value>
+    class ReaderCache {
+    public:
+        ReaderCache() = default;
+        ReaderCache(const ReaderCache& other) { copyShape(other); }
+        ReaderCache& operator=(const ReaderCache& other) {
+            if (this != &other) copyShape(other);
+            return *this;
+        }
+        ReaderCache(ReaderCache&&) noexcept = default;
+        ReaderCache& operator=(ReaderCache&&) noexcept = default;
+        
+        void create(size_t capacity, EvictionPolicy policy) {
+            cache = std::make_unique<ExpressionCache<Value>>(capacity, policy);
+        }
+        void reset() { cache.reset(); }
+        explicit operator bool() const { return cache != nullptr; }
+        ExpressionCache<Value>* operator->() const { return cache.get(); }
+        
+    private:
+        std::unique_ptr<ExpressionCache<Value>> cache;
+        
+        void copyShape(const ReaderCache& other) {
+            if (other.cache) {
+                create(other.cache->getCapacity(), other.cache->getPolicy());
+            } else {
+                cache.reset();
+            }
+        }
+    };
+    
+    // Memoization caches
+    struct CompiledPrefix {
+        std::vector<CompactToken> program;
+        bool hasVariables;
+    };
+    ReaderCache<std::shared_ptr<const CompiledPrefix>> programCache;
+    ReaderCache<double> resultCache;
+    
     // Built-in functions
     void initializeBuiltInFunctions();
     
     // Helper functions
-    bool isNumber(const std::string& str) const;
-    bool isValidIdentifier(const std::string& str) const;
-    PrefixTokenType determineTokenType(const std::string& token);
+    bool isNumber(std::string_view str) const;
+    bool isValidIdentifier(std::string_view str) const;
+    PrefixTokenType determineTokenType(std::string_view token);
+    double applyOperator(std::string_view op, double left, double right) const;
+    int operatorArity(std::string_view token) const;
     
     // Tokenization helpers
-    std::vector<std::string> splitIntoTokens(const std::string& expression);
-    std::string trim(const std::string& str);
-    
-    // File reading helpers
-    std::vector<std::string> readLinesFromFile(const std::string& filename);
+    PrefixToken makeToken(std::string_view tokenStr);
+    std::vector<std::string_view> splitIntoTokens(std::string_view expression);
     
     // Conversion helpers
-    std::string reverseString(const std::string& str);
-    std::vector<std::string> reverseTokens(const std::vector<std::string>& tokens);
-    char getOppositeParenthesis(char paren);
+    std::string postfixTokensToPrefix(const std::vector<std::string_view>& postfix, size_t textSize,
+                                      const char* errorMessage) const;
     
     // Recursive evaluation helpers
     double evaluatePrefixRecursive(const std::vector<PrefixToken>& tokens, int& index);
     
-    // Expression tree helpers for infix conversion
+    // Expression tree helpers for infix conversion.
+    // Nodes and their text live in an Arena owned by the caller, so a whole
+    // tree is released at once instead of node by node.
     struct ExprNode {
-        std::string value;
-        ExprNode* left;
+        std::string_view value; // Interned in the tree's arena
+        ExprNode* left;         // First argument of a function
         ExprNode* right;
+        ExprNode* next;         // Following argument of a function
         bool isOperator;
+        bool isFunction;
         
-        ExprNode(const std::string& val, bool isOp = false) 
-            : value(val), left(nullptr), right(nullptr), isOperator(isOp) {}
-        
-        ~ExprNode() {
-            delete left;
-            delete right;
-        }
+        ExprNode(std::string_view val, bool isOp = false, bool isFunc = false) 
+            : value(val), left(nullptr), right(nullptr), next(nullptr), isOperator(isOp), isFunction(isFunc) {}
     };
     
-    ExprNode* buildExpressionTree(const std::vector<PrefixToken>& tokens, int& index);
+    ExprNode* buildExpressionTree(const std::vector<PrefixToken>& tokens, Arena& arena, StringInterner& names);
     std::string treeToInfix(ExprNode* node, int parentPrec = -1);
 };
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include <string>
 #include <chrono>
 #include <random>
+#include <mutex>
+#include <thread>
 
 // Queue utilities and algorithms
 namespace QueueUtils {
@@ -95,6 +97,99 @@ namespace QueueUtils {
         duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
         std::cout << "Dequeue " << operations << " elements: " << duration.count() << " μs" << std::endl;
     }
+    
+    void reportHandoff(const std::string& name, int operations, long long sum,
+                       std::chrono::high_resolution_clock::time_point start) {
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        long long expected = static_cast<long long>(operations) * (operations - 1) / 2;
+        double rate = duration.count() > 0 ? static_cast<double>(operations) / duration.count() : 0.0;
+        std::cout << name << ": " << duration.count() << " μs (" << rate << " M ops/s)"
+                  << (sum == expected ? "" : " CHECKSUM MISMATCH") << std::endl;
+    }
+    
+    // Pass 0..operations-1 from a producer thread to a consumer thread
+    // through an ArrayQueue guarded by a mutex, one element per lock
+    void lockedHandoffBenchmark(int operations) {
+        ArrayQueue<int> queue;
+        std::mutex mutex;
+        long long sum = 0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        std::thread consumer([&] {
+            for (int received = 0; received < operations;) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!queue.isEmpty()) {
+                    sum += queue.dequeue();
+                    ++received;
+                }
+            }
+        });
+        for (int i = 0; i < operations; ++i) {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.enqueue(i);
+        }
+        consumer.join();
+        reportHandoff("Mutex + ArrayQueue", operations, sum, start);
+    }
+    
+    // The same through an SpscQueue, one element per operation
+    void spscHandoffBenchmark(int operations) {
+        SpscQueue<int> queue(1024);
+        long long sum = 0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        std::thread consumer([&] {
+            for (int received = 0; received < operations; ++received) {
+                sum += queue.dequeue();
+            }
+        });
+        for (int i = 0; i < operations; ++i) {
+            queue.enqueue(i);
+        }
+        consumer.join();
+        reportHandoff("SpscQueue", operations, sum, start);
+    }
+    
+    // The same through an SpscQueue, publishing and consuming up to 64 at a time
+    void spscBatchHandoffBenchmark(int operations) {
+        const size_t batch_size = 64;
+        SpscQueue<int> queue(1024);
+        long long sum = 0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        std::thread consumer([&] {
+            int buffer[batch_size];
+            for (int received = 0; received < operations;) {
+                size_t count = queue.dequeueBatch(buffer, batch_size);
+                if (count == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    sum += buffer[i];
+                }
+                received += static_cast<int>(count);
+            }
+        });
+        int buffer[batch_size];
+        for (int next = 0; next < operations;) {
+            size_t count = std::min(batch_size, static_cast<size_t>(operations - next));
+            for (size_t i = 0; i < count; ++i) {
+                buffer[i] = next + static_cast<int>(i);
+            }
+            for (size_t sent = 0; sent < count;) {
+                size_t accepted = queue.enqueueBatch(buffer + sent, count - sent);
+                if (accepted == 0) {
+                    std::this_thread::yield();
+                }
+                sent += accepted;
+            }
+            next += static_cast<int>(count);
+        }
+        consumer.join();
+        reportHandoff("SpscQueue (batches of 64)", operations, sum, start);
+    }
 }
 
 // Test functions
@@ -182,6 +277,19 @@ void testLinkedQueue() {
     } catch (const std::exception& e) {
         std::cout << "Exception caught: " << e.what() << std::endl;
     }
+    
+    // Chunked variant: same operations, 4 elements per node here
+    std::cout << "\n--- Chunked Queue (4 per chunk) ---" << std::endl;
+    ChunkedQueue<int, 4> chunked_queue;
+    for (int i = 1; i <= 10; ++i) {
+        chunked_queue.enqueue(i * 10);
+    }
+    chunked_queue.display();
+    std::cout << "Dequeued: " << chunked_queue.dequeue() << ", " << chunked_queue.dequeue() << std::endl;
+    std::cout << "Front: " << chunked_queue.front() << ", Back: " << chunked_queue.back()
+              << ", Size: " << chunked_queue.size() << std::endl;
+    ChunkedQueue<int, 4> copied_chunked = chunked_queue;
+    copied_chunked.display();
 }
 
 void testPriorityQueue() {
@@ -252,4 +360,14 @@ void performanceBenchmarks() {
     
     std::cout << "\nLinked Queue:" << std::endl;
     QueueUtils::performanceBenchmark<LinkedQueue<int>>(operations);
+    
+    std::cout << "\nChunked Queue:" << std::endl;
+    QueueUtils::performanceBenchmark<ChunkedQueue<int>>(operations);
+    
+    // Producer thread to consumer thread
+    const int handoffs = operations * 50;
+    std::cout << "\n=== Two-Thread Handoff (" << handoffs << " elements) ===" << std::endl;
+    QueueUtils::lockedHandoffBenchmark(handoffs);
+    QueueUtils::spscHandoffBenchmark(handoffs);
+    QueueUtils::spscBatchHandoffBenchmark(handoffs);
 }
\ No newline at end of file
@@ -2,59 +2,166 @@
 #include <stdexcept>
 #include <iostream>
 #include <vector>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include "../expression_core/AllocationTracker.h"
+#include "../expression_core/NodePool.h"
 
-// Array-based Circular Queue implementation
+// Array-based Circular Queue implementation.
+// The capacity is always a power of two, so wrapping an index around the ring
+// is a mask instead of a division. Slots are raw storage: only the current_size
+// slots starting at front_index hold constructed elements, so growing does not
+// default-construct the new buffer, and trivially copyable elements are moved
+// to it with memcpy.
 template<typename T>
 class ArrayQueue {
 private:
     T* data;
-    int capacity;
-    int front_index;
-    int rear_index;
-    int current_size;
-    
-    void resize() {
-        int new_capacity = capacity * 2;
-        T* new_data = new T[new_capacity];
-        
-        // Copy elements in correct order
-        for (int i = 0; i < current_size; ++i) {
-            new_data[i] = std::move(data[(front_index + i) % capacity]);
+    size_t capacity;        // Zero (after a move) or a power of two
+    size_t front_index;
+    size_t current_size;
+    
+    static constexpr size_t MIN_CAPACITY = 16;
+    
+    static size_t roundUpToPowerOfTwo(size_t count) {
+        size_t result = 1;
+        while (result < count) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    static T* allocateSlots(size_t count) {
+        T* slots = std::allocator<T>().allocate(count);
+        TRACK_ALLOCATION("ArrayQueue buffer", slots, count * sizeof(T));
+        return slots;
+    }
+    
+    static void freeSlots(T* slots, size_t count) {
+        if (slots != nullptr) {
+            TRACK_DEALLOCATION("ArrayQueue buffer", slots, count * sizeof(T));
+            std::allocator<T>().deallocate(slots, count);
+        }
+    }
+    
+    // Slot of the element at position i from the front
+    size_t slotOf(size_t i) const {
+        return (front_index + i) & (capacity - 1);
+    }
+    
+    void destroyElements() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < current_size; ++i) {
+                data[slotOf(i)].~T();
+            }
+        }
+    }
+    
+    // Construct the elements, front first, at destination[0, current_size).
+    // With Move they are moved out (copied if T's move may throw), so only a
+    // queue about to destroy them uses it. If a copy throws, the copies made so
+    // far are destroyed and this queue is intact.
+    template<bool Move>
+    void transferElementsTo(T* destination) const {
+        if (current_size == 0) {
+            return;
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            // At most two runs: up to the end of the buffer, then from its start
+            size_t first_run = std::min(current_size, capacity - front_index);
+            std::memcpy(static_cast<void*>(destination), data + front_index, first_run * sizeof(T));
+            std::memcpy(static_cast<void*>(destination + first_run), data, (current_size - first_run) * sizeof(T));
+        } else {
+            size_t built = 0;
+            try {
+                for (; built < current_size; ++built) {
+                    T& element = data[slotOf(built)];
+                    if constexpr (Move) {
+                        new (destination + built) T(std::move_if_noexcept(element));
+                    } else {
+                        new (destination + built) T(static_cast<const T&>(element));
+                    }
+                }
+            } catch (...) {
+                for (size_t i = 0; i < built; ++i) {
+                    destination[i].~T();
+                }
+                throw;
+            }
+        }
+    }
+    
+    // A buffer of other's capacity holding copies of its elements from slot 0
+    static T* copyOf(const ArrayQueue& other) {
+        if (other.capacity == 0) {
+            return nullptr;
+        }
+        T* copy = allocateSlots(other.capacity);
+        try {
+            other.template transferElementsTo<false>(copy);
+        } catch (...) {
+            freeSlots(copy, other.capacity);
+            throw;
+        }
+        return copy;
+    }
+    
+    // Double the capacity, constructing the new back element in the new buffer
+    // before the old one is released, so args may refer to an element of this queue
+    template<typename... Args>
+    void growAndEnqueue(Args&&... args) {
+        size_t new_capacity = capacity == 0 ? MIN_CAPACITY : capacity * 2;
+        T* new_data = allocateSlots(new_capacity);
+        try {
+            new (new_data + current_size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            freeSlots(new_data, new_capacity);
+            throw;
+        }
+        try {
+            transferElementsTo<true>(new_data);
+        } catch (...) {
+            new_data[current_size].~T();
+            freeSlots(new_data, new_capacity);
+            throw;
         }
         
-        delete[] data;
+        destroyElements();
+        freeSlots(data, capacity);
         data = new_data;
         capacity = new_capacity;
         front_index = 0;
-        rear_index = current_size;
+        ++current_size;
     }
 
 public:
-    // Constructor
-    explicit ArrayQueue(int initial_capacity = 10) 
-        : capacity(initial_capacity), front_index(0), rear_index(0), current_size(0) {
-        data = new T[capacity];
+    // Constructor; the capacity is rounded up to a power of two
+    explicit ArrayQueue(size_t initial_capacity = MIN_CAPACITY) 
+        : data(nullptr), capacity(roundUpToPowerOfTwo(initial_capacity)), front_index(0), current_size(0) {
+        data = allocateSlots(capacity);
         std::cout << "ArrayQueue constructor called with capacity " << capacity << std::endl;
     }
     
     // Copy constructor
     ArrayQueue(const ArrayQueue& other) 
-        : capacity(other.capacity), front_index(0), rear_index(other.current_size), current_size(other.current_size) {
-        data = new T[capacity];
-        for (int i = 0; i < current_size; ++i) {
-            data[i] = other.data[(other.front_index + i) % other.capacity];
-        }
+        : data(copyOf(other)), capacity(other.capacity), front_index(0), current_size(other.current_size) {
         std::cout << "ArrayQueue copy constructor called" << std::endl;
     }
     
     // Move constructor
     ArrayQueue(ArrayQueue&& other) noexcept
         : data(other.data), capacity(other.capacity), 
-          front_index(other.front_index), rear_index(other.rear_index), current_size(other.current_size) {
+          front_index(other.front_index), current_size(other.current_size) {
         other.data = nullptr;
         other.capacity = 0;
         other.front_index = 0;
-        other.rear_index = 0;
         other.current_size = 0;
         std::cout << "ArrayQueue move constructor called" << std::endl;
     }
@@ -62,17 +169,15 @@ public:
     // Copy assignment
     ArrayQueue& operator=(const ArrayQueue& other) {
         if (this != &other) {
-            delete[] data;
+            T* copy = copyOf(other);
+            
+            destroyElements();
+            freeSlots(data, capacity);
             
+            data = copy;
             capacity = other.capacity;
-            current_size = other.current_size;
             front_index = 0;
-            rear_index = current_size;
-            data = new T[capacity];
-            
-            for (int i = 0; i < current_size; ++i) {
-                data[i] = other.data[(other.front_index + i) % other.capacity];
-            }
+            current_size = other.current_size;
         }
         std::cout << "ArrayQueue copy assignment called" << std::endl;
         return *this;
@@ -81,18 +186,17 @@ public:
     // Move assignment
     ArrayQueue& operator=(ArrayQueue&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            destroyElements();
+            freeSlots(data, capacity);
             
             data = other.data;
             capacity = other.capacity;
             front_index = other.front_index;
-            rear_index = other.rear_index;
             current_size = other.current_size;
             
             other.data = nullptr;
             other.capacity = 0;
             other.front_index = 0;
-            other.rear_index = 0;
             other.current_size = 0;
         }
         std::cout << "ArrayQueue move assignment called" << std::endl;
@@ -101,29 +205,29 @@ public:
     
     // Destructor
     ~ArrayQueue() {
-        delete[] data;
+        destroyElements();
+        freeSlots(data, capacity);
         std::cout << "ArrayQueue destructor called" << std::endl;
     }
     
     // Queue operations
-    void enqueue(const T& value) {
+    template<typename... Args>
+    void emplace(Args&&... args) {
         if (current_size == capacity) {
-            resize();
+            growAndEnqueue(std::forward<Args>(args)...);
+            return;
         }
         
-        data[rear_index] = value;
-        rear_index = (rear_index + 1) % capacity;
+        new (data + slotOf(current_size)) T(std::forward<Args>(args)...);
         ++current_size;
     }
     
+    void enqueue(const T& value) {
+        emplace(value);
+    }
+    
     void enqueue(T&& value) {
-        if (current_size == capacity) {
-            resize();
-        }
-        
-        data[rear_index] = std::move(value);
-        rear_index = (rear_index + 1) % capacity;
-        ++current_size;
+        emplace(std::move(value));
     }
     
     T dequeue() {
@@ -132,7 +236,8 @@ public:
         }
         
         T value = std::move(data[front_index]);
-        front_index = (front_index + 1) % capacity;
+        data[front_index].~T();
+        front_index = (front_index + 1) & (capacity - 1);
         --current_size;
         
         return value;
@@ -156,27 +261,25 @@ public:
         if (isEmpty()) {
             throw std::runtime_error("Cannot access back of empty queue");
         }
-        int back_index = (rear_index - 1 + capacity) % capacity;
-        return data[back_index];
+        return data[slotOf(current_size - 1)];
     }
     
     T& back() {
         if (isEmpty()) {
             throw std::runtime_error("Cannot access back of empty queue");
         }
-        int back_index = (rear_index - 1 + capacity) % capacity;
-        return data[back_index];
+        return data[slotOf(current_size - 1)];
     }
     
     bool isEmpty() const {
         return current_size == 0;
     }
     
-    int size() const {
+    size_t size() const {
         return current_size;
     }
     
-    int getCapacity() const {
+    size_t getCapacity() const {
         return capacity;
     }
     
@@ -185,8 +288,8 @@ public:
         if (isEmpty()) {
             std::cout << "EMPTY";
         } else {
-            for (int i = 0; i < current_size; ++i) {
-                std::cout << data[(front_index + i) % capacity] << " ";
+            for (size_t i = 0; i < current_size; ++i) {
+                std::cout << data[slotOf(i)] << " ";
             }
         }
         std::cout << std::endl;
@@ -196,11 +299,212 @@ public:
         std::cout << "Queue Details:" << std::endl;
         std::cout << "  Size: " << current_size << "/" << capacity << std::endl;
         std::cout << "  Front index: " << front_index << std::endl;
-        std::cout << "  Rear index: " << rear_index << std::endl;
+        std::cout << "  Rear index: " << (capacity == 0 ? 0 : slotOf(current_size)) << std::endl;
         display();
     }
 };
 
+// Bounded single-producer/single-consumer queue for handing work between two
+// threads without a lock. It keeps ArrayQueue's layout (a power-of-two ring of
+// raw slots, wrapped with a mask) but never grows, since a reallocation could
+// not be published safely to the other thread.
+//
+// Exactly one thread may call the producer side (enqueue, tryEnqueue,
+// tryEmplace, enqueueBatch) and exactly one the consumer side (dequeue,
+// tryDequeue, dequeueBatch). head and tail count every element ever consumed
+// and produced; each is written by one side only, published with a release
+// store and read by the other with an acquire load, so an element is fully
+// constructed before the consumer can see it and fully destroyed before the
+// producer can reuse its slot. The two counters sit on separate cache lines,
+// and each side keeps a cached copy of the other's counter so that it only
+// touches the other line when the ring looks full (or empty). The batch
+// operations move up to a whole run of elements per release store.
+template<typename T>
+class SpscQueue {
+private:
+    // Typical cache line size; keeps the producer's and the consumer's fields
+    // from sharing a line
+    static constexpr size_t CACHE_LINE = 64;
+    
+    // Written by the consumer only
+    alignas(CACHE_LINE) std::atomic<size_t> head;
+    size_t cached_tail;     // Consumer's last view of tail
+    
+    // Written by the producer only
+    alignas(CACHE_LINE) std::atomic<size_t> tail;
+    size_t cached_head;     // Producer's last view of head
+    
+    // Read-only after construction
+    alignas(CACHE_LINE) T* data;
+    size_t capacity;        // A power of two
+    
+    static size_t roundUpToPowerOfTwo(size_t count) {
+        size_t result = 2;
+        while (result < count) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    // Producer side: free slots, refreshing the view of head only if needed
+    size_t freeSlots(size_t t, size_t wanted) {
+        size_t available = capacity - (t - cached_head);
+        if (available < wanted) {
+            cached_head = head.load(std::memory_order_acquire);
+            available = capacity - (t - cached_head);
+        }
+        return available;
+    }
+    
+    // Consumer side: filled slots, refreshing the view of tail only if needed
+    size_t filledSlots(size_t h, size_t wanted) {
+        size_t available = cached_tail - h;
+        if (available < wanted) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            available = cached_tail - h;
+        }
+        return available;
+    }
+    
+    // Move the element at h into out; if the move throws, it stays queued
+    void takeSlot(size_t h, T& out) {
+        T& slot = data[h & (capacity - 1)];
+        out = std::move(slot);
+        slot.~T();
+    }
+
+public:
+    // The capacity is rounded up to a power of two (at least 2)
+    explicit SpscQueue(size_t requested_capacity = 1024)
+        : head(0), cached_tail(0), tail(0), cached_head(0), data(nullptr),
+          capacity(roundUpToPowerOfTwo(requested_capacity)) {
+        data = std::allocator<T>().allocate(capacity);
+        TRACK_ALLOCATION("SpscQueue buffer", data, capacity * sizeof(T));
+    }
+    
+    // Shared between two threads, so it is neither copied nor moved
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    // Both threads must be done with the queue
+    ~SpscQueue() {
+        size_t t = tail.load(std::memory_order_acquire);
+        for (size_t h = head.load(std::memory_order_relaxed); h != t; ++h) {
+            data[h & (capacity - 1)].~T();
+        }
+        TRACK_DEALLOCATION("SpscQueue buffer", data, capacity * sizeof(T));
+        std::allocator<T>().deallocate(data, capacity);
+    }
+    
+    // Producer operations
+    template<typename... Args>
+    bool tryEmplace(Args&&... args) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (freeSlots(t, 1) == 0) {
+            return false;
+        }
+        new (data + (t & (capacity - 1))) T(std::forward<Args>(args)...);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    bool tryEnqueue(const T& value) {
+        return tryEmplace(value);
+    }
+    
+    bool tryEnqueue(T&& value) {
+        return tryEmplace(std::move(value));
+    }
+    
+    // Waits (yielding) while the queue is full
+    void enqueue(const T& value) {
+        while (!tryEmplace(value)) {
+            std::this_thread::yield();
+        }
+    }
+    
+    void enqueue(T&& value) {
+        while (!tryEmplace(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+    
+    // Copies as many of items[0, count) as fit and publishes them together;
+    // returns how many were enqueued
+    size_t enqueueBatch(const T* items, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = std::min(count, freeSlots(t, count));
+        size_t built = 0;
+        try {
+            for (; built < n; ++built) {
+                new (data + ((t + built) & (capacity - 1))) T(items[built]);
+            }
+        } catch (...) {
+            tail.store(t + built, std::memory_order_release);
+            throw;
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+    
+    // Consumer operations
+    bool tryDequeue(T& out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (filledSlots(h, 1) == 0) {
+            return false;
+        }
+        takeSlot(h, out);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Waits (yielding) while the queue is empty
+    T dequeue() {
+        size_t h = head.load(std::memory_order_relaxed);
+        while (filledSlots(h, 1) == 0) {
+            std::this_thread::yield();
+        }
+        T& slot = data[h & (capacity - 1)];
+        T value = std::move(slot);
+        slot.~T();
+        head.store(h + 1, std::memory_order_release);
+        return value;
+    }
+    
+    // Moves up to max_count elements into out and frees their slots together;
+    // returns how many were dequeued
+    size_t dequeueBatch(T* out, size_t max_count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t n = std::min(max_count, filledSlots(h, max_count));
+        size_t taken = 0;
+        try {
+            for (; taken < n; ++taken) {
+                takeSlot(h + taken, out[taken]);
+            }
+        } catch (...) {
+            head.store(h + taken, std::memory_order_release);
+            throw;
+        }
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+    
+    // Exact only when neither side is running; a snapshot otherwise
+    size_t size() const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return t - h;
+    }
+    
+    bool isEmpty() const {
+        return size() == 0;
+    }
+    
+    size_t getCapacity() const {
+        return capacity;
+    }
+};
+
 // Node for LinkedQueue
 template<typename T>
 class QueueNode {
@@ -241,13 +545,15 @@ public:
     ~QueueNode() = default;
 };
 
-// Linked List-based Queue implementation
-template<typename T>
+// Linked List-based Queue implementation; nodes come from a NodePool unless
+// HeapNodes is passed, so a queue at its working size enqueues without malloc
+template<typename T, template<typename> class NodeAllocator = NodePool>
 class LinkedQueue {
 private:
     QueueNode<T>* front_node;
     QueueNode<T>* rear_node;
     size_t current_size;
+    NodeAllocator<QueueNode<T>> nodes;
     
     void copyFrom(const LinkedQueue& other) {
         if (other.front_node == nullptr) {
@@ -257,12 +563,12 @@ private:
             return;
         }
         
-        front_node = new QueueNode<T>(other.front_node->data);
+        front_node = nodes.create(other.front_node->data);
         QueueNode<T>* current = front_node;
         QueueNode<T>* otherCurrent = other.front_node->next;
         
         while (otherCurrent != nullptr) {
-            current->next = new QueueNode<T>(otherCurrent->data);
+            current->next = nodes.create(otherCurrent->data);
             current = current->next;
             otherCurrent = otherCurrent->next;
         }
@@ -275,7 +581,7 @@ private:
         while (front_node != nullptr) {
             QueueNode<T>* temp = front_node;
             front_node = front_node->next;
-            delete temp;
+            nodes.destroy(temp);
         }
         rear_node = nullptr;
         current_size = 0;
@@ -295,7 +601,8 @@ public:
     
     // Move constructor
     LinkedQueue(LinkedQueue&& other) noexcept 
-        : front_node(other.front_node), rear_node(other.rear_node), current_size(other.current_size) {
+        : front_node(other.front_node), rear_node(other.rear_node), current_size(other.current_size),
+          nodes(std::move(other.nodes)) {
         other.front_node = nullptr;
         other.rear_node = nullptr;
         other.current_size = 0;
@@ -319,6 +626,7 @@ public:
             front_node = other.front_node;
             rear_node = other.rear_node;
             current_size = other.current_size;
+            nodes = std::move(other.nodes);
             other.front_node = nullptr;
             other.rear_node = nullptr;
             other.current_size = 0;
@@ -335,7 +643,7 @@ public:
     
     // Queue operations
     void enqueue(const T& value) {
-        QueueNode<T>* newNode = new QueueNode<T>(value);
+        QueueNode<T>* newNode = nodes.create(value);
         
         if (rear_node == nullptr) {
             front_node = rear_node = newNode;
@@ -348,7 +656,7 @@ public:
     }
     
     void enqueue(T&& value) {
-        QueueNode<T>* newNode = new QueueNode<T>(std::move(value));
+        QueueNode<T>* newNode = nodes.create(std::move(value));
         
         if (rear_node == nullptr) {
             front_node = rear_node = newNode;
@@ -373,7 +681,7 @@ public:
             rear_node = nullptr;
         }
         
-        delete temp;
+        nodes.destroy(temp);
         --current_size;
         
         return value;
@@ -430,6 +738,263 @@ public:
     }
 };
 
+// Chunk of a ChunkedQueue: raw storage for ChunkSize elements, constructed
+// and destroyed one at a time by the queue
+template<typename T, size_t ChunkSize>
+struct QueueChunk {
+    QueueChunk* next;
+    alignas(T) unsigned char storage[ChunkSize * sizeof(T)];
+
+    QueueChunk() : next(nullptr) {}
+
+    T* slot(size_t index) {
+        return std::launder(reinterpret_cast<T*>(storage) + index);
+    }
+
+    const T* slot(size_t index) const {
+        return std::launder(reinterpret_cast<const T*>(storage) + index);
+    }
+};
+
+// Unrolled linked list-based Queue: same interface as LinkedQueue, but each
+// node holds ChunkSize elements, so there is one pointer and one allocation
+// per chunk instead of per element and traversal stays within contiguous
+// memory. Growth never copies elements. One emptied chunk is kept as a spare,
+// so a queue hovering around a chunk boundary does not allocate.
+template<typename T, size_t ChunkSize = 64>
+class ChunkedQueue {
+    static_assert(ChunkSize > 0, "ChunkedQueue needs at least one element per chunk");
+
+private:
+    typedef QueueChunk<T, ChunkSize> Chunk;
+
+    Chunk* front_chunk;
+    Chunk* rear_chunk;
+    Chunk* spare_chunk;
+    size_t front_index;     // First element in front_chunk
+    size_t rear_index;      // One past the last element in rear_chunk
+    size_t current_size;
+
+    Chunk* acquireChunk() {
+        if (spare_chunk != nullptr) {
+            Chunk* chunk = spare_chunk;
+            spare_chunk = nullptr;
+            chunk->next = nullptr;
+            return chunk;
+        }
+        Chunk* chunk = new Chunk();
+        TRACK_ALLOCATION("ChunkedQueue chunk", chunk, sizeof(Chunk));
+        return chunk;
+    }
+
+    void releaseChunk(Chunk* chunk) {
+        if (spare_chunk == nullptr) {
+            spare_chunk = chunk;
+            return;
+        }
+        TRACK_DEALLOCATION("ChunkedQueue chunk", chunk, sizeof(Chunk));
+        delete chunk;
+    }
+
+    // Destroy the front element and step past it
+    void discardFront() {
+        front_chunk->slot(front_index)->~T();
+        ++front_index;
+        --current_size;
+        if (current_size == 0) {
+            // Only one chunk is left; start it over from the beginning
+            front_index = 0;
+            rear_index = 0;
+        } else if (front_index == ChunkSize) {
+            Chunk* emptied = front_chunk;
+            front_chunk = front_chunk->next;
+            front_index = 0;
+            releaseChunk(emptied);
+        }
+    }
+
+    void clear() {
+        while (current_size > 0) {
+            discardFront();
+        }
+    }
+
+    void freeChunks() {
+        clear();
+        if (front_chunk != nullptr) {
+            TRACK_DEALLOCATION("ChunkedQueue chunk", front_chunk, sizeof(Chunk));
+            delete front_chunk;
+        }
+        if (spare_chunk != nullptr) {
+            TRACK_DEALLOCATION("ChunkedQueue chunk", spare_chunk, sizeof(Chunk));
+            delete spare_chunk;
+        }
+        front_chunk = nullptr;
+        rear_chunk = nullptr;
+        spare_chunk = nullptr;
+    }
+
+    void copyFrom(const ChunkedQueue& other) {
+        other.forEach([this](const T& value) { enqueue(value); });
+    }
+
+    void stealFrom(ChunkedQueue& other) {
+        front_chunk = other.front_chunk;
+        rear_chunk = other.rear_chunk;
+        spare_chunk = other.spare_chunk;
+        front_index = other.front_index;
+        rear_index = other.rear_index;
+        current_size = other.current_size;
+        other.front_chunk = nullptr;
+        other.rear_chunk = nullptr;
+        other.spare_chunk = nullptr;
+        other.front_index = 0;
+        other.rear_index = 0;
+        other.current_size = 0;
+    }
+
+    // Visit the elements from front to back
+    template<typename Visitor>
+    void forEach(Visitor visit) const {
+        const Chunk* chunk = front_chunk;
+        size_t index = front_index;
+        for (size_t remaining = current_size; remaining > 0; --remaining) {
+            if (index == ChunkSize) {
+                chunk = chunk->next;
+                index = 0;
+            }
+            visit(*chunk->slot(index));
+            ++index;
+        }
+    }
+
+public:
+    ChunkedQueue()
+        : front_chunk(nullptr), rear_chunk(nullptr), spare_chunk(nullptr),
+          front_index(0), rear_index(0), current_size(0) {}
+
+    // Delegating, so the destructor cleans up if a copy throws
+    ChunkedQueue(const ChunkedQueue& other) : ChunkedQueue() {
+        copyFrom(other);
+    }
+
+    ChunkedQueue(ChunkedQueue&& other) noexcept : ChunkedQueue() {
+        stealFrom(other);
+    }
+
+    ChunkedQueue& operator=(const ChunkedQueue& other) {
+        if (this != &other) {
+            clear();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    ChunkedQueue& operator=(ChunkedQueue&& other) noexcept {
+        if (this != &other) {
+            freeChunks();
+            stealFrom(other);
+        }
+        return *this;
+    }
+
+    ~ChunkedQueue() {
+        freeChunks();
+    }
+
+    // Queue operations
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        if (rear_chunk != nullptr && rear_index < ChunkSize) {
+            new (rear_chunk->slot(rear_index)) T(std::forward<Args>(args)...);
+            ++rear_index;
+        } else {
+            // Construct before linking the chunk in, so a throwing constructor
+            // leaves the queue as it was
+            Chunk* chunk = acquireChunk();
+            try {
+                new (chunk->slot(0)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                releaseChunk(chunk);
+                throw;
+            }
+            if (rear_chunk == nullptr) {
+                front_chunk = chunk;
+                front_index = 0;
+            } else {
+                rear_chunk->next = chunk;
+            }
+            rear_chunk = chunk;
+            rear_index = 1;
+        }
+        ++current_size;
+    }
+
+    void enqueue(const T& value) {
+        emplace(value);
+    }
+
+    void enqueue(T&& value) {
+        emplace(std::move(value));
+    }
+
+    T dequeue() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot dequeue from empty queue");
+        }
+
+        T value = std::move(*front_chunk->slot(front_index));
+        discardFront();
+        return value;
+    }
+
+    const T& front() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access front of empty queue");
+        }
+        return *front_chunk->slot(front_index);
+    }
+
+    T& front() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access front of empty queue");
+        }
+        return *front_chunk->slot(front_index);
+    }
+
+    const T& back() const {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access back of empty queue");
+        }
+        return *rear_chunk->slot(rear_index - 1);
+    }
+
+    T& back() {
+        if (isEmpty()) {
+            throw std::runtime_error("Cannot access back of empty queue");
+        }
+        return *rear_chunk->slot(rear_index - 1);
+    }
+
+    bool isEmpty() const {
+        return current_size == 0;
+    }
+
+    size_t size() const {
+        return current_size;
+    }
+
+    void display() const {
+        std::cout << "Queue (front to back): ";
+        if (isEmpty()) {
+            std::cout << "EMPTY";
+        } else {
+            forEach([](const T& value) { std::cout << value << " "; });
+        }
+        std::cout << std::endl;
+    }
+};
+
 // Priority Queue implementation using heap
 template<typename T>
 class PriorityQueue {
@@ -15,7 +15,9 @@ int main() {
     std::cout << "Features:" << std::endl;
     std::cout << "- Array-based circular queue with dynamic resizing" << std::endl;
     std::cout << "- Linked list-based queue" << std::endl;
+    std::cout << "- Chunked (unrolled) linked list-based queue" << std::endl;
     std::cout << "- Priority queue (max-heap)" << std::endl;
+    std::cout << "- Lock-free single-producer/single-consumer ring queue" << std::endl;
     std::cout << "- Copy/Move semantics (Rule of 5)" << std::endl;
     std::cout << "- Queue algorithms and utilities" << std::endl;
     std::cout << "- Performance benchmarking" << std::endl;
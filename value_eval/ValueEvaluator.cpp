@@ -1,4 +1,5 @@
 #include "ValueEvaluator.h"
+#include "../expression_core/ExpressionLexer.h"
 #include <stack>
 #include <sstream>
 #include <algorithm>
@@ -8,7 +9,9 @@
 #include <iostream>
 
 // Static member definitions
-std::unordered_map<std::string, double> ValueEvaluator::currentVariables;
+thread_local std::unordered_map<std::string, double> ValueEvaluator::currentVariables;
+std::shared_ptr<ExpressionCache<ValueEvaluator::CompiledExpression>> ValueEvaluator::programCache;
+std::shared_ptr<ExpressionCache<double>> ValueEvaluator::resultCache;
 
 const std::unordered_map<std::string, std::function<double(double)>> ValueEvaluator::builtInFunctions = {
     {"sin", [](double x) { return std::sin(x); }},
@@ -27,6 +30,14 @@ const std::unordered_map<std::string, std::function<double(double)>> ValueEvalua
     {"atan", [](double x) { return std::atan(x); }}
 };
 
+const ValueEvaluator::NaryFunctionTable ValueEvaluator::builtInNaryFunctions = {
+    {"min", {[](const double* x) { return std::min(x[0], x[1]); }, 2}},
+    {"max", {[](const double* x) { return std::max(x[0], x[1]); }, 2}},
+    {"atan2", {[](const double* x) { return std::atan2(x[0], x[1]); }, 2}},
+    {"hypot", {[](const double* x) { return std::hypot(x[0], x[1]); }, 2}},
+    {"clamp", {[](const double* x) { return std::min(std::max(x[0], x[1]), x[2]); }, 3}}
+};
+
 double ValueEvaluator::evaluate(const std::string& expression) {
     std::unordered_map<std::string, double> emptyVars;
     return evaluate(expression, emptyVars);
@@ -35,17 +46,387 @@ double ValueEvaluator::evaluate(const std::string& expression) {
 double ValueEvaluator::evaluate(const std::string& expression, const std::unordered_map<std::string, double>& variables) {
     currentVariables = variables;
     
-    // Try different evaluation strategies
-    try {
-        return evaluateComplex(expression);
-    } catch (const std::exception& e) {
-        try {
-            return evaluateArithmetic(expression);
-        } catch (const std::exception& e2) {
-            std::string postfix = infixToPostfix(expression);
-            return evaluatePostfix(postfix);
+    // Cached programs are plain postfix; conditionals need the short-circuiting parser
+    if (programCache && expression.find_first_of("<>=!&|?") == std::string::npos) {
+        return evaluateCached(expression);
+    }
+    
+    return evaluateParsed(expression, variables);
+}
+
+double ValueEvaluator::evaluateParsed(const std::string& expression, const std::unordered_map<std::string, double>& variables) {
+    EvalResult result = tryEvaluate(expression, variables);
+    if (!result) {
+        if (result.error == EvalError::DIVISION_BY_ZERO || result.error == EvalError::MODULO_BY_ZERO) {
+            throw std::runtime_error(evalErrorName(result.error));
+        }
+        throw std::invalid_argument(result.describe(expression));
+    }
+    return result.value;
+}
+
+namespace {
+
+// Infix evaluator that reports the first error instead of throwing.
+// Precedence matches infixToPostfix: + - below * / %, below unary minus,
+// below ^ (right associative, so -2^2 == -4 and 2^-1 == 0.5). Below all of
+// those, loosest last: < <= > >=, == !=, &&, ||, and c ? a : b (right
+// associative). The operand that &&, || or ?: does not need is parsed with
+// evaluation switched off, so it costs no calls and raises no errors.
+class InfixParser {
+public:
+    using FunctionTable = std::unordered_map<std::string, std::function<double(double)>>;
+
+    // Caller functions (optional) are looked up before the builtins
+    InfixParser(std::string_view input, const std::unordered_map<std::string, double>& variables,
+                const FunctionTable& functions, const ValueEvaluator::NaryFunctionTable& naryFunctions,
+                const FunctionTable* userFunctions = nullptr,
+                const ValueEvaluator::NaryFunctionTable* userNaryFunctions = nullptr)
+        : input(input), variables(variables), functions(functions), naryFunctions(naryFunctions),
+          userFunctions(userFunctions), userNaryFunctions(userNaryFunctions) {}
+
+    EvalResult run() {
+        char c = 0;
+        if (!peek(c)) {
+            return EvalResult::failure(EvalError::EMPTY_EXPRESSION, 0);
+        }
+
+        double value = 0.0;
+        if (!parseConditional(value) || (peek(c) && !failTrailing(c))) {
+            return EvalResult::failure(error, errorOffset);
+        }
+        return EvalResult::success(value);
+    }
+
+private:
+    static const int MAX_DEPTH = 1000; // Keeps the recursion well inside the call stack
+
+    std::string_view input;
+    const std::unordered_map<std::string, double>& variables;
+    const FunctionTable& functions;
+    const ValueEvaluator::NaryFunctionTable& naryFunctions;
+    const FunctionTable* userFunctions;
+    const ValueEvaluator::NaryFunctionTable* userNaryFunctions;
+    size_t pos = 0;
+    int depth = 0;
+    int skipping = 0;   // > 0 while parsing an operand that is not needed
+    EvalError error = EvalError::NONE;
+    size_t errorOffset = 0;
+
+    bool fail(EvalError code, size_t offset) {
+        error = code;
+        errorOffset = offset;
+        return false;
+    }
+
+    // Skip whitespace; false at the end of input
+    bool peek(char& c) {
+        while (pos < input.size() && ExpressionLexer::isSpace(input[pos])) {
+            ++pos;
+        }
+        if (pos == input.size()) {
+            return false;
+        }
+        c = input[pos];
+        return true;
+    }
+
+    static bool startsOperand(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '(' || c == '_';
+    }
+
+    // Something follows a complete operand where an operator or the end was expected
+    bool failTrailing(char c) {
+        if (c == ')') return fail(EvalError::UNBALANCED_PARENTHESIS, pos);
+        return fail(startsOperand(c) ? EvalError::MISSING_OPERATOR : EvalError::UNEXPECTED_CHARACTER, pos);
+    }
+
+    // Parse with evaluation off; result is meaningless
+    template<typename Parse>
+    bool skip(Parse parse) {
+        double ignored = 0.0;
+        ++skipping;
+        bool ok = (this->*parse)(ignored);
+        --skipping;
+        return ok;
+    }
+
+    // Two-character operator at pos (e.g. "&&", "<=")
+    bool peekPair(char first, char second) {
+        char c = 0;
+        return peek(c) && c == first && pos + 1 < input.size() && input[pos + 1] == second;
+    }
+
+    bool parseConditional(double& result) {
+        if (++depth > MAX_DEPTH) return fail(EvalError::TOO_DEEP, pos);
+        bool ok = parseOr(result);
+
+        char c = 0;
+        if (ok && peek(c) && c == '?') {
+            size_t question = pos++;
+            bool condition = result != 0;
+            ok = condition ? parseConditional(result) : skip(&InfixParser::parseConditional);
+            if (ok && (!peek(c) || c != ':')) {
+                ok = peek(c) ? failTrailing(c) : fail(EvalError::MISSING_OPERAND, question);
+            }
+            if (ok) {
+                ++pos;
+                ok = condition ? skip(&InfixParser::parseConditional) : parseConditional(result);
+            }
+        }
+
+        --depth;
+        return ok;
+    }
+
+    bool parseOr(double& result) {
+        if (!parseAnd(result)) return false;
+
+        while (peekPair('|', '|')) {
+            pos += 2;
+            if (result != 0) {
+                if (!skip(&InfixParser::parseAnd)) return false;
+                result = 1.0;
+            } else {
+                if (!parseAnd(result)) return false;
+                result = result != 0 ? 1.0 : 0.0;
+            }
+        }
+        return true;
+    }
+
+    bool parseAnd(double& result) {
+        if (!parseEquality(result)) return false;
+
+        while (peekPair('&', '&')) {
+            pos += 2;
+            if (result == 0) {
+                if (!skip(&InfixParser::parseEquality)) return false;
+                result = 0.0;
+            } else {
+                if (!parseEquality(result)) return false;
+                result = result != 0 ? 1.0 : 0.0;
+            }
+        }
+        return true;
+    }
+
+    bool parseEquality(double& result) {
+        if (!parseRelational(result)) return false;
+
+        while (peekPair('=', '=') || peekPair('!', '=')) {
+            bool equal = input[pos] == '=';
+            pos += 2;
+            double right = 0.0;
+            if (!parseRelational(right)) return false;
+            result = (result == right) == equal ? 1.0 : 0.0;
+        }
+        return true;
+    }
+
+    bool parseRelational(double& result) {
+        if (!parseExpression(result)) return false;
+
+        char c = 0;
+        while (peek(c) && (c == '<' || c == '>')) {
+            bool orEqual = pos + 1 < input.size() && input[pos + 1] == '=';
+            pos += orEqual ? 2 : 1;
+            double right = 0.0;
+            if (!parseExpression(right)) return false;
+            bool holds = c == '<' ? (orEqual ? result <= right : result < right)
+                                  : (orEqual ? result >= right : result > right);
+            result = holds ? 1.0 : 0.0;
+        }
+        return true;
+    }
+
+    bool parseExpression(double& result) {
+        if (!parseTerm(result)) return false;
+
+        char c = 0;
+        while (peek(c) && (c == '+' || c == '-')) {
+            ++pos;
+            double term = 0.0;
+            if (!parseTerm(term)) return false;
+            result = c == '+' ? result + term : result - term;
+        }
+        return true;
+    }
+
+    bool parseTerm(double& result) {
+        if (!parseUnary(result)) return false;
+
+        char c = 0;
+        while (peek(c) && (c == '*' || c == '/' || c == '%')) {
+            size_t opOffset = pos++;
+            double factor = 0.0;
+            if (!parseUnary(factor)) return false;
+
+            if (c == '*') {
+                result *= factor;
+            } else if (factor == 0 && skipping == 0) {
+                return fail(c == '/' ? EvalError::DIVISION_BY_ZERO : EvalError::MODULO_BY_ZERO, opOffset);
+            } else {
+                result = c == '/' ? result / factor : std::fmod(result, factor);
+            }
+        }
+        return true;
+    }
+
+    bool parseUnary(double& result) {
+        if (++depth > MAX_DEPTH) return fail(EvalError::TOO_DEEP, pos);
+
+        char c = 0;
+        bool ok;
+        if (peek(c) && (c == '-' || c == '+')) {
+            ++pos;
+            ok = parseUnary(result);
+            if (ok && c == '-') result = -result;
+        } else {
+            ok = parsePower(result);
+        }
+
+        --depth;
+        return ok;
+    }
+
+    bool parsePower(double& result) {
+        if (!parsePrimary(result)) return false;
+
+        char c = 0;
+        if (peek(c) && c == '^') {
+            ++pos;
+            double exponent = 0.0;
+            if (!parseUnary(exponent)) return false;
+            result = std::pow(result, exponent);
+        }
+        return true;
+    }
+
+    bool parsePrimary(double& result) {
+        char c = 0;
+        if (!peek(c)) return fail(EvalError::MISSING_OPERAND, pos);
+        size_t start = pos;
+
+        if (c == '(') {
+            ++pos;
+            return parseParenthesized(result, start);
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+            while (pos < input.size() && (std::isdigit(static_cast<unsigned char>(input[pos])) || input[pos] == '.')) {
+                ++pos;
+            }
+            if (!ExpressionLexer::parseNumber(input.substr(start, pos - start), result)) {
+                return fail(EvalError::MALFORMED_NUMBER, start);
+            }
+            return true;
+        }
+
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            while (pos < input.size() && (std::isalnum(static_cast<unsigned char>(input[pos])) || input[pos] == '_')) {
+                ++pos;
+            }
+            std::string name(input.substr(start, pos - start));
+
+            const std::function<double(double)>* function = nullptr;
+            const std::pair<NaryFunction, size_t>* naryFunction = nullptr;
+            if (findFunction(name, function, naryFunction)) {
+                if (!peek(c) || c != '(') return fail(EvalError::FUNCTION_NEEDS_PARENTHESES, start);
+                size_t open = pos++;
+                if (naryFunction != nullptr) {
+                    return parseArguments(*naryFunction, open, result);
+                }
+                double argument = 0.0;
+                if (!parseParenthesized(argument, open)) return false;
+                result = skipping == 0 ? (*function)(argument) : 0.0;
+                return true;
+            }
+
+            auto variable = variables.find(name);
+            if (variable == variables.end()) {
+                if (skipping > 0) {
+                    result = 0.0;
+                    return true;
+                }
+                return fail(EvalError::UNDEFINED_VARIABLE, start);
+            }
+            result = variable->second;
+            return true;
+        }
+
+        if (c == ')' || c == '*' || c == '/' || c == '%' || c == '^' || c == '<' || c == '>' ||
+            c == '=' || c == '!' || c == '&' || c == '|' || c == '?' || c == ':') {
+            return fail(EvalError::MISSING_OPERAND, pos);
+        }
+        return fail(EvalError::UNEXPECTED_CHARACTER, pos);
+    }
+
+    bool findFunction(const std::string& name, const std::function<double(double)>*& function,
+                      const std::pair<NaryFunction, size_t>*& naryFunction) const {
+        const FunctionTable* unaryTables[] = {userFunctions, &functions};
+        const ValueEvaluator::NaryFunctionTable* naryTables[] = {userNaryFunctions, &naryFunctions};
+        for (int i = 0; i < 2; ++i) {
+            if (unaryTables[i] != nullptr) {
+                auto it = unaryTables[i]->find(name);
+                if (it != unaryTables[i]->end()) {
+                    function = &it->second;
+                    return true;
+                }
+            }
+            if (naryTables[i] != nullptr) {
+                auto it = naryTables[i]->find(name);
+                if (it != naryTables[i]->end()) {
+                    naryFunction = &it->second;
+                    return true;
+                }
+            }
         }
+        return false;
     }
+
+    // After '(' at open: the function's comma-separated arguments and the ')'
+    bool parseArguments(const std::pair<NaryFunction, size_t>& function, size_t open, double& result) {
+        double arguments[MAX_FUNCTION_ARITY];
+        for (size_t k = 0; k < function.second; ++k) {
+            if (!parseConditional(arguments[k])) return false;
+
+            char c = 0;
+            if (!peek(c)) return fail(EvalError::UNBALANCED_PARENTHESIS, open);
+            char expected = k + 1 == function.second ? ')' : ',';
+            if (c == expected) {
+                ++pos;
+                continue;
+            }
+            if (c == ')') return fail(EvalError::MISSING_OPERAND, pos);         // Too few arguments
+            if (c == ',') return fail(EvalError::UNEXPECTED_CHARACTER, pos);    // Too many
+            return failTrailing(c);
+        }
+        result = skipping == 0 ? function.first(arguments) : 0.0;
+        return true;
+    }
+
+    // After '(' at open: an expression and its ')'
+    bool parseParenthesized(double& result, size_t open) {
+        if (!parseConditional(result)) return false;
+
+        char c = 0;
+        if (!peek(c)) return fail(EvalError::UNBALANCED_PARENTHESIS, open);
+        if (c != ')') return failTrailing(c);
+        ++pos;
+        return true;
+    }
+};
+
+} // namespace
+
+EvalResult ValueEvaluator::tryEvaluate(std::string_view expression) {
+    static const std::unordered_map<std::string, double> noVariables;
+    return tryEvaluate(expression, noVariables);
+}
+
+EvalResult ValueEvaluator::tryEvaluate(std::string_view expression, const std::unordered_map<std::string, double>& variables) {
+    return InfixParser(expression, variables, builtInFunctions, builtInNaryFunctions).run();
 }
 
 double ValueEvaluator::evaluateArithmetic(const std::string& expression) {
@@ -59,8 +440,29 @@ double ValueEvaluator::evaluateArithmetic(const std::string& expression) {
 
 double ValueEvaluator::evaluateWithFunctions(const std::string& expression, 
                                            const std::unordered_map<std::string, std::function<double(double)>>& functions) {
-    // This is a simplified version - in a full implementation, we'd need to parse function calls
-    return evaluateArithmetic(expression);
+    static const NaryFunctionTable noNaryFunctions;
+    return evaluateWithFunctions(expression, functions, noNaryFunctions);
+}
+
+double ValueEvaluator::evaluateWithFunctions(const std::string& expression,
+                                           const std::unordered_map<std::string, std::function<double(double)>>& functions,
+                                           const NaryFunctionTable& naryFunctions) {
+    for (const auto& entry : naryFunctions) {
+        if (entry.second.first == nullptr || entry.second.second == 0 || entry.second.second > MAX_FUNCTION_ARITY) {
+            throw std::invalid_argument("Invalid function: " + entry.first);
+        }
+    }
+    
+    static const std::unordered_map<std::string, double> noVariables;
+    EvalResult result = InfixParser(expression, noVariables, builtInFunctions, builtInNaryFunctions,
+                                    &functions, &naryFunctions).run();
+    if (!result) {
+        if (result.error == EvalError::DIVISION_BY_ZERO || result.error == EvalError::MODULO_BY_ZERO) {
+            throw std::runtime_error(evalErrorName(result.error));
+        }
+        throw std::invalid_argument(result.describe(expression));
+    }
+    return result.value;
 }
 
 double ValueEvaluator::evaluateComplex(const std::string& expression) {
@@ -103,7 +505,7 @@ bool ValueEvaluator::isValidExpression(const std::string& expression) {
                 ++i;
             }
             expectOperand = false;
-        } else if (std::isalpha(c)) {
+        } else if (std::isalpha(c) || c == '_') {
             if (!expectOperand) return false;
             // Skip the rest of the variable/function name
             while (i + 1 < cleaned.length() && (std::isalnum(cleaned[i + 1]) || cleaned[i + 1] == '_')) {
@@ -120,8 +522,9 @@ bool ValueEvaluator::isValidExpression(const std::string& expression) {
 
 std::string ValueEvaluator::infixToPostfix(const std::string& infix) {
     std::string result;
-    std::stack<char> operators;
+    std::stack<std::string> operators; // Binary operators, unary minus, "(" markers and pending function names
     std::string cleaned = removeSpaces(infix);
+    bool expectOperand = true;
     
     for (size_t i = 0; i < cleaned.length(); ++i) {
         char c = cleaned[i];
@@ -134,18 +537,35 @@ std::string ValueEvaluator::infixToPostfix(const std::string& infix) {
             }
             result += ' ';
             --i; // Adjust for loop increment
-        } else if (std::isalpha(c)) {
-            // Add variable name to result
+            expectOperand = false;
+        } else if (std::isalpha(c) || c == '_') {
+            size_t start = i;
             while (i < cleaned.length() && (std::isalnum(cleaned[i]) || cleaned[i] == '_')) {
-                result += cleaned[i];
                 ++i;
             }
-            result += ' ';
+            std::string name = cleaned.substr(start, i - start);
             --i; // Adjust for loop increment
+            
+            if (isFunction(name) && i + 1 < cleaned.length() && cleaned[i + 1] == '(') {
+                operators.push(name); // Emitted after its argument when the ')' closes
+            } else {
+                result += name;
+                result += ' ';
+                expectOperand = false;
+            }
         } else if (c == '(') {
-            operators.push(c);
+            operators.push("(");
+            expectOperand = true;
+        } else if (c == ',') {
+            // Argument separator: flush the finished argument, keep its '('
+            while (!operators.empty() && operators.top() != "(") {
+                result += operators.top();
+                result += ' ';
+                operators.pop();
+            }
+            expectOperand = true;
         } else if (c == ')') {
-            while (!operators.empty() && operators.top() != '(') {
+            while (!operators.empty() && operators.top() != "(") {
                 result += operators.top();
                 result += ' ';
                 operators.pop();
@@ -153,16 +573,33 @@ std::string ValueEvaluator::infixToPostfix(const std::string& infix) {
             if (!operators.empty()) {
                 operators.pop(); // Remove '('
             }
+            if (!operators.empty() && isFunction(operators.top())) {
+                // The function this '(' belonged to; a unary minus before the
+                // '(' stays, so -(x)^2 binds as -(x^2)
+                result += operators.top();
+                result += ' ';
+                operators.pop();
+            }
+            expectOperand = false;
         } else if (isOperator(c)) {
+            if (expectOperand && (c == '-' || c == '+')) {
+                // Unary sign: '-' becomes ExpressionLexer::UNARY_MINUS, '+' is a no-op
+                if (c == '-') {
+                    operators.push(std::string(ExpressionLexer::UNARY_MINUS));
+                }
+                continue;
+            }
+            
             while (!operators.empty() && 
-                   operators.top() != '(' &&
+                   operators.top() != "(" &&
                    ((isLeftAssociative(c) && getPrecedence(operators.top()) >= getPrecedence(c)) ||
                     (!isLeftAssociative(c) && getPrecedence(operators.top()) > getPrecedence(c)))) {
                 result += operators.top();
                 result += ' ';
                 operators.pop();
             }
-            operators.push(c);
+            operators.push(std::string(1, c));
+            expectOperand = true;
         }
     }
     
@@ -182,29 +619,57 @@ std::string ValueEvaluator::infixToPostfix(const std::string& infix) {
 
 double ValueEvaluator::evaluatePostfix(const std::string& postfix) {
     std::stack<double> operands;
-    std::istringstream iss(postfix);
-    std::string token;
+    ExpressionLexer lexer(postfix);
+    std::string_view tokenView;
     
-    while (iss >> token) {
-        if (isNumber(token)) {
-            operands.push(std::stod(token));
-        } else if (isVariable(token)) {
-            auto it = currentVariables.find(token);
-            if (it != currentVariables.end()) {
-                operands.push(it->second);
-            } else {
-                throw std::invalid_argument("Undefined variable: " + token);
+    while (lexer.next(tokenView)) {
+        double number = 0.0;
+        if (isNumber(tokenView) && ExpressionLexer::parseNumber(tokenView, number)) {
+            operands.push(number);
+            continue;
+        }
+        
+        if (tokenView == ExpressionLexer::UNARY_MINUS) {
+            if (operands.empty()) {
+                throw std::invalid_argument("Insufficient operands for unary minus");
             }
-        } else if (token.length() == 1 && isOperator(token[0])) {
+            operands.top() = -operands.top();
+            continue;
+        }
+        
+        if (tokenView.length() == 1 && isOperator(tokenView[0])) {
             if (operands.size() < 2) {
-                throw std::invalid_argument("Insufficient operands for operator: " + token);
+                throw std::invalid_argument("Insufficient operands for operator: " + std::string(tokenView));
             }
             
             double b = operands.top(); operands.pop();
             double a = operands.top(); operands.pop();
             
-            double result = performOperation(a, b, token[0]);
+            double result = performOperation(a, b, tokenView[0]);
             operands.push(result);
+            continue;
+        }
+        
+        std::string token(tokenView);
+        if (isVariable(token)) {
+            auto it = currentVariables.find(token);
+            if (it != currentVariables.end()) {
+                operands.push(it->second);
+            } else {
+                throw std::invalid_argument("Undefined variable: " + token);
+            }
+        } else if (builtInNaryFunctions.count(token) != 0) {
+            const auto& function = builtInNaryFunctions.at(token);
+            if (operands.size() < function.second) {
+                throw std::invalid_argument("Insufficient operands for function: " + token);
+            }
+            
+            double arguments[MAX_FUNCTION_ARITY];
+            for (size_t k = function.second; k-- > 0;) {
+                arguments[k] = operands.top();
+                operands.pop();
+            }
+            operands.push(function.first(arguments));
         } else if (isFunction(token)) {
             if (operands.size() < 1) {
                 throw std::invalid_argument("Insufficient operands for function: " + token);
@@ -225,9 +690,119 @@ double ValueEvaluator::evaluatePostfix(const std::string& postfix) {
     return operands.top();
 }
 
+GradientProgram ValueEvaluator::compileGradient(const std::string& expression, const std::vector<std::string>& variableNames) {
+    return GradientProgram(infixToPostfix(expression), variableNames);
+}
+
+double ValueEvaluator::evaluateGradient(const std::string& expression,
+                                        const std::unordered_map<std::string, double>& variables,
+                                        std::unordered_map<std::string, double>& gradient) {
+    std::vector<std::string> names;
+    std::vector<double> point;
+    names.reserve(variables.size());
+    point.reserve(variables.size());
+    for (const auto& variable : variables) {
+        names.push_back(variable.first);
+        point.push_back(variable.second);
+    }
+
+    GradientProgram program = compileGradient(expression, names);
+    std::vector<double> partials;
+    double value = program.evaluate(point, partials);
+
+    gradient.clear();
+    for (size_t i = 0; i < names.size(); ++i) {
+        gradient[names[i]] = partials[i];
+    }
+    return value;
+}
+
 double ValueEvaluator::evaluateComparison(const std::string& expression) {
-    // Simple comparison evaluation - would need more complex parsing for full implementation
-    return evaluateArithmetic(expression);
+    std::string left, op, right;
+    if (!splitComparison(expression, left, op, right)) {
+        return evaluateArithmetic(expression);
+    }
+    return performComparison(evaluateArithmetic(left), evaluateArithmetic(right), op);
+}
+
+Interval ValueEvaluator::evaluateRange(const std::string& expression, const std::unordered_map<std::string, Interval>& box) {
+    return evaluateAs<Interval>(expression, box);
+}
+
+Interval ValueEvaluator::evaluateComparisonRange(const std::string& expression,
+                                                 const std::unordered_map<std::string, Interval>& box) {
+    std::string left, op, right;
+    if (!splitComparison(expression, left, op, right)) {
+        throw std::invalid_argument("No comparison operator in: " + expression);
+    }
+    return compareIntervals(evaluateRange(left, box), op, evaluateRange(right, box));
+}
+
+void ValueEvaluator::enableCache(size_t capacity, EvictionPolicy policy) {
+    programCache = std::make_shared<ExpressionCache<CompiledExpression>>(capacity, policy);
+    resultCache = std::make_shared<ExpressionCache<double>>(capacity, policy);
+}
+
+void ValueEvaluator::disableCache() {
+    programCache.reset();
+    resultCache.reset();
+}
+
+bool ValueEvaluator::isCacheEnabled() {
+    return programCache != nullptr;
+}
+
+CacheStats ValueEvaluator::getProgramCacheStats() {
+    return programCache ? programCache->getStats() : CacheStats();
+}
+
+CacheStats ValueEvaluator::getResultCacheStats() {
+    return resultCache ? resultCache->getStats() : CacheStats();
+}
+
+ValueEvaluator::CompiledExpression ValueEvaluator::compile(const std::string& expression) {
+    CompiledExpression compiled;
+    compiled.postfix = infixToPostfix(expression);
+    
+    ExpressionLexer::forEachToken(compiled.postfix, [&](std::string_view token) {
+        if (isVariable(token)) {
+            compiled.hasVariables = true;
+        }
+    });
+    
+    return compiled;
+}
+
+double ValueEvaluator::evaluateCached(const std::string& expression) {
+    // Whitespace runs collapse to one space but still separate tokens, so "1 2"
+    // (missing operator) and "12" do not share an entry
+    std::string key = ExpressionCache<double>::normalize(expression);
+    
+    double result = 0.0;
+    if (resultCache->lookup(key, result)) {
+        return result;
+    }
+    
+    CompiledExpression compiled;
+    if (programCache->lookup(key, compiled)) {
+        try {
+            return evaluatePostfix(compiled.postfix);
+        } catch (const std::exception&) {
+            // Undefined variable or division by zero: let the parser report it as evaluate() would
+            return evaluateParsed(expression, currentVariables);
+        }
+    }
+    
+    // First sight: the parser decides the value or the error, so only expressions
+    // it accepts are compiled and cached
+    result = evaluateParsed(expression, currentVariables);
+    compiled = compile(expression);
+    programCache->insert(key, compiled);
+    if (!compiled.hasVariables) {
+        resultCache->insert(key, result);
+    }
+    
+    return result;
 }
 
 // Helper function implementations
@@ -235,8 +810,9 @@ bool ValueEvaluator::isOperator(char c) {
     return c == '+' || c == '-' || c == '*' || c == '/' || c == '^' || c == '%';
 }
 
-bool ValueEvaluator::isFunction(const std::string& token) {
-    return builtInFunctions.find(token) != builtInFunctions.end();
+bool ValueEvaluator::isFunction(std::string_view token) {
+    std::string name(token);
+    return builtInFunctions.find(name) != builtInFunctions.end() || builtInNaryFunctions.find(name) != builtInNaryFunctions.end();
 }
 
 int ValueEvaluator::getPrecedence(char op) {
@@ -249,12 +825,17 @@ int ValueEvaluator::getPrecedence(char op) {
         case '%':
             return 2;
         case '^':
-            return 3;
+            return 4;
         default:
             return 0;
     }
 }
 
+int ValueEvaluator::getPrecedence(const std::string& op) {
+    if (op == ExpressionLexer::UNARY_MINUS) return 3; // Unary minus: tighter than '*', looser than '^' (-2^2 == -4)
+    return op.length() == 1 ? getPrecedence(op[0]) : 0;
+}
+
 bool ValueEvaluator::isLeftAssociative(char op) {
     return op != '^'; // Only exponentiation is right associative
 }
@@ -294,6 +875,27 @@ double ValueEvaluator::performComparison(double a, double b, const std::string&
     throw std::invalid_argument("Unknown comparison operator: " + op);
 }
 
+// Split "lhs op rhs" at the first comparison operator; false if there is none
+bool ValueEvaluator::splitComparison(const std::string& expression, std::string& left, std::string& op, std::string& right) {
+    size_t pos = expression.find_first_of("<>=!");
+    if (pos == std::string::npos) {
+        return false;
+    }
+
+    size_t length = (pos + 1 < expression.size() && expression[pos + 1] == '=') ? 2 : 1;
+    op = expression.substr(pos, length);
+    if (op == "=" || op == "!") {
+        throw std::invalid_argument("Unknown comparison operator: " + op);
+    }
+
+    left = expression.substr(0, pos);
+    right = expression.substr(pos + length);
+    if (ExpressionLexer::trim(left).empty() || ExpressionLexer::trim(right).empty()) {
+        throw std::invalid_argument("Comparison needs an expression on both sides");
+    }
+    return true;
+}
+
 std::string ValueEvaluator::removeSpaces(const std::string& str) {
     std::string result;
     for (char c : str) {
@@ -304,36 +906,12 @@ std::string ValueEvaluator::removeSpaces(const std::string& str) {
     return result;
 }
 
-bool ValueEvaluator::isNumber(const std::string& token) {
-    if (token.empty()) return false;
-    
-    size_t start = 0;
-    if (token[0] == '-' || token[0] == '+') {
-        start = 1;
-        if (token.length() == 1) return false;
-    }
-    
-    bool hasDecimal = false;
-    for (size_t i = start; i < token.length(); ++i) {
-        if (token[i] == '.') {
-            if (hasDecimal) return false;
-            hasDecimal = true;
-        } else if (!std::isdigit(token[i])) {
-            return false;
-        }
-    }
-    
-    return true;
+bool ValueEvaluator::isNumber(std::string_view token) {
+    return ExpressionLexer::isNumber(token);
 }
 
-bool ValueEvaluator::isVariable(const std::string& token) {
-    if (token.empty() || !std::isalpha(token[0])) return false;
-    
-    for (char c : token) {
-        if (!std::isalnum(c) && c != '_') return false;
-    }
-    
-    return !isFunction(token); // Make sure it's not a function name
+bool ValueEvaluator::isVariable(std::string_view token) {
+    return ExpressionLexer::isIdentifier(token) && !isFunction(token); // Make sure it's not a function name
 }
 
 // Recursive descent parser implementation
@@ -417,6 +995,20 @@ double ValueEvaluator::parseNumber(const std::string& expr, size_t& pos) {
         
         // Check if it's a function
         if (isFunction(identifier)) {
+            auto nary = builtInNaryFunctions.find(identifier);
+            if (nary != builtInNaryFunctions.end() && pos < expr.length() && expr[pos] == '(') {
+                double arguments[MAX_FUNCTION_ARITY];
+                for (size_t k = 0; k < nary->second.second; ++k) {
+                    pos++; // Skip '(' or ','
+                    arguments[k] = parseExpression(expr, pos);
+                    char expected = k + 1 == nary->second.second ? ')' : ',';
+                    if (pos >= expr.length() || expr[pos] != expected) {
+                        throw std::invalid_argument("Wrong number of arguments for function: " + identifier);
+                    }
+                }
+                pos++; // Skip ')'
+                return nary->second.first(arguments);
+            }
             if (pos < expr.length() && expr[pos] == '(') {
                 pos++; // Skip '('
                 double arg = parseExpression(expr, pos);
@@ -448,5 +1040,9 @@ double ValueEvaluator::parseNumber(const std::string& expr, size_t& pos) {
         pos++;
     }
     
-    return std::stod(expr.substr(start, pos - start));
+    double value = 0.0;
+    if (!ExpressionLexer::parseNumber(std::string_view(expr).substr(start, pos - start), value)) {
+        throw std::invalid_argument("Malformed number");
+    }
+    return value;
 }
\ No newline at end of file
@@ -2,21 +2,45 @@
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <string_view>
+#include <memory>
+#include "../expression_core/ExpressionCache.h"
+#include "../expression_core/CompactToken.h"
+#include "../expression_core/NumericEngine.h"
+#include "../expression_core/AutoDiff.h"
+#include "../expression_core/Interval.h"
+#include "../expression_core/EvalResult.h"
 
 class ValueEvaluator {
 public:
+    // Functions of several arguments by name: plain pointer and argument count
+    using NaryFunctionTable = std::unordered_map<std::string, std::pair<NaryFunction, size_t>>;
+    
     // Main evaluation function
     static double evaluate(const std::string& expression);
     
     // Evaluate with variable substitution
     static double evaluate(const std::string& expression, const std::unordered_map<std::string, double>& variables);
     
+    // Non-throwing evaluation for untrusted input: the value, or an error code and
+    // the byte offset in expression where parsing or evaluation stopped.
+    // evaluate() is this plus a single throw on failure. Besides arithmetic the
+    // grammar has comparisons (1.0 or 0.0), && and || and c ? a : b; the side
+    // they do not need is parsed but never evaluated.
+    static EvalResult tryEvaluate(std::string_view expression);
+    static EvalResult tryEvaluate(std::string_view expression, const std::unordered_map<std::string, double>& variables);
+    
     // Evaluate arithmetic expression (infix notation)
     static double evaluateArithmetic(const std::string& expression);
     
-    // Evaluate with custom functions
+    // Evaluate with custom functions, called as name(argument) or
+    // name(a, b, ...) next to the builtins (which include min, max, atan2,
+    // hypot and clamp); a custom function hides a builtin of the same name
     static double evaluateWithFunctions(const std::string& expression, 
                                        const std::unordered_map<std::string, std::function<double(double)>>& functions);
+    static double evaluateWithFunctions(const std::string& expression,
+                                       const std::unordered_map<std::string, std::function<double(double)>>& functions,
+                                       const NaryFunctionTable& naryFunctions);
     
     // Parse and evaluate complex expressions with parentheses
     static double evaluateComplex(const std::string& expression);
@@ -30,24 +54,64 @@ public:
     // Evaluate postfix expression
     static double evaluatePostfix(const std::string& postfix);
     
+    // Evaluate with the number type chosen at compile time (BigInt, Rational,
+    // FixedDecimal<N>, ...; see expression_core/Numeric.h). Literals are read
+    // exactly, and builtins are limited to what NumericTraits<T> supports.
+    template<typename T>
+    static T evaluateAs(const std::string& expression,
+                        const std::unordered_map<std::string, T>& variables = std::unordered_map<std::string, T>()) {
+        return evaluateNumeric<T>(infixToPostfix(expression), false, variables);
+    }
+    
+    // Reverse-mode gradient: compile once, then each evaluate() returns the value
+    // and every partial derivative in one forward and one backward sweep.
+    // For a single directional derivative use evaluateAs<Dual> instead.
+    static GradientProgram compileGradient(const std::string& expression, const std::vector<std::string>& variableNames);
+    
+    // Value of expression; gradient receives d(expression)/d(name) for every variable
+    static double evaluateGradient(const std::string& expression,
+                                   const std::unordered_map<std::string, double>& variables,
+                                   std::unordered_map<std::string, double>& gradient);
+    
     // Support for comparison operators (returns 1.0 for true, 0.0 for false)
     static double evaluateComparison(const std::string& expression);
+    
+    // Range analysis: every variable ranges over an interval, and the result
+    // contains the expression's value at every point of that box
+    static Interval evaluateRange(const std::string& expression, const std::unordered_map<std::string, Interval>& box);
+    
+    // Comparison over a box: [1, 1] if it holds everywhere, [0, 0] if nowhere
+    // (the box can be skipped), [0, 1] if undecided (split the box and retry)
+    static Interval evaluateComparisonRange(const std::string& expression,
+                                            const std::unordered_map<std::string, Interval>& box);
+    
+    // Optional memoization for evaluate(): compiled postfix programs are cached for
+    // every expression the parser accepts, final results only for variable-free ones,
+    // so values and errors match the uncached path. Expressions with comparisons or
+    // conditionals are not cached.
+    // Enable/disable before evaluating from several threads; the caches themselves are thread-safe.
+    static void enableCache(size_t capacity = 4096, EvictionPolicy policy = EvictionPolicy::LRU);
+    static void disableCache();
+    static bool isCacheEnabled();
+    static CacheStats getProgramCacheStats();
+    static CacheStats getResultCacheStats();
 
 private:
     // Helper functions
     static bool isOperator(char c);
-    static bool isFunction(const std::string& token);
+    static bool isFunction(std::string_view token);
     static int getPrecedence(char op);
+    static int getPrecedence(const std::string& op);
     static bool isLeftAssociative(char op);
     static double performOperation(double a, double b, char op);
     static double performFunction(const std::string& func, double arg);
     static double performComparison(double a, double b, const std::string& op);
+    static bool splitComparison(const std::string& expression, std::string& left, std::string& op, std::string& right);
     
     // Tokenization helpers
-    static std::vector<std::string> tokenize(const std::string& expression);
     static std::string removeSpaces(const std::string& str);
-    static bool isNumber(const std::string& token);
-    static bool isVariable(const std::string& token);
+    static bool isNumber(std::string_view token);
+    static bool isVariable(std::string_view token);
     
     // Expression parsing helpers
     static double parseExpression(const std::string& expr, size_t& pos);
@@ -55,9 +119,23 @@ private:
     static double parseFactor(const std::string& expr, size_t& pos);
     static double parseNumber(const std::string& expr, size_t& pos);
     
+    // Memoization helpers
+    struct CompiledExpression {
+        std::string postfix;
+        bool hasVariables = false;
+    };
+    static CompiledExpression compile(const std::string& expression);
+    static double evaluateCached(const std::string& expression);
+    static double evaluateParsed(const std::string& expression, const std::unordered_map<std::string, double>& variables);
+    
     // Built-in functions
     static const std::unordered_map<std::string, std::function<double(double)>> builtInFunctions;
+    static const NaryFunctionTable builtInNaryFunctions;
+    
+    // Current variables context (for recursive evaluation), one per thread
+    static thread_local std::unordered_map<std::string, double> currentVariables;
     
-    // Current variables context (for recursive evaluation)
-    static std::unordered_map<std::string, double> currentVariables;
+    // Memoization caches (null while caching is disabled)
+    static std::shared_ptr<ExpressionCache<CompiledExpression>> programCache;
+    static std::shared_ptr<ExpressionCache<double>> resultCache;
 };
\ No newline at end of file